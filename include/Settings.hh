@@ -17,10 +17,24 @@ struct Settings {
   int baseFontSize{13};
   std::vector<std::string> hwAccels{{}};
   std::vector<std::string> preferredDecoders{{}};
+  // Limits how much of an input is read to find its streams, faster to open
+  // but stream info such as frame rate may be less accurate
+  bool fastProbe{false};
+  int probeSizeKb{1024};
+  int analyzeDurationMs{500};
+  // Other video streams per input that get an idle decoder, so that
+  // switching to them is faster
+  int standbyDecoders{1};
   int logBufferSize{128};
   bool logToFile{false};
   bool autoloadMetrics{false};
+  // What playback does when decoding can not keep up, see OverloadPolicy
+  std::string overloadPolicy{"wait"};
   std::string logFile;
+  // Image format of exported frames, png, tiff or pgm
+  std::string exportFormat{"png"};
+  // Relative paths are relative to the working directory
+  std::string exportDirectory{"vivictpp-export"};
   std::map<std::string, std::string> logLevels{{"default", "info"}};
 };
 
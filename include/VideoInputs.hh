@@ -13,7 +13,10 @@ extern "C" {
 }
 
 #include <atomic>
+#include <chrono>
 #include <exception>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -23,7 +26,11 @@ extern "C" {
 #include "SourceConfig.hh"
 #include "VivictPPConfig.hh"
 #include "libav/Frame.hh"
+#include "video/FrameCache.hh"
+#include "video/MergedTimeline.hh"
+#include "video/ScrubCache.hh"
 #include "video/VideoIndexer.hh"
+#include "workers/DecodeScheduler.hh"
 #include "workers/DecoderWorker.hh"
 #include "workers/PacketWorker.hh"
 
@@ -31,6 +38,32 @@ struct MediaPipe {
   std::shared_ptr<vivictpp::workers::PacketWorker> packetWorker;
   std::shared_ptr<vivictpp::workers::DecoderWorker> decoder;
   vivictpp::video::VideoIndexer videoIndexer;
+  std::unique_ptr<vivictpp::video::ScrubCache> scrubCache;
+  // Frames may be added, dropped or retimed by a custom filter
+  bool filtered{false};
+  std::string source;
+  std::string filter;
+  vivictpp::libav::DecoderOptions decoderOptions;
+  // Decoders of the other video streams of the input, by stream index, with
+  // the same filter and decoder options. Kept open but idle, so that
+  // switching stream does not have to open a decoder.
+  std::map<int, std::shared_ptr<vivictpp::workers::DecoderWorker>>
+      standbyDecoders;
+  std::future<
+      std::map<int, std::shared_ptr<vivictpp::workers::DecoderWorker>>>
+      openingStandby;
+  // Frames stepped past since the last presented frame
+  int framesStepped{0};
+  // The decoder skips non-reference frames to catch up with playback
+  bool catchingUp{false};
+};
+
+// Stages of opening an input, in order
+enum class OpenStage { PROBING, OPENING_DECODER, PREROLLING, READY };
+
+struct OpenProgress {
+  std::string source;
+  OpenStage stage;
 };
 
 class SeekState {
@@ -53,73 +86,146 @@ private:
 class VideoInputs {
 private:
   std::vector<std::shared_ptr<vivictpp::workers::PacketWorker>> packetWorkers;
-  MediaPipe leftInput;
-  MediaPipe rightInput;
+  // Input 0 is the left input and input 1 the right input, any further inputs
+  // are only shown in the grid layout. All inputs are stepped and seeked
+  // together.
+  std::vector<std::unique_ptr<MediaPipe>> inputs;
   MediaPipe audio1;
+  bool enableAudio;
+  // Decoding threads per input, 0 lets libavcodec decide
+  int decoderThreads{0};
+  // Number of other video streams per input that get a standby decoder
+  size_t maxStandbyDecoders{1};
   int _leftFrameOffset;
   vivictpp::time::Time leftPtsOffset;
   void calcLeftPtsOffset() {
-    leftPtsOffset = _leftFrameOffset *
-                    leftInput.packetWorker->getVideoMetadata()[0].frameDuration;
-    logger->debug("leftPtsOffset: {}", leftPtsOffset);
+    if (!hasLeftSource()) {
+      return;
+    }
+    leftPtsOffset =
+        _leftFrameOffset *
+        leftInput().packetWorker->getVideoMetadata()[0].frameDuration;
+    VPP_LOG_DEBUG(logger, "leftPtsOffset: {}", leftPtsOffset);
   }
   SeekState seekState;
+  vivictpp::workers::DecodeScheduler decodeScheduler;
+  // Frame steps of all inputs, built once every input has been indexed
+  vivictpp::video::MergedTimeline timeline;
+  bool timelineValid{false};
+  vivictpp::time::Time timelineLeftPtsOffset{0};
+  // Step of the timeline last stepped to, checked first when stepping again
+  size_t timelineStep{0};
+  // Frames shown recently, kept across seeks
+  vivictpp::video::FrameCache frameCache;
+  // Frames from frameCache shown instead of the current frames of the
+  // decoders, which are then at some other position. Cleared when stepping
+  // or seeking the decoders.
+  std::vector<vivictpp::libav::Frame> cachedFrames;
+  // Workers created off the ui thread, not yet connected to an input
+  struct OpenedInput {
+    std::shared_ptr<vivictpp::workers::PacketWorker> packetWorker;
+    std::shared_ptr<vivictpp::workers::DecoderWorker> decoder;
+    std::shared_ptr<vivictpp::workers::DecoderWorker> audioDecoder;
+  };
+  struct PendingOpen {
+    SourceConfig sourceConfig;
+    std::atomic<OpenStage> stage{OpenStage::PROBING};
+    std::future<OpenedInput> result;
+    bool attached{false};
+    std::chrono::steady_clock::time_point attachedAt;
+  };
   // vivictpp::video::VideoIndexer videoIndexer;
   vivictpp::logging::Logger logger;
+  // Declared last so that pending opens are waited for before anything they
+  // use is destroyed
+  std::vector<std::unique_ptr<PendingOpen>> pendingOpens;
 
 public:
-  explicit VideoInputs();
+  // Audio is decoded from the first audio stream of the left input if
+  // enableAudio is set
+  explicit VideoInputs(bool enableAudio = false);
+  // Starts opening all sources, the first one as left input and the second
+  // one as right input. The sources are probed, their decoders opened and
+  // their first frames decoded concurrently, in the background. Decoding
+  // threads are split between the inputs when there are more than two of
+  // them.
+  void startOpenInputs(const std::vector<SourceConfig> &sourceConfigs);
+  // Connects inputs that have been opened since the last call. Returns true
+  // once every input has decoded its first frame. Rethrows any error from
+  // opening an input, throws std::runtime_error if an input has not decoded
+  // a frame within ten seconds of being connected.
+  bool finishOpenInputs();
+  bool isOpening() { return !pendingOpens.empty(); }
+  std::vector<OpenProgress> openProgress();
   void openLeft(const SourceConfig &sourceConfig);
   void openRight(const SourceConfig &sourceConfig);
-  bool hasLeftSource() { return !!leftInput.packetWorker; }
-  bool hasRightSource() { return !!rightInput.packetWorker; }
+  bool hasLeftSource() { return !!leftInput().packetWorker; }
+  bool hasRightSource() { return !!rightInput().packetWorker; }
+  // Number of opened inputs
+  size_t inputCount();
   bool ptsInRange(vivictpp::time::Time pts);
-  void step(vivictpp::time::Time pts);
+  // Returns the number of frames stepped forward, summed over all inputs.
+  // At a step of the merged timeline every input goes to its frame of that
+  // step.
+  int step(vivictpp::time::Time pts);
   void stepForward(vivictpp::time::Time pts);
   void stepBackward(vivictpp::time::Time pts);
   void dropIfFullAndOutOfRange(vivictpp::time::Time nextPts, int framesToDrop);
   void dropIfFullAndNextOutOfRange(vivictpp::time::Time currentPts,
                                    int framesToDrop);
-  std::array<vivictpp::libav::Frame, 2> firstFrames();
+  // One frame per input, at least two. Frames of inputs that are not open
+  // are empty. The frames are added to the frame cache.
+  std::vector<vivictpp::libav::Frame> firstFrames();
+  // Shows the cached frames of all inputs at pts, if all of them are in the
+  // frame cache. Returns false, and leaves the shown frames unchanged,
+  // otherwise. The decoders must be seeked before playback continues.
+  bool showCachedFrames(vivictpp::time::Time pts);
+  bool showingCachedFrames() { return !cachedFrames.empty(); }
+  // Frames of input in the frame buffer of its decoder with playback pts
+  // from from, or all frames if from is NO_TIME
+  std::vector<std::pair<vivictpp::time::Time, vivictpp::libav::Frame>>
+  bufferedFrames(size_t input, vivictpp::time::Time from);
+  // Cached frames closest to pts, for showing while dragging the seek bar.
+  // Also moves the scrub caches to prefetch around pts.
+  std::vector<vivictpp::libav::Frame> scrubFrames(vivictpp::time::Time pts);
+  void setScrubCenter(vivictpp::time::Time pts);
+  // The scrub caches fill their whole window while the seek bar is dragged,
+  // otherwise only the frames nearest the scrub center
+  void setScrubbing(bool scrubbing);
+  void setSeekBarWidth(int width) {
+    leftInput().videoIndexer.setSeekBarWidth(width);
+  }
   void seek(vivictpp::time::Time pts, vivictpp::SeekCallback onSeekFinished,
             vivictpp::time::Time streamSeekOffset = 0);
-  std::array<std::vector<VideoMetadata>, 2> metadata();
+  // Samples decoder load during playback and moves decoding threads to inputs
+  // that fall behind. Returns true if threads were reassigned, they take
+  // effect at the next seek.
+  bool rebalanceDecoders(int64_t now);
+  // Called each time frames are presented. Frames stepped past since the
+  // last call are counted as dropped if countDrops is set.
+  void framesPresented(bool countDrops);
+  // Lets the decoders of inputs that have fallen behind clockPts skip
+  // non-reference frames until they are well ahead of it again
+  void updateCatchUp(vivictpp::time::Time clockPts);
+  // Stops all decoders from skipping frames. Returns true if any decoder was
+  // skipping, in which case the buffers have gaps until the next seek.
+  bool stopCatchUp();
+  // Number of other video streams of each input to keep an idle decoder
+  // open for, so that switching to them does not have to open one. Applies
+  // to inputs opened after the call.
+  void setStandbyDecoders(int count);
+  // Metadata per input, at least two entries
+  std::vector<std::vector<VideoMetadata>> metadata();
   std::array<vivictpp::libav::DecoderMetadata, 2> decoderMetadata();
   vivictpp::time::Time duration();
   vivictpp::time::Time startTime();
-  vivictpp::time::Time frameDuration() {
-    if (!hasLeftSource()) {
-      return vivictpp::time::NO_TIME;
-    }
-    vivictpp::time::Time frameDuration = metadata()[0][0].frameDuration;
-    if (hasRightSource()) {
-      frameDuration = std::min(frameDuration, metadata()[1][0].frameDuration);
-    }
-    return frameDuration;
-  }
-  bool hasMaxPts() {
-    return leftInput.packetWorker->getVideoMetadata()[0].hasDuration() ||
-           (rightInput.packetWorker &&
-            rightInput.packetWorker->getVideoMetadata()[0].hasDuration());
-  }
-  vivictpp::time::Time minPts() {
-    VideoMetadata meta1 = leftInput.packetWorker->getVideoMetadata()[0];
-    if (!rightInput.packetWorker) {
-      return meta1.startTime - leftPtsOffset;
-    }
-    VideoMetadata meta2 = rightInput.packetWorker->getVideoMetadata()[0];
-    return std::max(meta1.startTime - leftPtsOffset, meta2.startTime);
-  }
-  vivictpp::time::Time maxPts() {
-    VideoMetadata meta1 = leftInput.packetWorker->getVideoMetadata()[0];
-    if (!meta1.hasDuration()) {
-      return vivictpp::time::NO_TIME;
-    }
-    if (!rightInput.packetWorker) {
-      return meta1.endTime - leftPtsOffset;
-    }
-    VideoMetadata meta2 = rightInput.packetWorker->getVideoMetadata()[0];
-    return std::min(meta1.endTime - leftPtsOffset, meta2.endTime);
+  vivictpp::time::Time frameDuration();
+  bool hasMaxPts();
+  vivictpp::time::Time minPts();
+  vivictpp::time::Time maxPts();
+  std::array<const vivictpp::workers::PipelineStats *, 2> pipelineStats() {
+    return {leftInput().decoder ? &leftInput().decoder->stats() : nullptr,
+            rightInput().decoder ? &rightInput().decoder->stats() : nullptr};
   }
   int leftFrameOffset() { return _leftFrameOffset; }
   int increaseLeftFrameOffset() {
@@ -133,39 +239,22 @@ public:
     return _leftFrameOffset;
   }
 
-  vivictpp::time::Time nextPts() {
-    vivictpp::time::Time nextPtsL =
-        leftInput.decoder->frames().nextPts() - leftPtsOffset;
-    if (!rightInput.decoder) {
-      return nextPtsL;
-    }
-    vivictpp::time::Time nextPtsR = rightInput.decoder->frames().nextPts();
-    if (vivictpp::time::isNoPts(nextPtsL)) {
-      return nextPtsL;
-    }
-    if (vivictpp::time::isNoPts(nextPtsR)) {
-      return nextPtsR;
-    }
-    return std::min(nextPtsL, nextPtsR);
-  }
-  vivictpp::time::Time previousPts() {
-    vivictpp::time::Time ppl =
-        leftInput.decoder->frames().previousPts() - leftPtsOffset;
-    if (!rightInput.decoder) {
-      return ppl;
-    }
-    vivictpp::time::Time ppr = rightInput.decoder->frames().previousPts();
-    if (vivictpp::time::isNoPts(ppl)) {
-      return ppl;
-    }
-    if (vivictpp::time::isNoPts(ppr)) {
-      return ppr;
-    }
-    return std::max(ppl, ppr);
-  }
+  vivictpp::time::Time nextPts();
+  vivictpp::time::Time previousPts();
+  // pts of the next and previous frame step when stepping from pts. Uses the
+  // merged timeline of all inputs when available, falls back to the frames
+  // around the current frame in the buffers.
+  vivictpp::time::Time nextStepPts(vivictpp::time::Time pts);
+  vivictpp::time::Time previousStepPts(vivictpp::time::Time pts);
   void selectVideoStreamLeft(int streamIndex);
   void selectVideoStreamRight(int streamIndex);
   bool hasAudio() { return audio1.decoder.get() != nullptr; }
+  // Offset to subtract from audio frame pts to get playback pts
+  vivictpp::time::Time audioPtsOffset() { return leftPtsOffset; }
+  bool audioPtsInRange(vivictpp::time::Time pts) {
+    return audio1.decoder &&
+           audio1.decoder->frames().ptsInRange(pts + leftPtsOffset);
+  }
   AVCodecContext *getAudioCodecContext() {
     if (!audio1.decoder) {
       throw new std::runtime_error("Input has no audio");
@@ -179,13 +268,38 @@ public:
     return audio1.decoder->frames();
   }
   std::shared_ptr<vivictpp::video::VideoIndex> getLeftVideoIndex() {
-    return leftInput.videoIndexer.getIndex();
+    return leftInput().videoIndexer.getIndex();
   }
   std::shared_ptr<vivictpp::video::VideoIndex> getRightVideoIndex() {
-    return rightInput.videoIndexer.getIndex();
+    return rightInput().videoIndexer.getIndex();
   }
 
 private:
+  MediaPipe &leftInput() { return *inputs[0]; }
+  MediaPipe &rightInput() { return *inputs[1]; }
+  // Offset added to playback pts to get the pts of input i
+  vivictpp::time::Time ptsOffset(size_t i) {
+    return i == 0 ? leftPtsOffset : 0;
+  }
+  void openInput(size_t index, const SourceConfig &sourceConfig);
+  // Key of the frames of input in the frame cache
+  std::string frameCacheKey(const MediaPipe &input);
+  // Resets input index and starts indexing the source
+  void prepareInput(size_t index, const SourceConfig &sourceConfig);
+  // Probes the source and opens its decoders, safe to call from any thread
+  OpenedInput createInput(const SourceConfig &sourceConfig, bool withAudio,
+                          std::atomic<OpenStage> &stage);
+  void attachInput(size_t index, const SourceConfig &sourceConfig,
+                   OpenedInput opened);
+  // Builds the merged timeline if needed, returns false if it can not be
+  // built yet
+  bool updateTimeline();
+  void updatePacketWorkers();
+  // Opens standby decoders for the other video streams in the background
+  void openStandbyDecoders(MediaPipe &input);
+  void closeStandbyDecoders(MediaPipe &input);
+  // Switches input to streamIndex at the current position, using a standby
+  // decoder if there is one. The previous decoder is kept as standby.
   void selectStream(MediaPipe &input, int streamIndex);
 };
 
@@ -6,22 +6,51 @@
 #define VIVICTPP_VIDEOPLAYBACK_HH_
 
 #include "VivictPPConfig.hh"
+#include "audio/AudioOutput.hh"
 #include "time/Time.hh"
 #include "time/TimeUtils.hh"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "VideoInputs.hh"
 
 namespace vivictpp {
 
+// What playback does when decoding can not keep up with the playback clock
+enum class OverloadPolicy {
+  // Keep showing the current frames until the next frames are decoded
+  WAIT,
+  // Show the latest decoded frame of each input at or before the clock,
+  // dropping frames that were decoded too late
+  DROP_LATE,
+  // As DROP_LATE, and let decoders that fall behind the clock skip
+  // non-reference frames until they have caught up
+  SKIP_NONREF
+};
+
+// Parses "wait", "drop" or "skip", anything else gives WAIT
+OverloadPolicy parseOverloadPolicy(const std::string &name);
+
 // enum class PlaybackState { STOPPED, PLAYING, SEEKING };
 
+// Frame of an input in the range being exported, with playback pts
+struct ExportFrame {
+  size_t input;
+  vivictpp::time::Time pts;
+  vivictpp::libav::Frame frame;
+};
+
 struct PlaybackState {
   vivictpp::time::Time duration{0};
   vivictpp::time::Time pts{0};
+  // pts of the playback clock at the last checked present time
+  vivictpp::time::Time clockPts{0};
   bool playing{false};
   bool seeking{false};
   bool ready{false};
+  // The playback clock follows the audio output
+  bool audioClock{false};
   bool hasLeftSource{false};
   bool hasRightSource{false};
   int speedAdjust{0};
@@ -57,13 +86,42 @@ private:
   int64_t t0 = 0;
   PlaybackState playbackState;
   int seekRetry{0};
+  vivictpp::audio::AudioOutputFactory *audioOutputFactory;
+  std::shared_ptr<vivictpp::audio::AudioOutput> audioOutput;
+  // Set when the playback position jumps, queued audio must be discarded
+  bool audioResync{true};
+  OverloadPolicy overloadPolicy{OverloadPolicy::WAIT};
+  bool exporting{false};
+  vivictpp::time::Time exportFrom{0};
+  vivictpp::time::Time exportTo{0};
+  // pts of the last frame taken for export per input, NO_TIME if none
+  std::vector<vivictpp::time::Time> exportedPts;
+  // Time of the last frame taken for export, as returned by
+  // relativeTimeMicros
+  int64_t exportProgressTime{0};
   vivictpp::logging::Logger logger;
 
 private:
   void initPlaybackState();
+  // Seeks the inputs even if pts is already buffered
+  void seekInputs(vivictpp::time::Time seekPts,
+                  vivictpp::time::Time streamSeekOffset = 0);
+  void feedAudio();
+  void syncToAudio();
 
 public:
-  VideoPlayback(const std::vector<SourceConfig> &sourceConfigs);
+  // Audio is played if audioOutputFactory is not null and the left source
+  // has audio. The sources are opened in the background, see checkOpened.
+  VideoPlayback(const std::vector<SourceConfig> &sourceConfigs,
+                vivictpp::audio::AudioOutputFactory *audioOutputFactory =
+                    nullptr);
+  // Returns true once, when the sources given to the constructor have been
+  // opened and playback is ready
+  bool checkOpened();
+  bool isOpening() { return videoInputs.isOpening(); }
+  std::vector<OpenProgress> openProgress() {
+    return videoInputs.openProgress();
+  }
   void setLeftSource(const SourceConfig &source);
   void setRightSource(const SourceConfig &source);
   void togglePlaying();
@@ -73,7 +131,20 @@ public:
             vivictpp::time::Time streamSeekOffset = 0);
   void seekRelative(vivictpp::time::Time deltaPts);
   void seekRelativeFrame(int distance);
+  void setOverloadPolicy(OverloadPolicy policy);
   bool checkAdvanceFrame(int64_t nextPresent);
+  // Pauses and seeks to from, to export the frames of all inputs up to to
+  // with takeExportFrames. Starting playback stops the export.
+  void startExport(vivictpp::time::Time from, vivictpp::time::Time to);
+  void stopExport() { exporting = false; }
+  bool isExporting() { return exporting; }
+  // Returns at most maxFrames frames of the export range that have not been
+  // returned before, taken from the frame buffers of the decoders, and steps
+  // past them so that decoding continues. Returns nothing while seeking.
+  // The export stops when all frames up to the end of the range have been
+  // returned, or when no new frames are decoded for a while, at the end of
+  // the inputs.
+  std::vector<ExportFrame> takeExportFrames(size_t maxFrames);
   void advanceFrame(vivictpp::time::Time nextPts);
   VideoInputs &getVideoInputs() { return videoInputs; };
   bool isPlaying() { return playbackState.playing; }
@@ -82,10 +153,12 @@ public:
     playbackState.speedAdjust += delta;
     t0 = vivictpp::time::relativeTimeMicros();
     playbackStartPts = playbackState.pts;
+    audioResync = true;
     return playbackState.speedAdjust;
   }
   int increaseLeftFrameOffset() {
     int value = videoInputs.increaseLeftFrameOffset();
+    audioResync = true;
     if (!playbackState.playing) {
       advanceFrame(playbackState.pts);
       stepped = true;
@@ -94,6 +167,7 @@ public:
   }
   int deccreaseLeftFrameOffset() {
     int value = videoInputs.decreaseLeftFrameOffset();
+    audioResync = true;
     if (!playbackState.playing) {
       advanceFrame(playbackState.pts);
       stepped = true;
@@ -101,6 +175,11 @@ public:
     return value;
   }
   const PlaybackState &getPlaybackState() { return playbackState; }
+  vivictpp::time::Time getFrameDuration() const { return frameDuration; }
+  // Time, as returned by relativeTimeMicros, where the playback clock started
+  // at playbackStartPts
+  int64_t getClockOrigin() const { return t0; }
+  void setClockOrigin(int64_t clockOrigin) { t0 = clockOrigin; }
 };
 
 } // namespace vivictpp
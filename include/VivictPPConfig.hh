@@ -8,6 +8,7 @@
 #include "Settings.hh"
 #include "SourceConfig.hh"
 #include "libav/DecoderOptions.hh"
+#include "libav/FormatHandler.hh"
 #include "vmaf/VmafLog.hh"
 #include <algorithm>
 #include <string>
@@ -42,6 +43,11 @@ public:
           sourceConfig.preferredDecoders[0].empty()) {
         sourceConfig.preferredDecoders = settings.preferredDecoders;
       }
+      if (settings.fastProbe) {
+        sourceConfig.formatOptions = vivictpp::libav::withProbeLimits(
+            sourceConfig.formatOptions, settings.probeSizeKb,
+            settings.analyzeDurationMs);
+      }
     }
   }
 };
@@ -19,8 +19,11 @@ public:
   virtual vivictpp::time::Time queueDuration() = 0;
   virtual void start() = 0;
   virtual void stop() = 0;
-  virtual void queueAudio(const vivictpp::libav::Frame &frame) = 0;
+  // pts is the playback position of the first sample of frame
+  virtual void queueAudio(const vivictpp::libav::Frame &frame,
+                          vivictpp::time::Time pts) = 0;
   virtual void clearQueue() = 0;
+  // Playback position of the sample currently being played
   virtual vivictpp::time::Time currentPts() = 0;
 };
 
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_AUDIO_AUDIORINGBUFFER_HH_
+#define VIVICTPP_AUDIO_AUDIORINGBUFFER_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace vivictpp::audio {
+
+// Lock free byte ring buffer for a single producer and a single consumer,
+// typically the thread queueing audio and the audio device callback.
+// Positions count all bytes ever written or read, so they never wrap.
+class AudioRingBuffer {
+public:
+  // Capacity is rounded up to a power of two
+  explicit AudioRingBuffer(size_t minCapacity);
+  AudioRingBuffer(const AudioRingBuffer &) = delete;
+  AudioRingBuffer &operator=(const AudioRingBuffer &) = delete;
+
+  // Producer side. Writes as much of data as fits, returns bytes written.
+  size_t write(const uint8_t *data, size_t size);
+  // Producer side. Discards everything written so far. The consumer skips
+  // the discarded bytes on its next read, data written after the flush is
+  // kept. The space of the discarded bytes can be written to once the
+  // consumer has skipped them.
+  void flush();
+  // Producer side. Bytes written but not yet read or flushed.
+  size_t readableBytes() const;
+  uint64_t writePosition() const {
+    return writePos.load(std::memory_order_relaxed);
+  }
+
+  // Consumer side. Reads up to size bytes, returns bytes read.
+  size_t read(uint8_t *data, size_t size);
+  uint64_t readPosition() const {
+    return readPos.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+private:
+  std::unique_ptr<uint8_t[]> buffer;
+  size_t mask;
+  std::atomic<uint64_t> writePos{0};
+  std::atomic<uint64_t> readPos{0};
+  std::atomic<uint64_t> flushPos{0};
+};
+
+} // namespace vivictpp::audio
+
+#endif // VIVICTPP_AUDIO_AUDIORINGBUFFER_HH_
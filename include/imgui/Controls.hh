@@ -19,6 +19,7 @@ private:
   int showControls{70};
   float seekValue{0};
   bool wasDragging{false};
+  float seekBarWidth{0};
   VideoMetadataDisplay leftMetadata{VideoMetadataDisplay::Type::LEFT};
   VideoMetadataDisplay rightMetadata{VideoMetadataDisplay::Type::RIGHT};
 
@@ -26,6 +27,7 @@ public:
   std::vector<Action> draw(const PlaybackState &playbackState,
                            const ui::DisplayState &displayState,
                            vivictpp::ui::ThumbnailTexture &thumbnailTexture);
+  float getSeekBarWidth() const { return seekBarWidth; }
 };
 
 } // namespace vivictpp::imgui
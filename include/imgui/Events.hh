@@ -51,6 +51,7 @@ enum ActionType {
   ZoomOut,
   ZoomReset,
   Seek,
+  Scrub,
   SeekRelative,
   StepForward,
   StepBackward,
@@ -74,6 +75,13 @@ enum ActionType {
   ShowSettingsDialog,
   UpdateSettings,
   ShowLogs,
+  TogglePresentationStats,
+  TogglePerformanceHud,
+  ToggleGridLayout,
+  CycleDifferenceMode,
+  ExportFrames,
+  ExportVisibleArea,
+  ExportRange,
   ShowQualityFileDialogLeft,
   ShowQualityFileDialogRight,
   OpenQualityFileLeft,
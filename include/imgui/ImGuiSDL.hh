@@ -12,6 +12,8 @@
 #include "ui/ThumbnailTexture.hh"
 #include "ui/VideoTextures.hh"
 #include "video/VideoIndexer.hh"
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -19,6 +21,13 @@
 
 namespace vivictpp::imgui {
 
+// Counters maintained by the render loop, read by the performance HUD
+struct RenderStats {
+  std::atomic<uint64_t> framesRendered{0};
+  std::atomic<uint64_t> textureUploads{0};
+  std::atomic<uint64_t> textureUploadMicros{0};
+};
+
 class ImGuiSDL {
 private:
   int windowWidth{1280};
@@ -34,12 +43,20 @@ private:
   std::string iniFilenameStr;
   bool scaleRenderer;
   vivictpp::ui::ThumbnailTexture thumbnailTexture;
+  RenderStats renderStats;
+
+  void recordTextureUpload(int64_t t0);
 
 public:
   ImGuiSDL(const Settings &settings);
   ~ImGuiSDL();
   void newFrame();
   void updateTextures(const ui::DisplayState &displayState);
+  void updateVisibleRegion(const ui::DisplayState &displayState);
+  void updateDifference(
+      const std::shared_ptr<const vivictpp::video::DifferenceImage> &image) {
+    videoTextures.updateDifference(renderer, image);
+  }
   vivictpp::ui::VideoTextures &getVideoTextures() { return videoTextures; }
   void
   updateThumbnails(std::shared_ptr<vivictpp::video::VideoIndex> videoIndex) {
@@ -49,6 +66,9 @@ public:
     return thumbnailTexture;
   }
   void fitWindowToTextures();
+  // Refresh rate of the display showing the window, 0 if unknown
+  int getDisplayRefreshRate();
+  const RenderStats &getRenderStats() const { return renderStats; }
   bool isWindowClose(SDL_Event &event);
   std::vector<std::shared_ptr<Event>> handleEvents();
   void render();
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_IMGUI_PERFORMANCEHUD_HH_
+#define VIVICTPP_IMGUI_PERFORMANCEHUD_HH_
+
+#include "imgui/ImGuiSDL.hh"
+#include "ui/DisplayState.hh"
+#include "workers/PipelineStats.hh"
+
+#include <array>
+#include <cstdint>
+
+namespace vivictpp::imgui {
+
+// Overlay showing sparklines of the pipeline and render counters, to help
+// tell whether a stutter comes from demux, decode, filter or upload.
+class PerformanceHud {
+public:
+  static constexpr int HISTORY_SIZE = 120;
+  static constexpr int64_t SAMPLE_INTERVAL_MICROS = 250000;
+
+private:
+  struct Series {
+    std::array<float, HISTORY_SIZE> values{};
+    int offset{0};
+    void push(float value);
+    float last() const;
+  };
+  struct SideSeries {
+    bool active{false};
+    Series packetQueue;
+    Series frameBuffer;
+    Series decodeFps;
+    Series filterMs;
+    // Totals since the source was opened
+    uint64_t framesDropped{0};
+    uint64_t catchUps{0};
+  };
+  struct PipelineTotals {
+    uint64_t framesDecoded{0};
+    uint64_t framesFiltered{0};
+    uint64_t filterMicros{0};
+  };
+  struct RenderTotals {
+    uint64_t framesRendered{0};
+    uint64_t textureUploads{0};
+    uint64_t textureUploadMicros{0};
+  };
+
+  std::array<SideSeries, 2> sides;
+  Series uploadMs;
+  Series renderFps;
+  std::array<PipelineTotals, 2> lastPipeline;
+  RenderTotals lastRender;
+  int64_t lastSampleTime{0};
+
+  void drawSide(const char *title, const SideSeries &side);
+
+public:
+  // Samples the counters, at most once per SAMPLE_INTERVAL_MICROS
+  void update(
+      const std::array<const workers::PipelineStats *, 2> &pipelineStats,
+      const RenderStats &renderStats);
+  void draw(ui::DisplayState &displayState);
+};
+
+} // namespace vivictpp::imgui
+
+#endif /* VIVICTPP_IMGUI_PERFORMANCEHUD_HH_ */
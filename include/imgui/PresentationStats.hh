@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_IMGUI_PRESENTATIONSTATS_HH_
+#define VIVICTPP_IMGUI_PRESENTATIONSTATS_HH_
+
+#include "ui/DisplayState.hh"
+#include "ui/FramePacer.hh"
+
+#include <string>
+
+namespace vivictpp::imgui {
+
+class PresentationStats {
+private:
+  std::string exportMessage;
+
+public:
+  void draw(ui::DisplayState &displayState, ui::FramePacer &framePacer);
+};
+
+} // namespace vivictpp::imgui
+
+#endif /* VIVICTPP_IMGUI_PRESENTATIONSTATS_HH_ */
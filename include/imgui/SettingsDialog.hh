@@ -32,6 +32,7 @@ private:
   std::string selected;
   bool fontSettingsUpdated{false};
   char logFileStr[512]{'\0'};
+  char exportDirStr[512]{'\0'};
 
 private:
   void initHwAccelStatuses();
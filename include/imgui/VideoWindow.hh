@@ -19,6 +19,7 @@
 #include "sdl/SDLUtils.hh"
 #include "ui/DisplayState.hh"
 #include "ui/VideoTextures.hh"
+#include <string>
 #include <vector>
 class VideoWindow {
 private:
@@ -29,6 +30,19 @@ private:
   ImVec2 videoPos;
   bool scrollUpdated{false};
   bool wasDragging{false};
+  vivictpp::ui::VisibleRect leftVisibleRect;
+  vivictpp::ui::VisibleRect rightVisibleRect;
+
+private:
+  void drawGrid(vivictpp::ui::VideoTextures &videoTextures,
+                const vivictpp::ui::DisplayState &displayState);
+  // Draws the difference image in the rectangle p1, p2 with its PSNR. A
+  // stale image is of earlier frames than the ones shown.
+  void drawDifference(vivictpp::ui::VideoTextures &videoTextures, ImVec2 p1,
+                      ImVec2 p2, bool stale);
+  // Draws text on a dark background in the top left corner of the video at
+  // p1, or of the window if that is not visible
+  void drawLabel(const std::string &text, ImVec2 p1);
 
 public:
   void draw(vivictpp::ui::VideoTextures &videoTextures,
@@ -38,5 +52,11 @@ public:
   void onScroll(const ImVec2 &scrollDelta);
   const ImVec2 &getVideoPos() { return videoPos; }
   const ImVec2 &getVideoSize() { return videoSize; }
+  const vivictpp::ui::VisibleRect &getLeftVisibleRect() {
+    return leftVisibleRect;
+  }
+  const vivictpp::ui::VisibleRect &getRightVisibleRect() {
+    return rightVisibleRect;
+  }
 };
 #endif // VIVICTPP_VIDEOWINDOW_HH
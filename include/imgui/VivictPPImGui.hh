@@ -15,13 +15,19 @@
 #include "imgui/FileDialog.hh"
 #include "imgui/ImGuiSDL.hh"
 #include "imgui/MainMenu.hh"
+#include "imgui/PerformanceHud.hh"
 #include "imgui/PlotWindow.hh"
+#include "imgui/PresentationStats.hh"
 #include "imgui/QualityFileDialog.hh"
 #include "imgui/SettingsDialog.hh"
 #include "imgui/VideoMetadataDisplay.hh"
 #include "sdl/SDLUtils.hh"
 #include "ui/DisplayState.hh"
+#include "ui/FramePacer.hh"
 #include "ui/VideoTextures.hh"
+#include "video/DifferenceWorker.hh"
+#include "video/FrameExporter.hh"
+#include <filesystem>
 #include <vector>
 
 namespace vivictpp::imgui {
@@ -42,7 +48,16 @@ private:
   ui::DisplayState displayState;
   VideoWindow videoWindow;
   Controls controls;
-  int64_t tLastPresent{0};
+  vivictpp::ui::FramePacer framePacer;
+  int64_t alignedClockOrigin{0};
+  // True while the seek bar is dragged, frames come from the scrub cache
+  bool scrubbing{false};
+  vivictpp::video::DifferenceWorker differenceWorker;
+  vivictpp::video::FrameExporter frameExporter;
+  // Start of the range to export, marked by the first press of Ctrl-E
+  vivictpp::time::Time exportRangeStart{vivictpp::time::NO_TIME};
+  PresentationStats presentationStats;
+  PerformanceHud performanceHud;
   FileDialog fileDialog;
   MainMenu mainMenu;
   SettingsDialog settingsDialog;
@@ -60,6 +75,12 @@ private:
   std::vector<Action>
   handleEvents(std::vector<std::shared_ptr<vivictpp::imgui::Event>> events);
   void handleActions(std::vector<vivictpp::imgui::Action> actions);
+  void showScrubFrames(vivictpp::time::Time pts);
+  void exportFrames(bool visibleArea);
+  void exportRange();
+  void submitExportFrames();
+  std::filesystem::path exportPath(size_t input, vivictpp::time::Time pts);
+  void onInputsOpened();
   void openFile(const vivictpp::imgui::Action &action);
   void openQualityFile(const vivictpp::imgui::Action &action);
   void loadMetricsCallback(
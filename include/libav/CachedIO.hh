@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_LIBAV_CACHEDIO_HH_
+#define VIVICTPP_LIBAV_CACHEDIO_HH_
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+}
+
+#include <string>
+
+namespace vivictpp::libav {
+
+class SegmentCache;
+
+// The cache shared by all inputs
+SegmentCache &sharedSegmentCache();
+
+// Whether inputFile is an HLS or DASH playlist on a http(s) server, whose
+// playlists and segments should be read through the shared segment cache.
+// options are the format options of the input.
+bool useSegmentCache(const std::string &inputFile, AVDictionary *options);
+
+// Makes the demuxer of formatContext read the playlists and segments it
+// opens through the shared segment cache. Must be called before
+// avformat_open_input, options are the options passed to it.
+void installSegmentCache(AVFormatContext *formatContext,
+                         AVDictionary **options);
+
+// Reads the playlist inputFile through the shared segment cache, so that its
+// segments are prefetched. The result is to be used as the pb of the format
+// context and closed with closeCachedInput after avformat_close_input.
+// Throws if inputFile can not be fetched.
+AVIOContext *openCachedInput(const std::string &inputFile,
+                             AVDictionary *options);
+void closeCachedInput(AVIOContext **pb);
+
+} // namespace vivictpp::libav
+
+#endif // VIVICTPP_LIBAV_CACHEDIO_HH_
@@ -50,7 +50,7 @@ private:
   void initCodecContext(AVCodecParameters *codecParameters,
                         const DecoderOptions &decoderOptions);
   void initHardwareContext(std::vector<std::string> hwAccels);
-  void openCodec();
+  void openCodec(int threads);
   void logAudioCodecInfo();
   void selectSwPixelFormat();
 };
@@ -14,6 +14,8 @@ namespace libav {
 struct DecoderOptions {
   std::vector<std::string> hwAccels;
   std::vector<std::string> preferredDecoders;
+  // Number of decoding threads, 0 lets libavcodec decide
+  int threads{0};
 };
 
 } // namespace libav
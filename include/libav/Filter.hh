@@ -67,9 +67,16 @@ public:
 
 private:
   void configure();
+  // Converts a frame from reduceFrom to the 8 bit display format
+  Frame reduceBitDepth(const Frame &frame);
 
 private:
   VideoFilterFormatParameters formatParameters;
+  // Set when the graph outputs 10 or 12 bit frames that are converted to 8
+  // bits after filtering, instead of by the format filter
+  AVPixelFormat reduceFrom{AV_PIX_FMT_NONE};
+  std::shared_ptr<AVBufferPool> bufferPool;
+  int bufferPoolSize{0};
 };
 
 class AudioFilter : public Filter {
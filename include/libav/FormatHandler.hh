@@ -23,6 +23,11 @@ extern "C" {
 namespace vivictpp {
 namespace libav {
 
+// Adds probesize and analyzeduration to formatOptions, unless they are
+// already given, to limit how much of an input is read to find its streams
+std::string withProbeLimits(const std::string &formatOptions, int probeSizeKb,
+                            int analyzeDurationMs);
+
 class FormatHandler {
 public:
   explicit FormatHandler(std::string inputFile, std::string formatOptions = "");
@@ -47,6 +52,8 @@ public:
   std::string inputFile;
 
 private:
+  // The top level playlist when read through the segment cache
+  AVIOContext *cachedInput{nullptr};
   AVPacket *packet;
   vivictpp::logging::Logger logger;
   vivictpp::logging::Logger seeklog;
@@ -6,6 +6,7 @@
 #define LIBAV_FRAME_HH
 
 #include <memory>
+#include <utility>
 
 extern "C" {
 #include <libavutil/avutil.h>
@@ -23,9 +24,16 @@ private:
 
 public:
   Frame();
+  // Copies clone the AVFrame, taking new references to its buffers
   Frame(const Frame &frame);
+  // Moves transfer the AVFrame, leaving the source empty
+  Frame(Frame &&frame) noexcept = default;
   ~Frame() = default;
   Frame &operator=(const Frame &frame);
+  Frame &operator=(Frame &&frame) noexcept = default;
+  // Returns a handle to the same AVFrame without cloning it. The frame must
+  // not be modified through any of the handles after sharing.
+  Frame share() const { return Frame(frame); }
   AVFrame *avFrame() const { return frame.get(); }
   std::shared_ptr<AVFrame> operator->() const { return frame; }
   bool empty() const { return !frame; }
@@ -50,6 +58,7 @@ public:
 
 private:
   Frame(AVFrame *avFrame);
+  Frame(std::shared_ptr<AVFrame> frame) : frame(std::move(frame)) {}
 };
 
 void freeFrame(AVFrame *avFrame);
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_LIBAV_PROBECACHE_HH_
+#define VIVICTPP_LIBAV_PROBECACHE_HH_
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace vivictpp::libav {
+
+// Stream info found by avformat_find_stream_info, kept so that inputs opened
+// several times, for playback, indexing and scrubbing, are only probed once.
+class ProbeCache {
+public:
+  // Fills in the stream info of formatContext from an earlier probe of key.
+  // If the same key is being probed by another thread, waits for that probe
+  // to finish. Returns false if there is no stream info for key, or if it
+  // does not match the streams of formatContext. The caller must then probe
+  // and call store or abandon.
+  bool lookup(const std::string &key, AVFormatContext *formatContext);
+  void store(const std::string &key, const AVFormatContext *formatContext);
+  // Called instead of store if probing failed
+  void abandon(const std::string &key);
+  size_t size();
+
+private:
+  struct StreamInfo {
+    std::shared_ptr<AVCodecParameters> codecpar;
+    AVRational timeBase;
+    AVRational avgFrameRate;
+    AVRational rFrameRate;
+    AVRational sampleAspectRatio;
+    int64_t startTime;
+    int64_t duration;
+    int64_t nbFrames;
+  };
+  struct Entry {
+    int64_t startTime;
+    int64_t duration;
+    int64_t bitRate;
+    std::vector<StreamInfo> streams;
+  };
+
+  static bool matches(const Entry &entry,
+                      const AVFormatContext *formatContext);
+  static void apply(const Entry &entry, AVFormatContext *formatContext);
+
+  std::mutex m;
+  std::condition_variable probeDone;
+  std::map<std::string, Entry> entries;
+  // Keys currently being probed
+  std::set<std::string> probing;
+};
+
+} // namespace vivictpp::libav
+
+#endif // VIVICTPP_LIBAV_PROBECACHE_HH_
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_LIBAV_SEGMENTCACHE_HH_
+#define VIVICTPP_LIBAV_SEGMENTCACHE_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivictpp::libav {
+
+// Cache of the playlists and segments of HLS and DASH inputs, shared by all
+// format handlers so that an input opened for both playback and indexing is
+// only downloaded once, and seeking back does not download again. Segments
+// following the one last requested from a playlist are prefetched. The least
+// recently used segments are moved to disk when the memory budget is
+// exceeded, and deleted when the disk budget is exceeded.
+class SegmentCache {
+public:
+  using Data = std::shared_ptr<const std::vector<uint8_t>>;
+  struct Request {
+    std::string url;
+    // Protocol options such as headers and cookies, as given to get.
+    // Segments are prefetched with the options their playlist was read with.
+    std::string options;
+    // Set when the cache is destroyed, a download should then give up
+    const std::atomic_bool *cancelled;
+  };
+  // Downloads the url of request, throws on failure
+  using Fetcher = std::function<Data(const Request &request)>;
+
+  struct Options {
+    size_t memoryBytes{256 * 1024 * 1024};
+    size_t diskBytes{2048ull * 1024 * 1024};
+    // Number of segments to prefetch after the requested one
+    int lookahead{3};
+    // Bytes of segment urls kept to find the segments to prefetch, the
+    // playlists read longest ago are forgotten first
+    size_t indexBytes{4 * 1024 * 1024};
+    // Created when first needed, defaults to a new directory in the system
+    // temporary directory
+    std::filesystem::path spillDir;
+  };
+
+  SegmentCache(Fetcher fetcher, Options options);
+  ~SegmentCache();
+
+  // Contents of url, from the cache if possible. Playlists are parsed to
+  // find the segments to prefetch. Throws if url can not be fetched.
+  Data get(const std::string &url, const std::string &requestOptions = "");
+  // Replaces the fetcher, for tests serving files without a network
+  void setFetcher(Fetcher fetcher);
+
+  static bool isPlaylist(const std::string &url);
+  // Resolves a uri found in the playlist at playlistUrl
+  static std::string resolve(const std::string &playlistUrl,
+                             const std::string &uri);
+
+  size_t fetchCount();
+  size_t memoryBytes();
+  size_t diskBytes();
+  bool contains(const std::string &url);
+
+private:
+  struct Entry {
+    // Null if the entry has been moved to disk
+    Data data;
+    std::filesystem::path spillFile;
+    size_t size{0};
+    std::list<std::string>::iterator lruPos;
+  };
+  struct Playlist {
+    std::vector<std::string> uris;
+    std::string requestOptions;
+    // Bytes of the uris
+    size_t bytes;
+    std::list<std::string>::iterator orderPos;
+  };
+  // Position of a segment in its playlist
+  struct SegmentPos {
+    std::string playlist;
+    size_t index;
+  };
+
+  Data fetch(const std::string &url, const std::string &requestOptions,
+             std::unique_lock<std::mutex> &lock);
+  Data load(Entry &entry);
+  void insert(const std::string &url, const Data &data);
+  void evict();
+  void erase(std::map<std::string, Entry>::iterator it);
+  // Returns false if the playlist may change and must not be cached
+  bool parsePlaylist(const std::string &url, const std::string &requestOptions,
+                     const Data &data);
+  void forgetPlaylist(const std::string &url);
+  void schedulePrefetch(const std::string &url);
+  void prefetchLoop();
+
+  Fetcher fetcher;
+  Options options;
+  std::mutex m;
+  // Signalled when a fetch finishes or prefetch work is queued
+  std::condition_variable changed;
+  std::map<std::string, Entry> entries;
+  // Most recently used first
+  std::list<std::string> lru;
+  std::set<std::string> inFlight;
+  std::map<std::string, Playlist> playlists;
+  // Playlists in the order they were read, oldest first
+  std::list<std::string> playlistOrder;
+  size_t indexBytes{0};
+  std::map<std::string, SegmentPos> segments;
+  std::deque<std::string> prefetchQueue;
+  size_t _memoryBytes{0};
+  size_t _diskBytes{0};
+  size_t fetches{0};
+  uint64_t spillCounter{0};
+  bool stop{false};
+  std::atomic_bool cancelled{false};
+  std::thread prefetchThread;
+};
+
+} // namespace vivictpp::libav
+
+#endif // VIVICTPP_LIBAV_SEGMENTCACHE_HH_
@@ -39,4 +39,44 @@ void setLogLevels(const std::map<std::string, std::string> &logLevels,
 } // namespace logging
 } // namespace vivictpp
 
+// Logging macros for hot paths. Unlike calling logger->debug(...) directly,
+// the level is checked before the arguments are evaluated, so expensive
+// arguments cost nothing when the level is disabled. Levels below
+// VPP_LOG_ACTIVE_LEVEL are compiled out entirely, release builds set it to
+// SPDLOG_LEVEL_INFO.
+#ifndef VPP_LOG_ACTIVE_LEVEL
+#define VPP_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+#define VPP_LOG(logger, level, ...)                                            \
+  do {                                                                         \
+    if ((logger)->should_log(level)) {                                         \
+      (logger)->log(level, __VA_ARGS__);                                       \
+    }                                                                          \
+  } while (0)
+
+// Keeps the arguments type checked and "used" without ever evaluating them
+#define VPP_LOG_DISABLED(logger, level, ...)                                   \
+  do {                                                                         \
+    if (false) {                                                               \
+      (logger)->log(level, __VA_ARGS__);                                       \
+    }                                                                          \
+  } while (0)
+
+#if VPP_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define VPP_LOG_TRACE(logger, ...)                                             \
+  VPP_LOG(logger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define VPP_LOG_TRACE(logger, ...)                                             \
+  VPP_LOG_DISABLED(logger, spdlog::level::trace, __VA_ARGS__)
+#endif
+
+#if VPP_LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define VPP_LOG_DEBUG(logger, ...)                                             \
+  VPP_LOG(logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define VPP_LOG_DEBUG(logger, ...)                                             \
+  VPP_LOG_DISABLED(logger, spdlog::level::debug, __VA_ARGS__)
+#endif
+
 #endif // LOGGING_LOGGING_HH
@@ -7,9 +7,11 @@
 
 #include "AVSync.hh"
 #include "audio/AudioOutput.hh"
+#include "audio/AudioRingBuffer.hh"
 #include "sdl/SDLUtils.hh"
 #include "time/Time.hh"
 #include "workers/FrameBuffer.hh"
+#include <atomic>
 #include <memory>
 
 extern "C" {
@@ -26,29 +28,43 @@ struct AudioBuffer {
   int64_t pts{0};
 };
 
+// Audio output driven by the SDL audio callback, which pulls samples from a
+// lock free ring buffer. The position of the callback in the ring is
+// recorded with a timestamp, so that currentPts() can interpolate between
+// callbacks instead of moving in steps of whole device buffers.
 class SDLAudioOutput : public vivictpp::audio::AudioOutput {
 public:
   SDLAudioOutput(AVCodecContext *codecContext);
   ~SDLAudioOutput();
   void start() override;
   void stop() override;
-  void queueAudio(const vivictpp::libav::Frame &frame) override;
+  void queueAudio(const vivictpp::libav::Frame &frame,
+                  vivictpp::time::Time pts) override;
   void clearQueue() override;
   vivictpp::time::Time currentPts() override;
   uint32_t queuedSamples();
   vivictpp::time::Time queueDuration() override;
 
 private:
-  void nextFrame();
+  static void audioCallback(void *userdata, Uint8 *stream, int len);
+  void fill(Uint8 *stream, int len);
 
 private:
-  vivictpp::time::Time lastPts;
+  static constexpr int RING_BUFFER_MILLIS = 500;
   SDL_AudioSpec obtainedSpec;
   SDL_AudioDeviceID audioDevice;
-  AudioBuffer audioBuffer;
   AVSampleFormat sampleFormat;
   int channels;
   int bytesPerSample;
+  std::unique_ptr<vivictpp::audio::AudioRingBuffer> ringBuffer;
+  // Ring position and pts of the first sample queued after the last flush
+  uint64_t basePos{0};
+  vivictpp::time::Time basePts{vivictpp::time::NO_TIME};
+  // Ring read position and time of the last callback, written by the
+  // callback and guarded by a sequence counter
+  std::atomic<uint32_t> clockSeq{0};
+  std::atomic<uint64_t> clockPos{0};
+  std::atomic<int64_t> clockTime{0};
 };
 
 class SDLAudioOutputFactory : public vivictpp::audio::AudioOutputFactory {
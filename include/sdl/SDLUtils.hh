@@ -47,10 +47,19 @@ public:
   SDLTexture() {}
   SDLTexture(SDL_Renderer *renderer, int w, int h,
              SDL_PixelFormatEnum pixelFormat);
-  void update(const vivictpp::libav::Frame &frame);
+  // Uploads frame to the texture. If rect is not null only that part of the
+  // frame is uploaded, x and y of rect must be even.
+  void update(const vivictpp::libav::Frame &frame,
+              const SDL_Rect *rect = nullptr);
+  // Uploads w x h pixels of yuv420p planes to position x, y in the texture.
+  // x, y, w and h must be even.
+  void updateAt(const uint8_t *const planes[3], const int linesizes[3], int x,
+                int y, int w, int h);
+  // Uploads a whole frame of packed pixels, for textures that are not yuv
+  void updatePixels(const uint8_t *pixels, int pitch);
   bool operator!() const { return !texturePtr; }
   TexturePtr &operator->() { return texturePtr; }
-  SDL_Texture *get() { return texturePtr.get(); }
+  SDL_Texture *get() const { return texturePtr.get(); }
 
 private:
   TexturePtr texturePtr;
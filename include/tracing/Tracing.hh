@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_TRACING_TRACING_HH_
+#define VIVICTPP_TRACING_TRACING_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Lightweight span tracing of the playback hot paths. Each thread records
+// spans to its own fixed size ring buffer without locking, a disabled span
+// costs one relaxed atomic load. A buffer is allocated when its thread traces
+// its first span, and released when the thread has exited and its spans have
+// been written or cleared. Traces are written in the Chrome trace event
+// format, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+
+namespace vivictpp::tracing {
+
+inline std::atomic<bool> tracingEnabled{false};
+
+inline bool isEnabled() {
+  return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enabled);
+
+int64_t nowNanos();
+
+// name must be a string literal, or otherwise outlive the trace
+void recordSpan(const char *name, int64_t startNanos, int64_t endNanos);
+
+// Sets the name of the calling thread shown in the trace
+void setThreadName(const std::string &name);
+
+// Writes all recorded spans as Chrome trace JSON
+void writeChromeTrace(const std::filesystem::path &path);
+
+void clear();
+
+class ScopedSpan {
+public:
+  explicit ScopedSpan(const char *name)
+      : name(isEnabled() ? name : nullptr), start(this->name ? nowNanos() : 0) {
+  }
+  ~ScopedSpan() {
+    if (name) {
+      recordSpan(name, start, nowNanos());
+    }
+  }
+  ScopedSpan(const ScopedSpan &) = delete;
+  ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+private:
+  const char *name;
+  int64_t start;
+};
+
+} // namespace vivictpp::tracing
+
+#define VPP_TRACE_CONCAT_INNER(a, b) a##b
+#define VPP_TRACE_CONCAT(a, b) VPP_TRACE_CONCAT_INNER(a, b)
+#define VPP_TRACE_SPAN(name)                                                   \
+  vivictpp::tracing::ScopedSpan VPP_TRACE_CONCAT(vppTraceSpan_, __LINE__)(name)
+
+#endif // VIVICTPP_TRACING_TRACING_HH_
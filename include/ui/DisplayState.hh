@@ -10,6 +10,7 @@
 #include <cmath>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "VideoMetadata.hh"
@@ -17,6 +18,7 @@
 #include "libav/Frame.hh"
 #include "qualitymetrics/QualityMetrics.hh"
 #include "time/Time.hh"
+#include "video/Difference.hh"
 
 namespace vivictpp {
 namespace ui {
@@ -57,6 +59,15 @@ struct SeekBarState {
   bool seeking{false};
 };
 
+// Part of a video that is visible in the video window, in normalized
+// coordinates of the video
+struct VisibleRect {
+  float x0{0};
+  float y0{0};
+  float x1{1};
+  float y1{1};
+};
+
 struct DisplayState {
   float splitPercent{50};
   //  int zoom{0};
@@ -69,6 +80,13 @@ struct DisplayState {
   bool displayMetadata{true};
   bool displayPlot{false};
   bool splitScreenDisabled{false};
+  // Shows all inputs side by side in a grid instead of the left/right wipe
+  bool gridLayout{false};
+  // Shows the difference of the left and right video instead of the wipe
+  vivictpp::video::DifferenceMode differenceMode{
+      vivictpp::video::DifferenceMode::OFF};
+  vivictpp::video::DifferenceStatus differenceStatus{
+      vivictpp::video::DifferenceStatus::READY};
   bool fitToScreen{false};
   bool isPlaying{false};
   vivictpp::time::Time pts{0};
@@ -76,8 +94,13 @@ struct DisplayState {
   int leftFrameOffset{0};
   vivictpp::libav::Frame leftFrame;
   vivictpp::libav::Frame rightFrame;
+  // Frames of inputs beyond the first two, only shown in the grid layout
+  std::vector<vivictpp::libav::Frame> extraFrames;
+  VisibleRect leftVisibleRect;
+  VisibleRect rightVisibleRect;
   VideoMetadata leftVideoMetadata;
   VideoMetadata rightVideoMetadata;
+  std::vector<VideoMetadata> extraVideoMetadata;
   libav::DecoderMetadata leftDecoderMetadata;
   libav::DecoderMetadata rightDecoderMetadata;
   int videoMetadataVersion{0};
@@ -87,19 +110,31 @@ struct DisplayState {
   bool displayAbout{false};
   bool displaySettingsDialog{false};
   bool displayLogs{false};
+  bool displayPresentationStats{false};
+  bool displayPerformanceHud{false};
   std::shared_ptr<vivictpp::qualitymetrics::QualityMetrics> leftQualityMetrics;
   std::shared_ptr<vivictpp::qualitymetrics::QualityMetrics> rightQualityMetrics;
 
-  void updateFrames(std::array<vivictpp::libav::Frame, 2> frames) {
-    leftFrame = frames[0];
-    rightFrame = frames[1];
+  void updateFrames(std::vector<vivictpp::libav::Frame> frames) {
+    leftFrame = std::move(frames[0]);
+    rightFrame = std::move(frames[1]);
+    extraFrames.resize(frames.size() - 2);
+    for (size_t i = 2; i < frames.size(); i++) {
+      extraFrames[i - 2] = std::move(frames[i]);
+    }
   };
 
-  void updateMetadata(std::array<std::vector<VideoMetadata>, 2> metadata) {
+  void updateMetadata(std::vector<std::vector<VideoMetadata>> metadata) {
     leftVideoMetadata = metadata[0][0];
     if (!metadata[1].empty()) {
       rightVideoMetadata = metadata[1][0];
     }
+    extraVideoMetadata.clear();
+    for (size_t i = 2; i < metadata.size(); i++) {
+      if (!metadata[i].empty()) {
+        extraVideoMetadata.push_back(metadata[i][0]);
+      }
+    }
     videoMetadataVersion++;
   }
 
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_UI_FRAMEPACER_HH_
+#define VIVICTPP_UI_FRAMEPACER_HH_
+
+#include "time/Time.hh"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace vivictpp::ui {
+
+struct PresentInfo {
+  // pts of the frame that was presented
+  vivictpp::time::Time pts{0};
+  // pts of the playback clock at the vsync the frame was presented for
+  vivictpp::time::Time clockPts{0};
+  // nominal frame duration in stream time
+  vivictpp::time::Time frameDuration{0};
+  double speed{1.0};
+  bool playing{false};
+};
+
+struct PresentRecord {
+  int64_t presentTime{0}; // micros, as returned by relativeTimeMicros
+  int64_t interval{0};    // micros since previous present
+  vivictpp::time::Time pts{0};
+  vivictpp::time::Time clockPts{0};
+  bool playing{false};
+  bool newFrame{false};
+  bool missedVsync{false};
+  bool late{false};
+  bool duplicated{false};
+};
+
+struct PresentStats {
+  double refreshRate{0};
+  int64_t presents{0};
+  int64_t missedVsyncs{0};
+  int64_t lateFrames{0};
+  int64_t duplicatedFrames{0};
+  // Standard deviation of how long after its due time a new frame is shown
+  double judderMs{0};
+  double meanIntervalMs{0};
+  double maxIntervalMs{0};
+};
+
+// Keeps track of when frames are presented, predicts the next vsync and
+// records statistics of missed vsyncs, late and duplicated frames.
+class FramePacer {
+public:
+  FramePacer(size_t historySize = 600);
+  // Nominal refresh rate of the display, used as a starting point when
+  // estimating the vsync interval. 0 if unknown.
+  void setDisplayRefreshRate(int refreshRate);
+  int64_t predictNextVsync(int64_t now) const;
+  // Moves a playback clock origin forward, less than one refresh interval,
+  // so that frame boundaries fall a quarter interval after a vsync. This keeps
+  // the cadence stable, e.g. 3:2 for 24p on 60 Hz, instead of jittering when
+  // frame boundaries and vsyncs coincide.
+  int64_t alignClockOrigin(int64_t clockOrigin) const;
+  void recordPresent(int64_t presentTime, const PresentInfo &presentInfo);
+  PresentStats getStats() const;
+  // Recorded presents, oldest first
+  std::vector<PresentRecord> getHistory() const;
+  void resetStats();
+  void exportCsv(const std::filesystem::path &path) const;
+  int64_t getRefreshInterval() const { return refreshInterval; }
+
+private:
+  void updateRefreshInterval(int64_t interval);
+
+  std::vector<PresentRecord> history;
+  size_t historyPos{0};
+  size_t historyCount{0};
+  int64_t nominalRefreshInterval{0};
+  int64_t refreshInterval{16667};
+  int64_t lastPresentTime{0};
+  vivictpp::time::Time lastPts{vivictpp::time::NO_TIME};
+  int holdVsyncs{0};
+  PresentStats stats;
+};
+
+} // namespace vivictpp::ui
+
+#endif // VIVICTPP_UI_FRAMEPACER_HH_
@@ -8,32 +8,64 @@
 #include "sdl/SDLUtils.hh"
 #include "video/VideoIndexer.hh"
 
+#include <vector>
+
 namespace vivictpp::ui {
 
+// Part of an atlas page holding a single thumbnail, in texture coordinates
+struct ThumbnailRegion {
+  SDL_Texture *texture{nullptr};
+  float u0{0};
+  float v0{0};
+  float u1{0};
+  float v1{0};
+  vivictpp::time::Time pts{vivictpp::time::NO_TIME};
+};
+
+// Packs all thumbnails of a video index into atlas textures. Each thumbnail
+// is uploaded once when it becomes available, after that looking up a
+// thumbnail is a binary search by pts and does not touch the GPU.
 class ThumbnailTexture {
 public:
   ThumbnailTexture(SDL_Renderer *renderer)
-      : renderer(renderer), width(128), height(72),
-        texture(renderer, width, height, SDL_PIXELFORMAT_YV12){};
-  vivictpp::sdl::SDLTexture &
-  updateAndGetTexture(const vivictpp::time::Time &pts);
+      : renderer(renderer), width(128), height(72){};
   void setVideoIndex(std::shared_ptr<vivictpp::video::VideoIndex> videoIndex) {
     this->videoIndex = videoIndex;
+    reset();
   }
+  // Uploads thumbnails added to the index since the last call
+  void update();
+  // Region of the thumbnail at or before pts
+  ThumbnailRegion getRegion(vivictpp::time::Time pts) const;
   int getWidth() const { return width; }
   int getHeight() const { return height; }
 
 private:
-  const vivictpp::video::Thumbnail &
-  getThumbnail(const vivictpp::time::Time &pts);
+  struct Entry {
+    vivictpp::time::Time pts;
+    int slot;
+    int width;
+    int height;
+  };
+  void reset();
+  int allocateSlot();
+  ThumbnailRegion region(const Entry &entry) const;
 
 private:
+  static constexpr int MAX_PAGE_SIZE = 2048;
   SDL_Renderer *renderer;
-  vivictpp::time::Time currentTime{vivictpp::time::NO_TIME};
   std::shared_ptr<vivictpp::video::VideoIndex> videoIndex;
+  int uploadedVersion{-1};
+  int uploadedGeneration{-1};
+  // Sorted by pts
+  std::vector<Entry> entries;
+  std::vector<vivictpp::sdl::SDLTexture> pages;
+  int nextSlot{0};
+  int columns{0};
+  int rows{0};
+  // Size of an atlas cell, the size of the largest thumbnail
   int width;
   int height;
-  vivictpp::sdl::SDLTexture texture;
 };
 } // namespace vivictpp::ui
 
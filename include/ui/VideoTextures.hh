@@ -8,6 +8,9 @@
 #include "Resolution.hh"
 #include "sdl/SDLUtils.hh"
 #include "ui/DisplayState.hh"
+#include "video/Difference.hh"
+
+#include <vector>
 
 namespace vivictpp::ui {
 
@@ -15,16 +18,52 @@ class VideoTextures {
 public:
   vivictpp::sdl::SDLTexture leftTexture;
   vivictpp::sdl::SDLTexture rightTexture;
+  // Textures for inputs beyond the first two, always fully uploaded and only
+  // while the grid layout is shown
+  std::vector<vivictpp::sdl::SDLTexture> extraTextures;
+  // Difference of the left and right frame, drawn instead of them when the
+  // difference view is on
+  vivictpp::sdl::SDLTexture differenceTexture;
   Resolution nativeResolution;
   AVRational nativeAspectRatio;
 
 public:
   bool update(SDL_Renderer *renderer, const DisplayState &displayState);
+  // Uploads newly visible parts of the current frames after zoom or scroll,
+  // and the extra frames if the grid layout has been turned on since they
+  // changed. Returns true if any part of a frame had to be uploaded again
+  bool updateVisibleRegion(const DisplayState &displayState);
+  // Uploads image to differenceTexture unless it is already uploaded
+  void updateDifference(
+      SDL_Renderer *renderer,
+      const std::shared_ptr<const vivictpp::video::DifferenceImage> &image);
+  void clearDifference() { uploadedDifference.reset(); }
+  // Image in differenceTexture, null if there is none
+  const std::shared_ptr<const vivictpp::video::DifferenceImage> &
+  difference() const {
+    return uploadedDifference;
+  }
 
 private:
+  // Part of a texture holding the current frame
+  struct UploadedRegion {
+    bool valid{false};
+    bool full{false};
+    SDL_Rect rect{0, 0, 0, 0};
+  };
+
   bool initTextures(SDL_Renderer *renderer, const DisplayState &displayState);
   void calcNativeResolution(const DisplayState &displayState);
+  void upload(vivictpp::sdl::SDLTexture &texture,
+              const vivictpp::libav::Frame &frame,
+              const VisibleRect &visibleRect, UploadedRegion &region);
+  void uploadExtraFrames(const DisplayState &displayState);
   int videoMetadataVersion{-1};
+  UploadedRegion leftRegion;
+  UploadedRegion rightRegion;
+  // Set when the extra frames changed while the grid layout was hidden
+  bool extraTexturesDirty{false};
+  std::shared_ptr<const vivictpp::video::DifferenceImage> uploadedDifference;
 };
 } // namespace vivictpp::ui
 
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_BILINEAR_HH
+#define VIVICTPP_VIDEO_BILINEAR_HH
+
+#include "video/CpuFeatures.hh"
+
+#include <cstdint>
+
+namespace vivictpp::video {
+
+// Rectangle in source pixel coordinates, may have fractional position and size
+struct SourceRect {
+  double x;
+  double y;
+  double w;
+  double h;
+};
+
+template <typename T> struct Plane {
+  T *data;
+  int stride; // in samples, not bytes
+  int width;
+  int height;
+};
+
+// Resamples the srcRect area of src to fill all of dst using bilinear
+// interpolation. Sample positions are pixel center aligned, same as the GPU
+// does when sampling a texture with linear filtering. Positions are computed
+// in 16.16 fixed point and interpolation weights have 8 bits of precision.
+// All simd levels produce bit exact results, SimdLevel::SCALAR is the
+// reference implementation.
+void bilinearResample(const Plane<const uint8_t> &src, const SourceRect &srcRect,
+                      const Plane<uint8_t> &dst,
+                      SimdLevel simdLevel = detectSimdLevel());
+
+// Same as above for 16 bit samples, supports bit depths up to 12 bits
+void bilinearResample(const Plane<const uint16_t> &src,
+                      const SourceRect &srcRect, const Plane<uint16_t> &dst,
+                      SimdLevel simdLevel = detectSimdLevel());
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_BILINEAR_HH
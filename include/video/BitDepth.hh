@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_BITDEPTH_HH
+#define VIVICTPP_VIDEO_BITDEPTH_HH
+
+#include "video/Bilinear.hh"
+#include "video/CpuFeatures.hh"
+
+#include <cstdint>
+
+namespace vivictpp::video {
+
+// Converts samples with bitDepth significant bits, 9 to 16, to 8 bits by
+// dropping the low bits with rounding. Formats that store samples in the most
+// significant bits, such as P010, are converted with a bitDepth of 16. With
+// dither, an 8x8 ordered dither pattern is used instead of rounding, which
+// avoids banding in smooth gradients but changes flat areas slightly. src and
+// dst must have the same size. All simd levels produce bit exact results.
+void reduceBitDepth(const Plane<const uint16_t> &src, int bitDepth,
+                    const Plane<uint8_t> &dst, bool dither = false,
+                    SimdLevel simdLevel = detectSimdLevel());
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_BITDEPTH_HH
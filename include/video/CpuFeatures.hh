@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_CPUFEATURES_HH
+#define VIVICTPP_VIDEO_CPUFEATURES_HH
+
+// Compile time availability of SIMD code paths. AVX2 code is compiled with a
+// target attribute (or unconditionally on MSVC) and only called after a
+// runtime check, NEON is always present on the arm64 targets we build for.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define VIVICTPP_HAVE_AVX2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define VIVICTPP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VIVICTPP_TARGET_AVX2
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define VIVICTPP_HAVE_NEON 1
+#endif
+
+namespace vivictpp::video {
+
+enum class SimdLevel { SCALAR, AVX2, NEON };
+
+// Best SIMD level supported by both the build and the cpu we are running on
+SimdLevel detectSimdLevel();
+
+const char *simdLevelName(SimdLevel simdLevel);
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_CPUFEATURES_HH
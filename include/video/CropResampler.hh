@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_CROPRESAMPLER_HH
+#define VIVICTPP_VIDEO_CROPRESAMPLER_HH
+
+#include "libav/Frame.hh"
+#include "video/Bilinear.hh"
+
+namespace vivictpp::video {
+
+// Returns true if resampleCrop supports the pixel format of frame
+bool canResampleCrop(const vivictpp::libav::Frame &frame);
+
+// Resamples the crop area (in luma pixel coordinates) of a planar 4:2:0 frame,
+// 8 or 10 bit, into a new frame of size width x height. Used to bring inputs
+// of different resolution to the same size for the difference view. The
+// zoomed view does not use it, it draws the visible part of the full frame
+// texture and lets the gpu scale it.
+vivictpp::libav::Frame resampleCrop(const vivictpp::libav::Frame &frame,
+                                    const SourceRect &crop, int width,
+                                    int height);
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_CROPRESAMPLER_HH
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_DIFFERENCE_HH
+#define VIVICTPP_VIDEO_DIFFERENCE_HH
+
+#include "video/Bilinear.hh"
+#include "video/CpuFeatures.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace vivictpp::video {
+
+enum class DifferenceMode {
+  OFF,
+  // Per pixel difference of luma and chroma, amplified and false coloured
+  DIFFERENCE,
+  // Luma PSNR per block, on top of a dimmed copy of the left frame
+  HEATMAP
+};
+
+// Whether the difference of the frames that are shown can be displayed
+enum class DifferenceStatus {
+  READY,
+  // Still being computed, the image of earlier frames is shown if there is
+  // one
+  COMPUTING,
+  // The frames have pixel formats that can not be compared
+  UNSUPPORTED
+};
+
+constexpr int HEATMAP_BLOCK_SIZE = 16;
+// Reported for identical planes
+constexpr double MAX_PSNR = 100.0;
+
+// 8 bit 4:2:0 frame. Chroma is either two planes, or a single plane with
+// interleaved u and v samples, as in nv12, in which case v is unused. The
+// two frames compared may use different chroma layouts.
+struct YuvPlanes {
+  Plane<const uint8_t> y;
+  Plane<const uint8_t> u;
+  Plane<const uint8_t> v;
+  bool interleavedChroma{false};
+};
+
+struct DifferenceImage {
+  int width{0};
+  int height{0};
+  // 4 bytes per pixel, in r, g, b, a order
+  std::vector<uint8_t> rgba;
+  // Luma PSNR of the whole frame
+  double psnr{MAX_PSNR};
+};
+
+// |a - b| per sample, a, b and dst must have the same size
+void absDifference(const Plane<const uint8_t> &a, const Plane<const uint8_t> &b,
+                   const Plane<uint8_t> &dst,
+                   SimdLevel simdLevel = detectSimdLevel());
+
+// Sum of (a - b)^2 over all samples, a and b must have the same size
+uint64_t sumSquaredDifference(const Plane<const uint8_t> &a,
+                              const Plane<const uint8_t> &b,
+                              SimdLevel simdLevel = detectSimdLevel());
+
+// PSNR of 8 bit samples, MAX_PSNR if sse is 0
+double psnr(uint64_t sse, uint64_t samples);
+
+// Renders the difference of two frames of the same size in mode, which must
+// not be OFF. In DIFFERENCE mode the difference is multiplied by gain before
+// it is coloured.
+DifferenceImage differenceImage(const YuvPlanes &left, const YuvPlanes &right,
+                                DifferenceMode mode, int gain,
+                                SimdLevel simdLevel = detectSimdLevel());
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_DIFFERENCE_HH
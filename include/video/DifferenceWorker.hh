@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_DIFFERENCEWORKER_HH
+#define VIVICTPP_VIDEO_DIFFERENCEWORKER_HH
+
+#include "libav/Frame.hh"
+#include "logging/Logging.hh"
+#include "video/Difference.hh"
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+
+namespace vivictpp::video {
+
+// Computes difference images on a background thread, so that turning the
+// difference view on, or stepping through frames with it on, never holds up
+// the render loop. Only the latest request is kept, older ones are dropped
+// when a new one arrives. Results are cached by the pts of both frames, up to
+// a byte budget, so stepping back and forth does not compute them again.
+// Results requested during playback are not cached, they would only push out
+// the ones of stepping.
+class DifferenceWorker {
+public:
+  using Image = std::shared_ptr<const DifferenceImage>;
+
+  DifferenceWorker();
+  ~DifferenceWorker();
+  DifferenceWorker(const DifferenceWorker &) = delete;
+  DifferenceWorker &operator=(const DifferenceWorker &) = delete;
+
+  // Returns the difference image of left and right if it is done, otherwise
+  // queues it and returns null. The image is empty, with zero size, if the
+  // frames have a pixel format that is not supported. Set playing when the
+  // frames are shown during playback.
+  Image get(const vivictpp::libav::Frame &left,
+            const vivictpp::libav::Frame &right, DifferenceMode mode,
+            bool playing = false);
+  static DifferenceStatus status(const Image &image) {
+    return !image             ? DifferenceStatus::COMPUTING
+           : image->width == 0 ? DifferenceStatus::UNSUPPORTED
+                               : DifferenceStatus::READY;
+  }
+  // Drops the cached images, called when the inputs change
+  void clear();
+
+  // Amplification of the difference in DifferenceMode::DIFFERENCE
+  static constexpr int GAIN = 8;
+
+private:
+  using Key = std::tuple<int64_t, int64_t, DifferenceMode>;
+  struct Request {
+    Key key;
+    vivictpp::libav::Frame left;
+    vivictpp::libav::Frame right;
+    // Incremented by clear, results of older requests are dropped
+    uint64_t generation;
+    bool playing;
+  };
+
+  void run();
+  static Image compute(const Request &request);
+  void insert(const Key &key, const Image &image);
+
+  // Two 4K images. The latest image is kept even if it is larger.
+  static constexpr size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+  std::mutex m;
+  std::condition_variable requested;
+  std::optional<Request> pending;
+  std::optional<Key> inProgress;
+  // Most recently used first
+  std::list<std::pair<Key, Image>> cache;
+  size_t cachedBytes{0};
+  // Result of the latest request made during playback
+  std::optional<std::pair<Key, Image>> latest;
+  uint64_t generation{0};
+  bool stopped{false};
+  vivictpp::logging::Logger logger;
+  std::thread thread;
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_DIFFERENCEWORKER_HH
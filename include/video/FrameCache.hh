@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_FRAMECACHE_HH_
+#define VIVICTPP_VIDEO_FRAMECACHE_HH_
+
+#include "libav/Frame.hh"
+#include "time/Time.hh"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace vivictpp::video {
+
+// Decoded and filtered frames that have been shown, by source and pts, so
+// that stepping back to a recently shown frame does not need a seek. Unlike
+// the frame buffers of the decoders the cache is kept when seeking. The
+// least recently used frames are dropped when the memory budget is exceeded.
+class FrameCache {
+public:
+  static constexpr size_t DEFAULT_MAX_BYTES = 512 * 1024 * 1024;
+
+  explicit FrameCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+  // Keeps a shared handle to frame, which is shown from pts until nextPts.
+  // nextPts is NO_TIME if the following frame is not known, the frame is
+  // then only returned for pts itself. Frames in hardware surfaces are not
+  // kept, the decoder may run out of them.
+  void put(const std::string &source, vivictpp::time::Time pts,
+           vivictpp::time::Time nextPts, const vivictpp::libav::Frame &frame);
+  // Frame of source shown at pts, or an empty frame if it is not cached
+  vivictpp::libav::Frame get(const std::string &source,
+                             vivictpp::time::Time pts);
+  void clear();
+  size_t size();
+  size_t bytes();
+
+private:
+  struct Entry {
+    vivictpp::libav::Frame frame;
+    vivictpp::time::Time nextPts;
+    size_t size;
+    std::list<std::pair<std::string, vivictpp::time::Time>>::iterator lruPos;
+  };
+
+  void evict();
+
+  size_t maxBytes;
+  std::mutex m;
+  std::map<std::string, std::map<vivictpp::time::Time, Entry>> sources;
+  // Most recently used first
+  std::list<std::pair<std::string, vivictpp::time::Time>> lru;
+  size_t _bytes{0};
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_FRAMECACHE_HH_
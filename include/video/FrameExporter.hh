@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_FRAMEEXPORTER_HH_
+#define VIVICTPP_VIDEO_FRAMEEXPORTER_HH_
+
+#include "libav/Frame.hh"
+#include "logging/Logging.hh"
+#include "time/Time.hh"
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivictpp::video {
+
+enum class ExportFormat { PNG, TIFF, PGM };
+
+// "png", "tiff" or "pgm", anything else is png
+ExportFormat parseExportFormat(const std::string &name);
+const char *exportFormatExtension(ExportFormat format);
+
+// Area of a frame in luma pixels, an empty rect is the whole frame
+struct CropRect {
+  int x{0};
+  int y{0};
+  int w{0};
+  int h{0};
+};
+
+// Encodes the crop area of frame as a lossless image. PNG and TIFF images are
+// rgb, PGM images have the luma plane only. Samples have 16 bits if the frame
+// has more than 8 bits and 8 bits otherwise. Decoded frames are reduced to 8
+// bits before they are shown, so exported frames have 8 bits.
+// Throws std::runtime_error if the frame can not be converted or encoded.
+std::vector<uint8_t> encodeImage(const vivictpp::libav::Frame &frame,
+                                 ExportFormat format,
+                                 const CropRect &crop = {});
+
+// Frames picked for export by selectExportFrames
+struct ExportSelection {
+  // Indexes into the buffered frames, per input
+  std::vector<std::vector<size_t>> frames;
+  // Every input has exported its frames up to the end of the range
+  bool done{false};
+  // Every input that is not done has exported its frames up to this pts, so
+  // playback may step to it. NO_TIME if an input has not exported any frame.
+  vivictpp::time::Time stepPts{vivictpp::time::NO_TIME};
+};
+
+// Picks at most maxFrames frames in the range from, to from the pts of the
+// frames buffered per input, which start after the pts last exported by the
+// input. exportedPts holds that pts per input, NO_TIME before the first
+// frame, and is updated. The budget is split between the inputs, those that
+// are furthest behind first, so that no input is stepped past unexported
+// frames. The first frame of an input is the one shown at from.
+ExportSelection selectExportFrames(
+    const std::vector<std::vector<vivictpp::time::Time>> &buffered,
+    vivictpp::time::Time from, vivictpp::time::Time to, size_t maxFrames,
+    std::vector<vivictpp::time::Time> &exportedPts);
+
+// Encodes and writes images on a pool of threads, so that exporting many
+// frames does not hold up playback. Frames are shared with the frame buffers
+// of the decoders, not copied.
+class FrameExporter {
+public:
+  explicit FrameExporter(int nThreads = defaultThreadCount());
+  ~FrameExporter();
+  FrameExporter(const FrameExporter &) = delete;
+  FrameExporter &operator=(const FrameExporter &) = delete;
+
+  // Queues frame to be written to path, creating its directory if needed.
+  // Never blocks, callers exporting many frames should keep pending() low.
+  void submit(const vivictpp::libav::Frame &frame, std::filesystem::path path,
+              ExportFormat format, const CropRect &crop = {});
+  // Frames queued or being encoded
+  size_t pending();
+  size_t written();
+  size_t failed();
+  // Waits until all submitted frames have been written
+  void finish();
+
+  static int defaultThreadCount();
+
+private:
+  struct Job {
+    vivictpp::libav::Frame frame;
+    std::filesystem::path path;
+    ExportFormat format;
+    CropRect crop;
+  };
+
+  void run();
+
+private:
+  std::queue<Job> queue;
+  size_t busy{0};
+  size_t _written{0};
+  size_t _failed{0};
+  bool stopped{false};
+  std::mutex mutex;
+  std::condition_variable queueChanged;
+  vivictpp::logging::Logger logger;
+  std::vector<std::thread> threads;
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_FRAMEEXPORTER_HH_
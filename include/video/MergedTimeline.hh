@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_MERGEDTIMELINE_HH_
+#define VIVICTPP_VIDEO_MERGEDTIMELINE_HH_
+
+#include "time/Time.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vivictpp::video {
+
+// The frame steps of several inputs merged into one timeline. Frames of
+// different inputs whose pts are within tolerance of each other, such as
+// 23.976 and 24 fps frames, form a single step so that stepping never shows
+// a new frame on one side together with an old frame on the other.
+// Each step maps to the frame shown on every input at that step.
+class MergedTimeline {
+public:
+  MergedTimeline() {}
+  // ptsValues holds the frame pts of each input in any order, offsets the
+  // value subtracted from the pts of each input to get timeline pts
+  MergedTimeline(
+      const std::vector<std::vector<vivictpp::time::Time>> &ptsValues,
+      const std::vector<vivictpp::time::Time> &offsets,
+      vivictpp::time::Time tolerance);
+
+  bool empty() const { return steps.empty(); }
+  size_t size() const { return steps.size(); }
+  size_t inputs() const { return framePtsValues.size(); }
+  vivictpp::time::Time stepPts(size_t step) const { return steps[step]; }
+  // Last step at or before pts, 0 if pts is before the first step. hint is
+  // checked first so that stepping from a known step is constant time.
+  size_t stepAt(vivictpp::time::Time pts, size_t hint = 0) const;
+  // Timeline pts of the step after or before the one at pts, NO_TIME if
+  // there is none
+  vivictpp::time::Time nextPts(vivictpp::time::Time pts) const;
+  vivictpp::time::Time previousPts(vivictpp::time::Time pts) const;
+  // Index, in pts order, of the frame shown on an input at a step. -1 if the
+  // input has no frame at or before the step.
+  int frameIndex(size_t step, size_t input) const {
+    return frameIndexes[input][step];
+  }
+  // Input pts of the frame shown on an input at a step, NO_TIME if none
+  vivictpp::time::Time framePts(size_t step, size_t input) const;
+
+private:
+  std::vector<vivictpp::time::Time> steps;
+  std::vector<std::vector<vivictpp::time::Time>> framePtsValues;
+  std::vector<std::vector<int32_t>> frameIndexes;
+  mutable size_t lastStep{0};
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_MERGEDTIMELINE_HH_
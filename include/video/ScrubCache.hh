@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_SCRUBCACHE_HH_
+#define VIVICTPP_VIDEO_SCRUBCACHE_HH_
+
+#include "libav/Frame.hh"
+#include "logging/Logging.hh"
+#include "time/Time.hh"
+#include "video/VideoIndexer.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vivictpp::video {
+
+// Key frames to cache around center, one per interval step and nearest to
+// center first. Each grid position is snapped to the closest key frame at or
+// before it, duplicates are removed.
+std::vector<vivictpp::time::Time>
+scrubTargets(const std::vector<vivictpp::time::Time> &keyFrames,
+             vivictpp::time::Time center, vivictpp::time::Time interval,
+             int count);
+
+// Keeps decoded key frames at regular intervals around the current position,
+// so that dragging the seek bar can show a nearby frame immediately instead
+// of waiting for a full seek. The cache is filled by a background thread with
+// its own demuxer and a software decoder, using key frame positions from the
+// video index. When idle only the few frames nearest the playback position
+// are decoded, the whole window is filled while scrubbing, see setActive.
+// Frames are kept at a reduced resolution within a byte budget.
+class ScrubCache {
+public:
+  static constexpr int CAPACITY = 32;
+  // Frames are cached at most this high, and scaled back up when shown
+  static constexpr int MAX_HEIGHT = 360;
+  static constexpr size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+  // Frames nearest the center that are decoded when not scrubbing
+  static constexpr int IDLE_TARGETS = 4;
+
+  ScrubCache(const std::string &source, const std::string &formatOptions,
+             const std::string &customFilter,
+             std::shared_ptr<VideoIndex> videoIndex,
+             size_t maxBytes = DEFAULT_MAX_BYTES);
+  ~ScrubCache();
+  ScrubCache(const ScrubCache &) = delete;
+  ScrubCache &operator=(const ScrubCache &) = delete;
+
+  // Moves the center of the cached window, wakes the decoder thread if the
+  // move is large enough to change the set of cached frames
+  void setCenter(vivictpp::time::Time pts);
+  // Starts or stops filling the whole window around the center
+  void setActive(bool active);
+  // Cached frame closest to pts scaled to the size of the video, or an empty
+  // frame if nothing is cached
+  vivictpp::libav::Frame nearest(vivictpp::time::Time pts);
+
+private:
+  struct CachedFrame {
+    vivictpp::libav::Frame frame;
+    // Size of the decoded frame before it was scaled down
+    int width;
+    int height;
+    size_t bytes;
+  };
+
+  void run();
+  vivictpp::time::Time nextTarget();
+  void erase(std::map<vivictpp::time::Time, CachedFrame>::iterator it);
+
+private:
+  std::string source;
+  std::string formatOptions;
+  std::string customFilter;
+  std::shared_ptr<VideoIndex> videoIndex;
+  vivictpp::time::Time interval{vivictpp::time::seconds(2)};
+  vivictpp::time::Time center{0};
+  vivictpp::time::Time notifiedCenter{0};
+  std::map<vivictpp::time::Time, CachedFrame> frames;
+  size_t bytes{0};
+  size_t maxBytes;
+  // Size of the last decoded frame, used to fit the targets in maxBytes
+  size_t frameBytes{0};
+  bool active{false};
+  // Last frame returned by nearest, so that it is only scaled up once
+  vivictpp::time::Time shownTarget{vivictpp::time::NO_TIME};
+  vivictpp::libav::Frame shownFrame{vivictpp::libav::Frame::emptyFrame()};
+  std::set<vivictpp::time::Time> failed;
+  std::mutex mutex;
+  std::condition_variable centerChanged;
+  std::atomic_bool stopped{false};
+  vivictpp::logging::Logger logger;
+  std::thread thread;
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_SCRUBCACHE_HH_
@@ -5,20 +5,46 @@
 #ifndef VIVICTPP_THUMBNAIL_HH
 #define VIVICTPP_THUMBNAIL_HH
 
-#include "libav/Frame.hh"
 #include "time/Time.hh"
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
 namespace vivictpp::video {
+
+// A yuv420p thumbnail with tightly packed planes, Y followed by U and V.
+// The pixel data lives in a chunk owned by a ThumbnailStore and is kept alive
+// by the thumbnail even if the store is cleared.
 class Thumbnail {
 public:
-  const vivictpp::time::Time pts;
-  const vivictpp::libav::Frame frame;
+  vivictpp::time::Time pts{vivictpp::time::NO_TIME};
+  int width{0};
+  int height{0};
+  std::shared_ptr<const uint8_t> data;
 
 public:
-  Thumbnail(const vivictpp::time::Time pts, const vivictpp::libav::Frame frame)
-      : pts(pts), frame(frame) {}
-  Thumbnail(const Thumbnail &other) : pts(other.pts), frame(other.frame) {}
+  Thumbnail() {}
+  Thumbnail(const vivictpp::time::Time pts, int width, int height,
+            std::shared_ptr<const uint8_t> data)
+      : pts(pts), width(width), height(height), data(data) {}
+  bool empty() const { return !data; }
+  int chromaWidth() const { return (width + 1) / 2; }
+  int chromaHeight() const { return (height + 1) / 2; }
+  int linesize(int plane) const { return plane == 0 ? width : chromaWidth(); }
+  const uint8_t *plane(int plane) const {
+    const uint8_t *p = data.get();
+    if (plane > 0) {
+      p += width * height;
+    }
+    if (plane > 1) {
+      p += chromaWidth() * chromaHeight();
+    }
+    return p;
+  }
+  static size_t dataSize(int width, int height) {
+    return (size_t)width * height +
+           2 * (size_t)((width + 1) / 2) * ((height + 1) / 2);
+  }
 };
 } // namespace vivictpp::video
 
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_THUMBNAILGENERATOR_HH_
+#define VIVICTPP_VIDEO_THUMBNAILGENERATOR_HH_
+
+#include "libav/Frame.hh"
+#include "libav/Packet.hh"
+#include "logging/Logging.hh"
+#include "time/Time.hh"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace vivictpp::video {
+
+// Decodes thumbnails from key frame packets on a pool of decoder threads, so
+// that indexing is not held back by decoding and scaling. Thumbnails are
+// passed to the callback as yuv420p frames as they complete, which may be out
+// of pts order.
+class ThumbnailGenerator {
+public:
+  using Callback = std::function<void(vivictpp::time::Time,
+                                      const vivictpp::libav::Frame &)>;
+
+  // stream must outlive the generator
+  ThumbnailGenerator(AVStream *stream, int maxThumbnailSize, int nThreads,
+                     Callback onThumbnail);
+  ~ThumbnailGenerator();
+  ThumbnailGenerator(const ThumbnailGenerator &) = delete;
+  ThumbnailGenerator &operator=(const ThumbnailGenerator &) = delete;
+
+  // Queues a copy of packet for decoding, blocks while the queue is full
+  void submit(vivictpp::time::Time pts, AVPacket *packet);
+  // Waits until all submitted packets have been decoded
+  void finish();
+  // Drops queued packets and stops the decoder threads
+  void stop();
+
+  static int defaultThreadCount();
+
+private:
+  void run();
+
+private:
+  AVStream *stream;
+  int maxThumbnailSize;
+  Callback onThumbnail;
+  size_t maxQueueSize;
+  std::queue<std::pair<vivictpp::time::Time, vivictpp::libav::Packet>> queue;
+  int busy{0};
+  bool stopped{false};
+  std::mutex mutex;
+  std::condition_variable queueChanged;
+  vivictpp::logging::Logger logger;
+  std::vector<std::thread> threads;
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_THUMBNAILGENERATOR_HH_
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_VIDEO_THUMBNAILSTORE_HH_
+#define VIVICTPP_VIDEO_THUMBNAILSTORE_HH_
+
+#include "time/Time.hh"
+#include "video/Thumbnail.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace vivictpp::video {
+
+// Thumbnails sorted by pts, with pixel data copied into large shared chunks
+// instead of one padded AVFrame per thumbnail. Not thread safe.
+class ThumbnailStore {
+public:
+  static constexpr size_t CHUNK_SIZE = 4 << 20;
+
+  // Copies yuv420p planes into the store. Returns false if there already is
+  // a thumbnail with the same pts.
+  bool add(vivictpp::time::Time pts, int width, int height,
+           const uint8_t *const planes[3], const int linesizes[3]);
+  // Thumbnail at or before pts, or the first one if pts is before all
+  // thumbnails. Empty if the store is empty.
+  Thumbnail get(vivictpp::time::Time pts) const;
+  bool contains(vivictpp::time::Time pts) const;
+  const std::vector<Thumbnail> &all() const { return thumbnails; }
+  // Thumbnails in the order they were added, skipping the first from
+  std::vector<Thumbnail> addedSince(size_t from) const;
+  size_t size() const { return thumbnails.size(); }
+  // Bytes allocated for pixel data
+  size_t bytesAllocated() const;
+  void clear();
+
+  void serialize(std::ostream &out) const;
+  // Replaces the contents of the store, throws std::runtime_error if the
+  // data is not a serialized store
+  void deserialize(std::istream &in);
+
+private:
+  uint8_t *allocate(size_t size, std::shared_ptr<uint8_t[]> &chunk);
+
+private:
+  std::vector<Thumbnail> thumbnails;
+  // Pts of the thumbnails in the order they were added
+  std::vector<vivictpp::time::Time> addOrder;
+  std::vector<std::shared_ptr<uint8_t[]>> chunks;
+  std::vector<size_t> chunkSizes;
+  size_t chunkUsed{0};
+};
+
+} // namespace vivictpp::video
+
+#endif // VIVICTPP_VIDEO_THUMBNAILSTORE_HH_
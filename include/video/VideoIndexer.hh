@@ -5,11 +5,15 @@
 #ifndef VIVICTPP_VIDEOINDEXER_HH
 #define VIVICTPP_VIDEOINDEXER_HH
 
+#include "libav/Frame.hh"
 #include "logging/Logging.hh"
 #include "time/Time.hh"
 #include "video/Thumbnail.hh"
+#include "video/ThumbnailStore.hh"
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace vivictpp::video {
@@ -57,7 +61,11 @@ private:
   std::vector<vivictpp::time::Time> ptsValues;
   std::vector<int> frameSizes;
   std::vector<bool> keyFrameFlag;
-  std::vector<vivictpp::video::Thumbnail> thumbnails;
+  // Sorted by pts, thumbnails are decoded in parallel and may arrive out of
+  // order
+  ThumbnailStore thumbnails;
+  std::atomic<int> thumbnailsVersion{0};
+  std::atomic<int> generation{0};
   PlotDatas plotDatas;
   int currentGopSize;
   double currentGopPts;
@@ -69,7 +77,8 @@ private:
 
   void addGop(const vivictpp::time::Time gopEndPts);
 
-  void addThumbnail(const vivictpp::video::Thumbnail &thumbnail);
+  void addThumbnail(vivictpp::time::Time pts,
+                    const vivictpp::libav::Frame &frame);
   void finalizeIndex();
   void clear();
 
@@ -82,10 +91,38 @@ public:
     std::lock_guard<std::mutex> lg(m);
     return keyFrames;
   }
-  const std::vector<vivictpp::video::Thumbnail> &getThumbnails() const {
+  // Copy of the key frames found so far, safe to call while indexing
+  std::vector<vivictpp::time::Time> copyKeyFrames() const {
     std::lock_guard<std::mutex> lg(m);
-    return thumbnails;
+    return keyFrames;
+  }
+  // Copy of the thumbnails generated so far, safe to call while indexing
+  std::vector<vivictpp::video::Thumbnail> copyThumbnails() const {
+    std::lock_guard<std::mutex> lg(m);
+    return thumbnails.all();
+  }
+  // Copy of the thumbnails added after the first from, in the order they were
+  // added
+  std::vector<vivictpp::video::Thumbnail> copyThumbnails(size_t from) const {
+    std::lock_guard<std::mutex> lg(m);
+    return thumbnails.addedSince(from);
+  }
+  // Thumbnail at or before pts, or the first one if pts is before all
+  // thumbnails. Empty if there are no thumbnails yet.
+  Thumbnail getThumbnail(vivictpp::time::Time pts) const;
+  bool hasThumbnail(vivictpp::time::Time pts) const;
+  size_t thumbnailCount() const {
+    std::lock_guard<std::mutex> lg(m);
+    return thumbnails.size();
+  }
+  size_t thumbnailBytes() const {
+    std::lock_guard<std::mutex> lg(m);
+    return thumbnails.bytesAllocated();
   }
+  // Incremented whenever a thumbnail is added
+  int getThumbnailsVersion() const { return thumbnailsVersion; }
+  // Incremented whenever the index is cleared to be rebuilt
+  int getGeneration() const { return generation; }
   const std::vector<vivictpp::time::Time> &getPtsValues() {
     std::lock_guard<std::mutex> lg(m);
     return ptsValues;
@@ -113,6 +150,9 @@ public:
   void prepareIndex(const std::string &inputFile,
                     const std::string &formatOptions,
                     const bool generatThumbnails = true);
+  // Adapts the number of thumbnails to the width of the seek bar, generating
+  // more thumbnails if needed
+  void setSeekBarWidth(int width);
 
   const std::shared_ptr<VideoIndex> getIndex() const { return index; }
 
@@ -120,9 +160,15 @@ private:
   void prepareIndexInternal(const std::string &inputFile,
                             const std::string &formatOptions,
                             bool generateThumbnails);
+  vivictpp::time::Time thumbnailInterval(vivictpp::time::Time duration,
+                                         int count) const;
   void stopIndexThread() {
     if (indexingThread) {
-      stopIndexing = true;
+      {
+        std::lock_guard<std::mutex> lg(thumbnailCountMutex);
+        stopIndexing = true;
+      }
+      thumbnailCountChanged.notify_all();
       indexingThread->join();
       indexingThread.reset();
     }
@@ -133,9 +179,14 @@ private:
   std::unique_ptr<std::thread> indexingThread;
   std::shared_ptr<VideoIndex> index;
   std::atomic_bool stopIndexing{false};
-  const int maxThumbnails = 200;
+  std::atomic<int> thumbnailCount{200};
+  std::mutex thumbnailCountMutex;
+  std::condition_variable thumbnailCountChanged;
+  const int minThumbnails = 50;
+  const int maxThumbnails = 500;
+  const int pixelsPerThumbnail = 4;
   const int maxThumbnailSize = 256;
-  const int minThumbnailInterval = 5;
+  const int minThumbnailInterval = 1;
 };
 
 }; // namespace vivictpp::video
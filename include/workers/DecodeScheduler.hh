@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_WORKERS_DECODESCHEDULER_HH_
+#define VIVICTPP_WORKERS_DECODESCHEDULER_HH_
+
+#include "time/Time.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace vivictpp::workers {
+
+// Sample of one video decoder, counters are totals since the decoder started
+struct DecoderLoad {
+  uint64_t framesDecoded{0};
+  // Time spent decoding, not counting time blocked on a full frame buffer
+  uint64_t decodeMicros{0};
+  // Decoded frames waiting to be shown
+  int bufferedFrames{0};
+  int threads{1};
+  vivictpp::time::Time frameDuration{0};
+};
+
+// Decides how the decoding threads should be split between inputs. When one
+// input keeps running out of decoded frames while another has a full buffer,
+// threads are reassigned in proportion to the cpu time each input needs per
+// second of playback.
+class DecodeScheduler {
+public:
+  static constexpr int64_t SAMPLE_INTERVAL = 1000000;
+  static constexpr int64_t REBALANCE_COOLDOWN = 10000000;
+  // Number of consecutive starved samples needed before rebalancing
+  static constexpr int STARVED_SAMPLES = 2;
+  static constexpr int LOW_WATERMARK = 2;
+  static constexpr int HIGH_WATERMARK = 10;
+
+  explicit DecodeScheduler(int totalThreads);
+  bool sampleDue(int64_t now) const {
+    return now - lastSampleTime >= SAMPLE_INTERVAL;
+  }
+  // Returns new thread counts, one per input, if the inputs should be
+  // rebalanced, otherwise an empty vector. now is in micros.
+  std::vector<int> update(int64_t now, const std::vector<DecoderLoad> &loads);
+  // Forgets collected samples, for instance after a seek
+  void reset();
+
+private:
+  std::vector<int> allocate(const std::vector<double> &needs) const;
+
+  int totalThreads;
+  std::vector<DecoderLoad> lastLoads;
+  int64_t lastSampleTime{0};
+  int64_t lastRebalanceTime{0};
+  bool rebalanced{false};
+  int starvedSamples{0};
+};
+
+} // namespace vivictpp::workers
+
+#endif // VIVICTPP_WORKERS_DECODESCHEDULER_HH_
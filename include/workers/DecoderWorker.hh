@@ -14,6 +14,7 @@
 #include "workers/FrameBuffer.hh"
 #include "workers/InputWorker.hh"
 #include "workers/PacketQueue.hh"
+#include "workers/PipelineStats.hh"
 
 #include "spdlog/spdlog.h"
 #include <atomic>
@@ -31,6 +32,9 @@ public:
                 int frameBufferSize = 50, int packetQueueSize = 256);
   virtual ~DecoderWorker();
   void seek(vivictpp::time::Time pos, vivictpp::SeekCallback callback);
+  // Stops decoding and drops all buffered packets and frames, but keeps the
+  // decoder and filter open. Decoding resumes with start and a seek.
+  void standBy();
   AVStream *getStream() { return stream; };
   AVCodecContext *getCodecContext() { return decoder->getCodecContext(); }
   FrameBuffer &frames() { return frameBuffer; }
@@ -46,6 +50,14 @@ public:
     return decoder->getMetadata();
   }
   void onEndOfFile();
+  PipelineStats &stats() { return pipelineStats; }
+  // Number of decoding threads to use after the next seek. Ignored for
+  // hardware accelerated decoding.
+  void setThreads(int threads);
+  // Lets the decoder skip non-reference frames, so that it can catch up
+  // with playback
+  void setSkipNonRef(bool skip) { skipNonRef.store(skip); }
+  size_t packetQueueSize() const { return messageQueue.dataSize(); }
 
 public:
   const int streamIndex;
@@ -60,19 +72,24 @@ private:
   void doWork() override;
   void dropFrameIfSeekingAndBufferFull();
   bool seeking() { return state == InputWorkerState::SEEKING; }
-  void addFrameToBuffer(const vivictpp::libav::Frame &frame);
+  void addFrameToBuffer(vivictpp::libav::Frame frame);
   void readFrames(AVPacket *avPacket);
+  void applyPendingThreads();
 
 private:
   AVStream *stream;
   FrameBuffer frameBuffer;
 
+  vivictpp::libav::DecoderOptions decoderOptions;
   std::shared_ptr<vivictpp::libav::Decoder> decoder;
+  std::atomic<int> pendingThreads{0};
+  std::atomic<bool> skipNonRef{false};
   std::shared_ptr<vivictpp::libav::Filter> filter;
   std::queue<vivictpp::libav::Frame> frameQueue;
   vivictpp::time::Time seekPos;
   vivictpp::time::Time lastSeenPts;
   vivictpp::SeekCallback seekCallback;
+  PipelineStats pipelineStats;
 };
 } // namespace workers
 } // namespace vivictpp
@@ -18,6 +18,7 @@ extern "C" {
 #include <iostream>
 #include <limits>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include "libav/Frame.hh"
@@ -45,6 +46,7 @@ class FrameBuffer {
 public:
   FrameBuffer(int _maxSize);
   ~FrameBuffer() = default;
+  // Shared handle to the current frame, must not be modified
   vivictpp::libav::Frame first();
   void write(vivictpp::libav::Frame frame, vivictpp::time::Time pts);
   vivictpp::time::Time nextPts();
@@ -64,6 +66,10 @@ public:
   bool waitForNotFull(const std::chrono::milliseconds &relTime);
   bool isEmpty();
   const std::vector<vivictpp::time::Time> &getPtsBuffer() { return ptsBuffer; }
+  // Shared handles to the buffered frames with pts from from to to, in the
+  // order they were decoded
+  std::vector<std::pair<vivictpp::time::Time, vivictpp::libav::Frame>>
+  framesInRange(vivictpp::time::Time from, vivictpp::time::Time to);
 
 private:
   bool next();
@@ -13,6 +13,7 @@
 
 // #include <unistd.h>
 #include "logging/Logging.hh"
+#include "tracing/Tracing.hh"
 
 namespace vivictpp {
 namespace workers {
@@ -81,7 +82,7 @@ bool InputWorker<T>::offerData(const vivictpp::workers::Data<T> &data,
 }
 
 template <class T> void InputWorker<T>::start() {
-  logger->trace("InputWorker::start()");
+  VPP_LOG_TRACE(logger, "InputWorker::start()");
   if (!thread) {
     thread.reset(new std::thread(&InputWorker<T>::run, this));
   }
@@ -130,7 +131,7 @@ template <class T> void InputWorker<T>::pollMessageQueue() {
         return;
       }
       auto data = dynamic_cast<vivictpp::workers::Data<T> &>(message);
-      logger->debug("InputWorker::pollMessageQueue Recieved DATA");
+      VPP_LOG_DEBUG(logger, "InputWorker::pollMessageQueue Recieved DATA");
       if (onData(data)) {
         messageQueue.pop();
       } else {
@@ -140,7 +141,8 @@ template <class T> void InputWorker<T>::pollMessageQueue() {
     } else {
       vivictpp::workers::Command &command =
           dynamic_cast<vivictpp::workers::Command &>(message);
-      logger->debug("InputWorker::pollMessageQueue Recieved Command '{}'",
+      VPP_LOG_DEBUG(logger,
+                    "InputWorker::pollMessageQueue Recieved Command '{}'",
                     command.name);
       if (command.apply()) {
         messageQueue.pop();
@@ -150,6 +152,7 @@ template <class T> void InputWorker<T>::pollMessageQueue() {
 }
 
 template <class T> void InputWorker<T>::run() {
+  vivictpp::tracing::setThreadName(logger->name());
   while (state == InputWorkerState::INACTIVE) {
     if (messageQueue.waitForCommand(std::chrono::milliseconds(100))) {
       pollMessageQueue();
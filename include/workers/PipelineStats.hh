@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef VIVICTPP_WORKERS_PIPELINESTATS_HH_
+#define VIVICTPP_WORKERS_PIPELINESTATS_HH_
+
+#include <atomic>
+#include <cstdint>
+
+namespace vivictpp::workers {
+
+// Counters for one decoding pipeline, written by the PacketWorker and
+// DecoderWorker threads and read by the UI without locking. Totals only ever
+// increase, readers compute rates from the difference between two samples.
+struct PipelineStats {
+  std::atomic<uint64_t> packetsDemuxed{0};
+  std::atomic<int> packetQueueDepth{0};
+  std::atomic<int> frameBufferFill{0};
+  std::atomic<uint64_t> framesDecoded{0};
+  std::atomic<uint64_t> decodeMicros{0};
+  std::atomic<int> decoderThreads{0};
+  std::atomic<uint64_t> framesFiltered{0};
+  std::atomic<uint64_t> filterMicros{0};
+  // Decoded frames that were never shown because playback had passed them
+  std::atomic<uint64_t> framesDropped{0};
+  // Number of times the decoder started skipping non-reference frames
+  std::atomic<uint64_t> catchUps{0};
+};
+
+} // namespace vivictpp::workers
+
+#endif // VIVICTPP_WORKERS_PIPELINESTATS_HH_
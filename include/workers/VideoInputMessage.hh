@@ -59,6 +59,7 @@ template <class T> class Queue {
 private:
   std::queue<std::shared_ptr<Command>> queue_;
   std::queue<std::shared_ptr<Data<T>>> dataQueue;
+  std::atomic<size_t> dataQueueSize{0};
   std::mutex mutex;
   size_t maxDataQueueSize;
   std::condition_variable conditionVariable;
@@ -67,6 +68,10 @@ private:
 public:
   Queue(size_t maxDataQueueSize) : maxDataQueueSize(maxDataQueueSize) {}
   bool empty();
+  // Number of queued data messages, readable without taking the lock
+  size_t dataSize() const {
+    return dataQueueSize.load(std::memory_order_relaxed);
+  }
   bool offerData(const Data<T> &data, const std::chrono::milliseconds &timeout);
   // pushData will ignore queue capacity
   void pushData(const Data<T> &data);
@@ -89,6 +94,7 @@ bool Queue<T>::offerData(const Data<T> &data,
   if (conditionVariable.wait_for(
           lock, timeout, [&] { return dataQueue.size() < maxDataQueueSize; })) {
     dataQueue.push(std::shared_ptr<Data<T>>(new Data<T>(data)));
+    dataQueueSize.store(dataQueue.size(), std::memory_order_relaxed);
     return true;
   }
   return false;
@@ -97,6 +103,7 @@ bool Queue<T>::offerData(const Data<T> &data,
 template <class T> void Queue<T>::pushData(const Data<T> &data) {
   std::lock_guard<std::mutex> lock(mutex);
   dataQueue.push(std::shared_ptr<Data<T>>(new Data<T>(data)));
+  dataQueueSize.store(dataQueue.size(), std::memory_order_relaxed);
 }
 
 template <class T>
@@ -111,6 +118,7 @@ template <class T> void Queue<T>::clearDataOlderThan(uint64_t serialNo) {
   while (!dataQueue.empty() && dataQueue.front()->serialNo < serialNo) {
     dataQueue.pop();
   }
+  dataQueueSize.store(dataQueue.size(), std::memory_order_relaxed);
 }
 
 template <class T> void Queue<T>::pushCommand(Command *command) {
@@ -145,6 +153,7 @@ template <class T> void Queue<T>::pop() {
     if (popData) {
       dataWasFull = dataQueue.size() == maxDataQueueSize;
       dataQueue.pop();
+      dataQueueSize.store(dataQueue.size(), std::memory_order_relaxed);
     } else {
       queue_.pop();
     }
@@ -38,6 +38,7 @@ i      Zoom out
 0      Reset pan and zoom to default
 s      Toggle scale content to fit window
 t      Toggle visibility of time
+g      Toggle grid layout showing all videos
 d      Toggle visibility of Stream and Frame metadata
 p      Toggle visibility of vmaf plot (if vmaf data present)
 
@@ -75,13 +76,18 @@ bool vivictpp::OptParser::parseOptions(int argc, char **argv) {
   app.add_option("rightVideo", rightVideo,
                  "Path or url to second (right) video");
 
+  std::vector<std::string> extraVideos;
+  app.add_option("extraVideos", extraVideos,
+                 "Paths or urls to more videos, shown in the grid layout");
+
   std::string leftFilter("");
   std::string rightFilter("");
   app.add_option("--left-filter", leftFilter, "Video filters for left video");
   app.add_option("--right-filter", rightFilter, "Video filters for left video");
 
   bool enableAudio(false);
-  //    app.add_flag("--enable-audio",  enableAudio, "Enable audio");
+  app.add_flag("--enable-audio", enableAudio,
+               "Enable audio playback from the left video");
 
   std::string leftInputFormat;
   std::string rightInputFormat;
@@ -118,6 +124,7 @@ bool vivictpp::OptParser::parseOptions(int argc, char **argv) {
   }
   if (!rightVideo.empty()) {
     sources.push_back(rightVideo);
+    sources.insert(sources.end(), extraVideos.begin(), extraVideos.end());
   }
   std::vector<std::string> filters = {leftFilter, rightFilter};
   //    std::vector<std::string> vmafLogfiles = {leftVmaf, rightVmaf};
@@ -103,11 +103,18 @@ vivictpp::Settings vivictpp::loadSettings(std::filesystem::path filePath) {
              "fontsettings.disableautoscaling");
     loadVector(settings.hwAccels, toml, "decoding.enabledHwAccels");
     loadVector(settings.preferredDecoders, toml, "decoding.preferredDecoders");
+    loadBool(settings.fastProbe, toml, "decoding.fastprobe");
+    loadInt(settings.probeSizeKb, toml, "decoding.probesizekb");
+    loadInt(settings.analyzeDurationMs, toml, "decoding.analyzedurationms");
+    loadInt(settings.standbyDecoders, toml, "decoding.standbydecoders");
     loadInt(settings.logBufferSize, toml, "logsettings.logbuffersize");
     loadBool(settings.logToFile, toml, "logsettings.logtofile");
     loadString(settings.logFile, toml, "logsettings.logfile");
     loadMap(settings.logLevels, toml, "loglevels");
     loadBool(settings.autoloadMetrics, toml, "metrics.autoload");
+    loadString(settings.overloadPolicy, toml, "playback.overloadpolicy");
+    loadString(settings.exportFormat, toml, "export.format");
+    loadString(settings.exportDirectory, toml, "export.directory");
     return settings;
 
   } catch (const toml::parse_error &err) {
@@ -119,14 +126,20 @@ vivictpp::Settings vivictpp::loadSettings(std::filesystem::path filePath) {
 toml::table settingsToToml(const vivictpp::Settings &settings) {
   toml::table tbl;
   toml::table decoding;
+  toml::table exportSettings;
   toml::table fontSettings;
   toml::table logSettings;
   toml::table logLevels;
   toml::table metricSettings;
+  toml::table playbackSettings;
   fontSettings.insert("basefontsize", settings.baseFontSize);
   fontSettings.insert("disableautoscaling", settings.disableFontAutoScaling);
   decoding.insert("enabledHwAccels", toTomlArray(settings.hwAccels));
   decoding.insert("preferredDecoders", toTomlArray(settings.preferredDecoders));
+  decoding.insert("fastprobe", settings.fastProbe);
+  decoding.insert("probesizekb", settings.probeSizeKb);
+  decoding.insert("analyzedurationms", settings.analyzeDurationMs);
+  decoding.insert("standbydecoders", settings.standbyDecoders);
 
   logSettings.insert("logbuffersize", settings.logBufferSize);
   logSettings.insert("logtofile", settings.logToFile);
@@ -135,11 +148,16 @@ toml::table settingsToToml(const vivictpp::Settings &settings) {
     logLevels.insert(e.first, e.second);
   }
   metricSettings.insert("autoload", settings.autoloadMetrics);
+  playbackSettings.insert("overloadpolicy", settings.overloadPolicy);
+  exportSettings.insert("format", settings.exportFormat);
+  exportSettings.insert("directory", settings.exportDirectory);
   tbl.insert("fontsettings", fontSettings);
   tbl.insert("decoding", decoding);
   tbl.insert("logsettings", logSettings);
   tbl.insert("loglevels", logLevels);
   tbl.insert("metrics", metricSettings);
+  tbl.insert("playback", playbackSettings);
+  tbl.insert("export", exportSettings);
   return tbl;
 }
 
@@ -156,7 +174,14 @@ bool vivictpp::operator==(const vivictpp::Settings &lhs,
          lhs.disableFontAutoScaling == rhs.disableFontAutoScaling &&
          lhs.hwAccels == rhs.hwAccels &&
          lhs.preferredDecoders == rhs.preferredDecoders &&
+         lhs.fastProbe == rhs.fastProbe &&
+         lhs.probeSizeKb == rhs.probeSizeKb &&
+         lhs.analyzeDurationMs == rhs.analyzeDurationMs &&
+         lhs.standbyDecoders == rhs.standbyDecoders &&
          lhs.logBufferSize == rhs.logBufferSize &&
          lhs.logToFile == rhs.logToFile && lhs.logFile == rhs.logFile &&
-         lhs.logLevels == rhs.logLevels;
+         lhs.logLevels == rhs.logLevels &&
+         lhs.overloadPolicy == rhs.overloadPolicy &&
+         lhs.exportFormat == rhs.exportFormat &&
+         lhs.exportDirectory == rhs.exportDirectory;
 }
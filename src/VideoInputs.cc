@@ -7,6 +7,12 @@
 #include "libav/DecoderMetadata.hh"
 #include "spdlog/spdlog.h"
 #include "time/Time.hh"
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -35,7 +41,8 @@ void SeekState::handleSeekFinished(int seekId, vivictpp::time::Time seekPos,
     this->error = true;
   }
   remainingSeeks--;
-  logger->debug("handleSeekFinished: remainingSeeks={}", remainingSeeks);
+  VPP_LOG_DEBUG(logger, "handleSeekFinished: remainingSeeks={}",
+                remainingSeeks);
   if (remainingSeeks == 0) {
     vivictpp::time::Time minPos =
         *std::min_element(seekEndPos.begin(), seekEndPos.end());
@@ -43,78 +50,287 @@ void SeekState::handleSeekFinished(int seekId, vivictpp::time::Time seekPos,
   }
 }
 
-VideoInputs::VideoInputs()
-    : _leftFrameOffset(0), leftPtsOffset(0),
-      logger(vivictpp::logging::getOrCreateLogger("VideoInputs")) {}
+namespace {
+
+// Above this many inputs the cores are split evenly between the decoders,
+// since libavcodec sizes its thread pool for the whole machine per decoder
+const size_t MAX_INPUTS_WITH_AUTO_THREADS = 2;
+
+// An input that has decoded no frame this long after it was connected, for
+// instance because the decoder fails on every packet, fails to open
+const std::chrono::seconds PREROLL_TIMEOUT(10);
+
+// A decoder that is skipping frames goes back to decoding all frames once it
+// is this far ahead of the playback clock
+const vivictpp::time::Time CATCH_UP_MARGIN = vivictpp::time::millis(500);
+
+int threadsPerInput(size_t nInputs) {
+  if (nInputs <= MAX_INPUTS_WITH_AUTO_THREADS) {
+    return 0;
+  }
+  int cores = (int)std::thread::hardware_concurrency();
+  return std::max(1, cores / (int)nInputs);
+}
+
+} // namespace
+
+VideoInputs::VideoInputs(bool enableAudio)
+    : enableAudio(enableAudio), _leftFrameOffset(0), leftPtsOffset(0),
+      decodeScheduler((int)std::thread::hardware_concurrency()),
+      logger(vivictpp::logging::getOrCreateLogger("VideoInputs")) {
+  inputs.push_back(std::make_unique<MediaPipe>());
+  inputs.push_back(std::make_unique<MediaPipe>());
+}
+
+void VideoInputs::startOpenInputs(
+    const std::vector<SourceConfig> &sourceConfigs) {
+  decoderThreads = threadsPerInput(sourceConfigs.size());
+  VPP_LOG_DEBUG(logger, "startOpenInputs: nInputs={} decoderThreads={}",
+                sourceConfigs.size(), decoderThreads);
+  pendingOpens.clear();
+  for (size_t i = 0; i < sourceConfigs.size(); i++) {
+    prepareInput(i, sourceConfigs[i]);
+    auto pending = std::make_unique<PendingOpen>();
+    pending->sourceConfig = sourceConfigs[i];
+    PendingOpen *p = pending.get();
+    p->result = std::async(std::launch::async, [this, p, i]() {
+      vivictpp::tracing::setThreadName("vivictpp::VideoInputs::open");
+      return createInput(p->sourceConfig, i == 0, p->stage);
+    });
+    pendingOpens.push_back(std::move(pending));
+  }
+}
+
+bool VideoInputs::finishOpenInputs() {
+  bool done = true;
+  for (size_t i = 0; i < pendingOpens.size(); i++) {
+    PendingOpen &pending = *pendingOpens[i];
+    if (!pending.attached) {
+      if (pending.result.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+        done = false;
+        continue;
+      }
+      // Inputs start decoding as soon as they are attached, while slower
+      // inputs are still being probed
+      attachInput(i, pending.sourceConfig, pending.result.get());
+      pending.attached = true;
+      pending.attachedAt = std::chrono::steady_clock::now();
+    }
+    if (inputs[i]->decoder->frames().isEmpty()) {
+      if (std::chrono::steady_clock::now() - pending.attachedAt >
+          PREROLL_TIMEOUT) {
+        throw std::runtime_error("No frames could be decoded from " +
+                                 pending.sourceConfig.path);
+      }
+      done = false;
+    } else {
+      pending.stage = OpenStage::READY;
+    }
+  }
+  if (done) {
+    VPP_LOG_DEBUG(logger, "finishOpenInputs: all inputs ready");
+    pendingOpens.clear();
+    for (const auto &input : inputs) {
+      if (input->decoder) {
+        openStandbyDecoders(*input);
+      }
+    }
+  }
+  return done;
+}
+
+std::vector<OpenProgress> VideoInputs::openProgress() {
+  std::vector<OpenProgress> progress;
+  for (const auto &pending : pendingOpens) {
+    progress.push_back({pending->sourceConfig.path, pending->stage.load()});
+  }
+  return progress;
+}
 
 void VideoInputs::openLeft(const SourceConfig &sourceConfig) {
-  // TODO: Need to add audio packet worker for audio support
-  packetWorkers.clear();
-  leftInput.packetWorker.reset();
-  leftInput.decoder.reset();
+  openInput(0, sourceConfig);
+}
+
+void VideoInputs::openRight(const SourceConfig &sourceConfig) {
+  openInput(1, sourceConfig);
+}
+
+size_t VideoInputs::inputCount() {
+  size_t count = 0;
+  for (const auto &input : inputs) {
+    if (input->packetWorker) {
+      count++;
+    }
+  }
+  return count;
+}
 
-  leftInput.videoIndexer.prepareIndex(sourceConfig.path,
-                                      sourceConfig.formatOptions);
+void VideoInputs::openInput(size_t index, const SourceConfig &sourceConfig) {
+  prepareInput(index, sourceConfig);
+  std::atomic<OpenStage> stage{OpenStage::PROBING};
+  attachInput(index, sourceConfig,
+              createInput(sourceConfig, index == 0, stage));
+}
+
+void VideoInputs::prepareInput(size_t index,
+                               const SourceConfig &sourceConfig) {
+  while (inputs.size() <= index) {
+    inputs.push_back(std::make_unique<MediaPipe>());
+  }
+  MediaPipe &input = *inputs[index];
+  bool isLeft = index == 0;
+  timelineValid = false;
+  if (isLeft) {
+    // Audio is only played from the left input
+    audio1.packetWorker.reset();
+    audio1.decoder.reset();
+  }
+  closeStandbyDecoders(input);
+  input.packetWorker.reset();
+  input.decoder.reset();
+  input.scrubCache.reset();
+  input.framesStepped = 0;
+  input.catchingUp = false;
+  cachedFrames.clear();
+  updatePacketWorkers();
+  // Thumbnails are only shown for the left input
+  input.videoIndexer.prepareIndex(sourceConfig.path,
+                                  sourceConfig.formatOptions, isLeft);
+}
 
-  auto packetWorker = std::shared_ptr<vivictpp::workers::PacketWorker>(
-      new vivictpp::workers::PacketWorker(sourceConfig.path,
-                                          sourceConfig.formatOptions));
-  packetWorkers.push_back(packetWorker);
-  if (packetWorker->getVideoStreams().empty()) {
+VideoInputs::OpenedInput
+VideoInputs::createInput(const SourceConfig &sourceConfig, bool withAudio,
+                         std::atomic<OpenStage> &stage) {
+  OpenedInput opened;
+  stage = OpenStage::PROBING;
+  opened.packetWorker = std::make_shared<vivictpp::workers::PacketWorker>(
+      sourceConfig.path, sourceConfig.formatOptions);
+  if (opened.packetWorker->getVideoStreams().empty()) {
     throw std::runtime_error("No video stream in source" + sourceConfig.path);
   }
-  leftInput.packetWorker = packetWorker;
-  leftInput.decoder.reset(new vivictpp::workers::DecoderWorker(
-      packetWorker->getVideoStreams()[0], sourceConfig.filter,
-      {sourceConfig.hwAccels, sourceConfig.preferredDecoders}));
-  packetWorker->addDecoderWorker(leftInput.decoder);
-  leftInput.decoder->start();
-  if (rightInput.packetWorker) {
-    packetWorkers.push_back(rightInput.packetWorker);
+  stage = OpenStage::OPENING_DECODER;
+  vivictpp::libav::DecoderOptions decoderOptions = {
+      sourceConfig.hwAccels, sourceConfig.preferredDecoders, decoderThreads};
+  opened.decoder = std::make_shared<vivictpp::workers::DecoderWorker>(
+      opened.packetWorker->getVideoStreams()[0], sourceConfig.filter,
+      decoderOptions);
+  if (withAudio && enableAudio &&
+      !opened.packetWorker->getAudioStreams().empty()) {
+    opened.audioDecoder = std::make_shared<vivictpp::workers::DecoderWorker>(
+        opened.packetWorker->getAudioStreams()[0]);
   }
-  packetWorker->start();
-};
+  stage = OpenStage::PREROLLING;
+  return opened;
+}
 
-void VideoInputs::openRight(const SourceConfig &sourceConfig) {
-  // TODO: Need to add audio packet worker for audio support
+void VideoInputs::attachInput(size_t index, const SourceConfig &sourceConfig,
+                              OpenedInput opened) {
+  MediaPipe &input = *inputs[index];
+  VPP_LOG_DEBUG(logger, "attachInput: index={} source={}", index,
+                sourceConfig.path);
+  input.packetWorker = opened.packetWorker;
+  input.filtered = !sourceConfig.filter.empty();
+  input.source = sourceConfig.path;
+  input.filter = sourceConfig.filter;
+  input.decoderOptions = {sourceConfig.hwAccels,
+                          sourceConfig.preferredDecoders, decoderThreads};
+  input.decoder = opened.decoder;
+  input.packetWorker->addDecoderWorker(input.decoder);
+  input.decoder->start();
+  if (opened.audioDecoder) {
+    // Demuxed by the same packet worker, so audio follows video seeks
+    audio1.packetWorker = input.packetWorker;
+    audio1.decoder = opened.audioDecoder;
+    input.packetWorker->addDecoderWorker(audio1.decoder);
+    audio1.decoder->start();
+  }
+  input.scrubCache = std::make_unique<vivictpp::video::ScrubCache>(
+      sourceConfig.path, sourceConfig.formatOptions, sourceConfig.filter,
+      input.videoIndexer.getIndex());
+  updatePacketWorkers();
+  input.packetWorker->start();
+  // Inputs opened together get their standby decoders once all of them are
+  // decoding, see finishOpenInputs
+  if (pendingOpens.empty()) {
+    openStandbyDecoders(input);
+  }
+}
+
+void VideoInputs::openStandbyDecoders(MediaPipe &input) {
+  std::vector<AVStream *> streams;
+  for (AVStream *stream : input.packetWorker->getVideoStreams()) {
+    if (stream->index != input.decoder->streamIndex &&
+        streams.size() < maxStandbyDecoders) {
+      streams.push_back(stream);
+    }
+  }
+  if (streams.empty() || input.openingStandby.valid() ||
+      !input.standbyDecoders.empty()) {
+    return;
+  }
+  std::string filter = input.filter;
+  // The thread count of the input, so that a selected decoder is used as it
+  // is instead of being opened again
+  vivictpp::libav::DecoderOptions decoderOptions = input.decoderOptions;
+  vivictpp::logging::Logger logger = this->logger;
+  input.openingStandby = std::async(
+      std::launch::async, [streams, filter, decoderOptions, logger]() {
+        vivictpp::tracing::setThreadName("vivictpp::VideoInputs::standby");
+        std::map<int, std::shared_ptr<vivictpp::workers::DecoderWorker>>
+            decoders;
+        for (AVStream *stream : streams) {
+          try {
+            decoders[stream->index] =
+                std::make_shared<vivictpp::workers::DecoderWorker>(
+                    stream, filter, decoderOptions);
+          } catch (const std::exception &e) {
+            // Opened again when the stream is selected
+            logger->warn("Failed to open standby decoder for stream {}: {}",
+                         stream->index, e.what());
+          }
+        }
+        return decoders;
+      });
+}
+
+void VideoInputs::closeStandbyDecoders(MediaPipe &input) {
+  if (input.openingStandby.valid()) {
+    input.openingStandby.wait();
+    input.openingStandby = {};
+  }
+  input.standbyDecoders.clear();
+}
+
+void VideoInputs::updatePacketWorkers() {
   packetWorkers.clear();
-  packetWorkers.push_back(leftInput.packetWorker);
-  rightInput.packetWorker.reset();
-  rightInput.decoder.reset();
-  rightInput.videoIndexer.prepareIndex(sourceConfig.path,
-                                       sourceConfig.formatOptions, false);
-  auto packetWorker = std::shared_ptr<vivictpp::workers::PacketWorker>(
-      new vivictpp::workers::PacketWorker(sourceConfig.path,
-                                          sourceConfig.formatOptions));
-  packetWorkers.push_back(packetWorker);
-  if (packetWorker->getVideoStreams().empty()) {
-    throw std::runtime_error("No video stream in source" + sourceConfig.path);
+  for (const auto &input : inputs) {
+    if (input->packetWorker) {
+      packetWorkers.push_back(input->packetWorker);
+    }
   }
-  rightInput.packetWorker = packetWorker;
-  rightInput.decoder.reset(new vivictpp::workers::DecoderWorker(
-      packetWorker->getVideoStreams()[0], sourceConfig.filter,
-      {sourceConfig.hwAccels, sourceConfig.preferredDecoders}));
-  packetWorker->addDecoderWorker(rightInput.decoder);
-  rightInput.decoder->start();
-  packetWorker->start();
-};
+}
 
 bool VideoInputs::ptsInRange(vivictpp::time::Time pts) {
-  return !vivictpp::time::isNoPts(pts) &&
-         leftInput.decoder->frames().ptsInRange(pts + leftPtsOffset) &&
-         (!rightInput.decoder || rightInput.decoder->frames().ptsInRange(pts));
+  if (vivictpp::time::isNoPts(pts)) {
+    return false;
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i]->decoder &&
+        !inputs[i]->decoder->frames().ptsInRange(pts + ptsOffset(i))) {
+      return false;
+    }
+  }
+  return true;
 }
 
 vivictpp::time::Time VideoInputs::duration() {
   vivictpp::time::Time duration = vivictpp::time::NO_TIME;
-  for (const auto &metadata : leftInput.packetWorker->getVideoMetadata()) {
-    if (metadata.duration != vivictpp::time::NO_TIME &&
-        (duration == vivictpp::time::NO_TIME || metadata.duration < duration)) {
-      duration = metadata.duration;
+  for (const auto &input : inputs) {
+    if (!input->packetWorker) {
+      continue;
     }
-  }
-  if (rightInput.packetWorker) {
-    for (const auto &metadata : rightInput.packetWorker->getVideoMetadata()) {
+    for (const auto &metadata : input->packetWorker->getVideoMetadata()) {
       if (metadata.duration != vivictpp::time::NO_TIME &&
           (duration == vivictpp::time::NO_TIME ||
            metadata.duration < duration)) {
@@ -126,76 +342,386 @@ vivictpp::time::Time VideoInputs::duration() {
 }
 
 vivictpp::time::Time VideoInputs::startTime() {
-  return leftInput.packetWorker->getVideoMetadata()[0].startTime -
+  return leftInput().packetWorker->getVideoMetadata()[0].startTime -
          leftPtsOffset;
 }
 
-void VideoInputs::step(vivictpp::time::Time pts) {
-  leftInput.decoder->frames().step(pts + leftPtsOffset);
-  if (rightInput.decoder) {
-    rightInput.decoder->frames().step(pts);
+vivictpp::time::Time VideoInputs::frameDuration() {
+  if (!hasLeftSource()) {
+    return vivictpp::time::NO_TIME;
+  }
+  vivictpp::time::Time frameDuration = vivictpp::time::NO_TIME;
+  for (const auto &input : inputs) {
+    if (!input->packetWorker) {
+      continue;
+    }
+    vivictpp::time::Time d =
+        input->packetWorker->getVideoMetadata()[0].frameDuration;
+    if (frameDuration == vivictpp::time::NO_TIME || d < frameDuration) {
+      frameDuration = d;
+    }
+  }
+  return frameDuration;
+}
+
+bool VideoInputs::hasMaxPts() {
+  for (const auto &input : inputs) {
+    if (input->packetWorker &&
+        input->packetWorker->getVideoMetadata()[0].hasDuration()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+vivictpp::time::Time VideoInputs::minPts() {
+  vivictpp::time::Time minPts = vivictpp::time::NO_TIME;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->packetWorker) {
+      continue;
+    }
+    vivictpp::time::Time start =
+        inputs[i]->packetWorker->getVideoMetadata()[0].startTime -
+        ptsOffset(i);
+    if (minPts == vivictpp::time::NO_TIME || start > minPts) {
+      minPts = start;
+    }
+  }
+  return minPts;
+}
+
+vivictpp::time::Time VideoInputs::maxPts() {
+  if (!leftInput().packetWorker->getVideoMetadata()[0].hasDuration()) {
+    return vivictpp::time::NO_TIME;
+  }
+  vivictpp::time::Time maxPts = vivictpp::time::NO_TIME;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->packetWorker) {
+      continue;
+    }
+    vivictpp::time::Time end =
+        inputs[i]->packetWorker->getVideoMetadata()[0].endTime - ptsOffset(i);
+    if (maxPts == vivictpp::time::NO_TIME || end < maxPts) {
+      maxPts = end;
+    }
+  }
+  return maxPts;
+}
+
+vivictpp::time::Time VideoInputs::nextPts() {
+  vivictpp::time::Time nextPts = vivictpp::time::NO_TIME;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    vivictpp::time::Time pts =
+        inputs[i]->decoder->frames().nextPts() - ptsOffset(i);
+    if (vivictpp::time::isNoPts(pts)) {
+      return pts;
+    }
+    if (nextPts == vivictpp::time::NO_TIME || pts < nextPts) {
+      nextPts = pts;
+    }
+  }
+  return nextPts;
+}
+
+vivictpp::time::Time VideoInputs::previousPts() {
+  vivictpp::time::Time previousPts = vivictpp::time::NO_TIME;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    vivictpp::time::Time pts =
+        inputs[i]->decoder->frames().previousPts() - ptsOffset(i);
+    if (vivictpp::time::isNoPts(pts)) {
+      return pts;
+    }
+    if (previousPts == vivictpp::time::NO_TIME || pts > previousPts) {
+      previousPts = pts;
+    }
+  }
+  return previousPts;
+}
+
+bool VideoInputs::updateTimeline() {
+  if (timelineValid && timelineLeftPtsOffset == leftPtsOffset) {
+    return true;
+  }
+  std::vector<std::vector<vivictpp::time::Time>> ptsValues;
+  std::vector<vivictpp::time::Time> offsets;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    std::shared_ptr<vivictpp::video::VideoIndex> index =
+        inputs[i]->videoIndexer.getIndex();
+    // The index holds the pts of the unfiltered stream
+    if (inputs[i]->filtered || !index->ready()) {
+      return false;
+    }
+    ptsValues.push_back(index->getPtsValues());
+    offsets.push_back(ptsOffset(i));
+  }
+  if (ptsValues.empty()) {
+    return false;
+  }
+  timeline = vivictpp::video::MergedTimeline(ptsValues, offsets,
+                                             frameDuration() / 4);
+  timelineValid = true;
+  timelineLeftPtsOffset = leftPtsOffset;
+  VPP_LOG_DEBUG(logger, "updateTimeline: {} steps", timeline.size());
+  return true;
+}
+
+vivictpp::time::Time VideoInputs::nextStepPts(vivictpp::time::Time pts) {
+  if (!updateTimeline()) {
+    // The buffers are somewhere else while cached frames are shown
+    return cachedFrames.empty() ? nextPts() : vivictpp::time::NO_TIME;
+  }
+  return timeline.nextPts(pts);
+}
+
+vivictpp::time::Time VideoInputs::previousStepPts(vivictpp::time::Time pts) {
+  if (!updateTimeline()) {
+    return cachedFrames.empty() ? previousPts() : vivictpp::time::NO_TIME;
+  }
+  return timeline.previousPts(pts);
+}
+
+int VideoInputs::step(vivictpp::time::Time pts) {
+  cachedFrames.clear();
+  // Frames of a step may have pts on either side of other inputs' frames, so
+  // at a step each input is moved to the frame the timeline maps it to
+  bool atStep = timelineValid && timelineLeftPtsOffset == leftPtsOffset &&
+                !timeline.empty();
+  if (atStep) {
+    timelineStep = timeline.stepAt(pts, timelineStep);
+    atStep = timeline.stepPts(timelineStep) == pts;
+  }
+  int stepped = 0;
+  size_t timelineInput = 0;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = inputs[i]->decoder->frames();
+    vivictpp::time::Time inputPts = pts + ptsOffset(i);
+    if (atStep && timelineInput < timeline.inputs()) {
+      vivictpp::time::Time framePts =
+          timeline.framePts(timelineStep, timelineInput);
+      if (!vivictpp::time::isNoPts(framePts)) {
+        inputPts = framePts;
+      }
+    }
+    timelineInput++;
+    if (inputPts > frames.currentPts()) {
+      int n = frames.stepForward(inputPts);
+      inputs[i]->framesStepped += n;
+      stepped += n;
+    } else {
+      frames.stepBackward(inputPts);
+    }
+  }
+  return stepped;
+}
+
+void VideoInputs::framesPresented(bool countDrops) {
+  for (const auto &input : inputs) {
+    if (!input->decoder) {
+      continue;
+    }
+    if (countDrops && input->framesStepped > 1) {
+      input->decoder->stats().framesDropped.fetch_add(
+          input->framesStepped - 1, std::memory_order_relaxed);
+    }
+    input->framesStepped = 0;
+  }
+}
+
+void VideoInputs::updateCatchUp(vivictpp::time::Time clockPts) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    MediaPipe &input = *inputs[i];
+    if (!input.decoder) {
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = input.decoder->frames();
+    vivictpp::time::Time decodedPts =
+        frames.isEmpty() ? vivictpp::time::NO_TIME
+                         : frames.maxPts() - ptsOffset(i);
+    bool behind =
+        vivictpp::time::isNoPts(decodedPts) || decodedPts < clockPts;
+    if (behind && !input.catchingUp) {
+      VPP_LOG_DEBUG(logger,
+                    "updateCatchUp: input {} behind, decodedPts={} clockPts={}",
+                    i, decodedPts, clockPts);
+      input.catchingUp = true;
+      input.decoder->setSkipNonRef(true);
+      input.decoder->stats().catchUps.fetch_add(1, std::memory_order_relaxed);
+    } else if (input.catchingUp && !behind &&
+               decodedPts > clockPts + CATCH_UP_MARGIN) {
+      VPP_LOG_DEBUG(logger, "updateCatchUp: input {} caught up", i);
+      input.catchingUp = false;
+      input.decoder->setSkipNonRef(false);
+    }
+  }
+}
+
+bool VideoInputs::stopCatchUp() {
+  bool wasCatchingUp = false;
+  for (const auto &input : inputs) {
+    if (input->catchingUp) {
+      wasCatchingUp = true;
+      input->catchingUp = false;
+      input->decoder->setSkipNonRef(false);
+    }
   }
+  return wasCatchingUp;
 }
 
 void VideoInputs::stepForward(vivictpp::time::Time pts) {
-  leftInput.decoder->frames().stepForward(pts + leftPtsOffset);
-  if (rightInput.decoder) {
-    rightInput.decoder->frames().stepForward(pts);
-    logger->debug("stepForward Left pts={}, Right pts={}",
-                  leftInput.decoder->frames().currentPts() - leftPtsOffset,
-                  rightInput.decoder->frames().currentPts());
-  } else {
-    logger->debug("stepForward Left pts={}",
-                  leftInput.decoder->frames().currentPts() - leftPtsOffset);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i]->decoder) {
+      inputs[i]->decoder->frames().stepForward(pts + ptsOffset(i));
+      VPP_LOG_DEBUG(logger, "stepForward input {} pts={}", i,
+                    inputs[i]->decoder->frames().currentPts() - ptsOffset(i));
+    }
   }
 }
 
 void VideoInputs::stepBackward(vivictpp::time::Time pts) {
-  leftInput.decoder->frames().stepBackward(pts + leftPtsOffset);
-  if (rightInput.decoder) {
-    rightInput.decoder->frames().stepBackward(pts);
-    logger->debug("stepBackward Left pts={}, Right pts={}",
-                  leftInput.decoder->frames().currentPts() - leftPtsOffset,
-                  rightInput.decoder->frames().currentPts());
-  } else {
-    logger->debug("stepBackward Left pts={}",
-                  leftInput.decoder->frames().currentPts() - leftPtsOffset);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i]->decoder) {
+      inputs[i]->decoder->frames().stepBackward(pts + ptsOffset(i));
+      VPP_LOG_DEBUG(logger, "stepBackward input {} pts={}", i,
+                    inputs[i]->decoder->frames().currentPts() - ptsOffset(i));
+    }
   }
 }
 
 void VideoInputs::dropIfFullAndNextOutOfRange(vivictpp::time::Time currentPts,
                                               int framesToDrop) {
-  if (currentPts == vivictpp::time::NO_TIME ||
-      currentPts >= leftInput.decoder->frames().maxPts() - leftPtsOffset) {
-    leftInput.decoder->frames().dropIfFull(framesToDrop);
-  }
-  if (rightInput.decoder &&
-      (currentPts == vivictpp::time::NO_TIME ||
-       currentPts >= rightInput.decoder->frames().maxPts())) {
-    rightInput.decoder->frames().dropIfFull(framesToDrop);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = inputs[i]->decoder->frames();
+    if (currentPts == vivictpp::time::NO_TIME ||
+        currentPts >= frames.maxPts() - ptsOffset(i)) {
+      frames.dropIfFull(framesToDrop);
+    }
   }
 }
 
 void VideoInputs::dropIfFullAndOutOfRange(vivictpp::time::Time nextPts,
                                           int framesToDrop) {
-  if (vivictpp::time::isNoPts(nextPts) ||
-      nextPts > leftInput.decoder->frames().maxPts() - leftPtsOffset) {
-    leftInput.decoder->frames().dropIfFull(framesToDrop);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = inputs[i]->decoder->frames();
+    if (vivictpp::time::isNoPts(nextPts) ||
+        nextPts > frames.maxPts() - ptsOffset(i)) {
+      frames.dropIfFull(framesToDrop);
+    }
   }
-  if (rightInput.decoder && (vivictpp::time::isNoPts(nextPts) ||
-                             nextPts > rightInput.decoder->frames().maxPts())) {
-    rightInput.decoder->frames().dropIfFull(framesToDrop);
+}
+
+std::vector<vivictpp::libav::Frame> VideoInputs::firstFrames() {
+  if (!cachedFrames.empty()) {
+    std::vector<vivictpp::libav::Frame> result;
+    for (const auto &frame : cachedFrames) {
+      result.push_back(frame.share());
+    }
+    return result;
+  }
+  std::vector<vivictpp::libav::Frame> result;
+  result.reserve(inputs.size());
+  for (const auto &input : inputs) {
+    if (!input->decoder) {
+      result.push_back(vivictpp::libav::Frame::emptyFrame());
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = input->decoder->frames();
+    result.push_back(frames.first());
+    if (!frames.isEmpty()) {
+      frameCache.put(frameCacheKey(*input), frames.currentPts(),
+                     frames.nextPts(), result.back());
+    }
+  }
+  return result;
+}
+
+std::vector<std::pair<vivictpp::time::Time, vivictpp::libav::Frame>>
+VideoInputs::bufferedFrames(size_t input, vivictpp::time::Time from) {
+  if (input >= inputs.size() || !inputs[input]->decoder) {
+    return {};
+  }
+  auto frames = inputs[input]->decoder->frames().framesInRange(
+      vivictpp::time::isNoPts(from) ? from : from + ptsOffset(input),
+      std::numeric_limits<vivictpp::time::Time>::max());
+  for (auto &frame : frames) {
+    frame.first -= ptsOffset(input);
+  }
+  return frames;
+}
+
+bool VideoInputs::showCachedFrames(vivictpp::time::Time pts) {
+  if (vivictpp::time::isNoPts(pts)) {
+    return false;
   }
+  std::vector<vivictpp::libav::Frame> frames;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i]->decoder) {
+      frames.push_back(vivictpp::libav::Frame::emptyFrame());
+      continue;
+    }
+    frames.push_back(
+        frameCache.get(frameCacheKey(*inputs[i]), pts + ptsOffset(i)));
+    if (frames.back().empty()) {
+      return false;
+    }
+  }
+  VPP_LOG_DEBUG(logger, "showCachedFrames: pts={}", pts);
+  cachedFrames = std::move(frames);
+  return true;
 }
 
-std::array<vivictpp::libav::Frame, 2> VideoInputs::firstFrames() {
-  std::array<vivictpp::libav::Frame, 2> result = {
-      leftInput.decoder->frames().first(),
-      rightInput.decoder ? rightInput.decoder->frames().first()
-                         : vivictpp::libav::Frame::emptyFrame()};
+std::string VideoInputs::frameCacheKey(const MediaPipe &input) {
+  // Frames differ between streams and filters of the same source
+  return fmt::format("{}|{}|{}", input.source, input.decoder->streamIndex,
+                     input.filter);
+}
+
+std::vector<vivictpp::libav::Frame>
+VideoInputs::scrubFrames(vivictpp::time::Time pts) {
+  setScrubCenter(pts);
+  std::vector<vivictpp::libav::Frame> result;
+  result.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    result.push_back(inputs[i]->scrubCache
+                         ? inputs[i]->scrubCache->nearest(pts + ptsOffset(i))
+                         : vivictpp::libav::Frame::emptyFrame());
+  }
   return result;
 }
 
+void VideoInputs::setScrubCenter(vivictpp::time::Time pts) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i]->scrubCache) {
+      inputs[i]->scrubCache->setCenter(pts + ptsOffset(i));
+    }
+  }
+}
+
+void VideoInputs::setScrubbing(bool scrubbing) {
+  for (auto &input : inputs) {
+    if (input->scrubCache) {
+      input->scrubCache->setActive(scrubbing);
+    }
+  }
+}
+
 void VideoInputs::seek(vivictpp::time::Time pts,
                        vivictpp::SeekCallback onSeekFinished,
                        vivictpp::time::Time streamSeekOffset) {
@@ -203,10 +729,15 @@ void VideoInputs::seek(vivictpp::time::Time pts,
   for (auto packetWorker : packetWorkers) {
     nDecoders += packetWorker->nDecoders();
   }
-  logger->debug("seek: nDecoders={}", nDecoders);
+  VPP_LOG_DEBUG(logger, "seek: nDecoders={}", nDecoders);
+  cachedFrames.clear();
+  decodeScheduler.reset();
+  stopCatchUp();
+  // All inputs report to the same seek state, the seek finishes when the
+  // slowest decoder is done
   int seekId = seekState.reset(nDecoders, onSeekFinished);
   for (auto packetWorker : packetWorkers) {
-    if (packetWorker == leftInput.packetWorker) {
+    if (packetWorker == leftInput().packetWorker) {
       vivictpp::SeekCallback seekCallback =
           [this, seekId](vivictpp::time::Time seekEndPos, bool error) {
             this->seekState.handleSeekFinished(
@@ -223,41 +754,126 @@ void VideoInputs::seek(vivictpp::time::Time pts,
   }
 }
 
-std::array<std::vector<VideoMetadata>, 2> VideoInputs::metadata() {
-  std::array<std::vector<VideoMetadata>, 2> result = {
-      leftInput.packetWorker->getVideoMetadata(),
-      rightInput.packetWorker ? rightInput.packetWorker->getVideoMetadata()
-                              : std::vector<VideoMetadata>()};
+bool VideoInputs::rebalanceDecoders(int64_t now) {
+  if (!decodeScheduler.sampleDue(now)) {
+    return false;
+  }
+  std::vector<vivictpp::workers::DecoderLoad> loads;
+  std::vector<MediaPipe *> decoding;
+  for (const auto &input : inputs) {
+    if (!input->decoder) {
+      continue;
+    }
+    vivictpp::workers::FrameBuffer &frames = input->decoder->frames();
+    const vivictpp::workers::PipelineStats &stats = input->decoder->stats();
+    vivictpp::time::Time frameDuration =
+        input->packetWorker->getVideoMetadata()[0].frameDuration;
+    int bufferedFrames = 0;
+    if (!frames.isEmpty() && frameDuration > 0) {
+      bufferedFrames =
+          (int)((frames.maxPts() - frames.currentPts()) / frameDuration);
+    }
+    loads.push_back({stats.framesDecoded.load(std::memory_order_relaxed),
+                     stats.decodeMicros.load(std::memory_order_relaxed),
+                     bufferedFrames,
+                     std::max(1, stats.decoderThreads.load(
+                                     std::memory_order_relaxed)),
+                     frameDuration});
+    decoding.push_back(input.get());
+  }
+  std::vector<int> threads = decodeScheduler.update(now, loads);
+  if (threads.empty()) {
+    return false;
+  }
+  for (size_t i = 0; i < decoding.size(); i++) {
+    VPP_LOG_DEBUG(logger, "rebalanceDecoders: input {} threads {} -> {}", i,
+                  loads[i].threads, threads[i]);
+    decoding[i]->decoder->setThreads(threads[i]);
+    // Used for the decoder of a newly selected stream
+    decoding[i]->decoderOptions.threads = threads[i];
+  }
+  return true;
+}
+
+void VideoInputs::setStandbyDecoders(int count) {
+  maxStandbyDecoders = (size_t)std::max(0, count);
+}
+
+std::vector<std::vector<VideoMetadata>> VideoInputs::metadata() {
+  std::vector<std::vector<VideoMetadata>> result;
+  result.reserve(inputs.size());
+  for (const auto &input : inputs) {
+    result.push_back(input->packetWorker
+                         ? input->packetWorker->getVideoMetadata()
+                         : std::vector<VideoMetadata>());
+  }
   return result;
 }
 
 std::array<vivictpp::libav::DecoderMetadata, 2> VideoInputs::decoderMetadata() {
   std::array<vivictpp::libav::DecoderMetadata, 2> result = {
-      leftInput.decoder->getDecoderMetadata(),
-      rightInput.decoder ? rightInput.decoder->getDecoderMetadata()
-                         : vivictpp::libav::DecoderMetadata()};
+      leftInput().decoder->getDecoderMetadata(),
+      rightInput().decoder ? rightInput().decoder->getDecoderMetadata()
+                           : vivictpp::libav::DecoderMetadata()};
   return result;
 }
 
 void VideoInputs::selectVideoStreamLeft(int streamIndex) {
-  selectStream(leftInput, streamIndex);
+  selectStream(leftInput(), streamIndex);
 }
 
 void VideoInputs::selectVideoStreamRight(int streamIndex) {
-  selectStream(rightInput, streamIndex);
+  selectStream(rightInput(), streamIndex);
 }
 
 void VideoInputs::selectStream(MediaPipe &input, int streamIndex) {
+  if (!input.decoder || streamIndex < 0 ||
+      streamIndex >= (int)input.packetWorker->getVideoStreams().size()) {
+    return;
+  }
+  AVStream *stream = input.packetWorker->getVideoStreams()[streamIndex];
+  if (stream->index == input.decoder->streamIndex) {
+    return;
+  }
+  // Standby decoders still being opened are not waited for, the stream gets
+  // a decoder of its own instead
+  if (input.openingStandby.valid() &&
+      input.openingStandby.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+    input.standbyDecoders.merge(input.openingStandby.get());
+  }
+  std::shared_ptr<vivictpp::workers::DecoderWorker> decoder;
+  auto it = input.standbyDecoders.find(stream->index);
+  bool fromStandby = it != input.standbyDecoders.end();
+  if (fromStandby) {
+    decoder = it->second;
+    input.standbyDecoders.erase(it);
+    // Only reopened by the seek below if the thread split has changed since
+    // the decoder was opened
+    if (input.decoderOptions.threads > 0) {
+      decoder->setThreads(input.decoderOptions.threads);
+    }
+  } else {
+    decoder = std::make_shared<vivictpp::workers::DecoderWorker>(
+        stream, input.filter, input.decoderOptions);
+  }
+  VPP_LOG_DEBUG(logger, "selectStream: stream {} -> {}, standby={}",
+                input.decoder->streamIndex, stream->index, fromStandby);
   vivictpp::time::Time currentPts = input.decoder->frames().currentPts();
   input.packetWorker->stop();
   input.packetWorker->removeDecoderWorker(input.decoder);
-  input.decoder.reset(new vivictpp::workers::DecoderWorker(
-      input.packetWorker->getVideoStreams()[streamIndex]));
+  input.decoder->standBy();
+  input.standbyDecoders[input.decoder->streamIndex] = input.decoder;
+  input.catchingUp = false;
+  input.framesStepped = 0;
+  cachedFrames.clear();
+  input.decoder = decoder;
   input.packetWorker->addDecoderWorker(input.decoder);
+  // Started before the seek is sent, so that the seek is not overridden
+  input.decoder->start();
   input.packetWorker->seek(currentPts, [](vivictpp::time::Time _, bool b) {
     (void)_;
     (void)b;
   });
   input.packetWorker->start();
-  input.decoder->start();
 }
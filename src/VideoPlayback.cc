@@ -4,6 +4,38 @@
 
 #include "VideoPlayback.hh"
 #include "time/Time.hh"
+#include "video/FrameExporter.hh"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Amount of audio to keep queued in the audio output
+const vivictpp::time::Time AUDIO_QUEUE_TARGET = vivictpp::time::millis(200);
+// Larger differences between the audio position and the playback clock are
+// corrected immediately instead of gradually
+const vivictpp::time::Time AUDIO_MAX_DRIFT = vivictpp::time::millis(200);
+const int AUDIO_DRIFT_SMOOTHING = 16;
+// Number of frame durations the clock may run ahead of the shown frames
+// before late frames are dropped
+const int MAX_LATE_FRAMES = 2;
+// An export stops if no new frames are decoded for this long, which happens
+// when an input ends before the end of the exported range
+const int64_t EXPORT_STALL_MICROS = 2000000;
+
+} // namespace
+
+vivictpp::OverloadPolicy
+vivictpp::parseOverloadPolicy(const std::string &name) {
+  if (name == "drop") {
+    return OverloadPolicy::DROP_LATE;
+  }
+  if (name == "skip") {
+    return OverloadPolicy::SKIP_NONREF;
+  }
+  return OverloadPolicy::WAIT;
+}
 
 int vivictpp::VideoPlayback::SeekState::seekStart(
     vivictpp::time::Time seekTarget) {
@@ -33,20 +65,24 @@ void vivictpp::VideoPlayback::SeekState::sync() {
 }
 
 vivictpp::VideoPlayback::VideoPlayback(
-    const std::vector<SourceConfig> &sourceConfigs)
-    : videoInputs(),
+    const std::vector<SourceConfig> &sourceConfigs,
+    vivictpp::audio::AudioOutputFactory *audioOutputFactory)
+    : videoInputs(audioOutputFactory != nullptr),
+      audioOutputFactory(audioOutputFactory),
       logger(vivictpp::logging::getOrCreateLogger("vivictpp::VideoPlayback")) {
-  if (sourceConfigs.size() >= 1) {
-    videoInputs.openLeft(sourceConfigs[0]);
-  }
-  if (sourceConfigs.size() >= 2) {
-    videoInputs.openRight(sourceConfigs[1]);
-  }
   if (!sourceConfigs.empty()) {
-    initPlaybackState();
+    videoInputs.startOpenInputs(sourceConfigs);
   }
 }
 
+bool vivictpp::VideoPlayback::checkOpened() {
+  if (!videoInputs.isOpening() || !videoInputs.finishOpenInputs()) {
+    return false;
+  }
+  initPlaybackState();
+  return true;
+}
+
 void vivictpp::VideoPlayback::initPlaybackState() {
   frameDuration = videoInputs.frameDuration();
   playbackState.pts = videoInputs.startTime();
@@ -54,6 +90,16 @@ void vivictpp::VideoPlayback::initPlaybackState() {
   playbackState.hasLeftSource = videoInputs.hasLeftSource();
   playbackState.hasRightSource = videoInputs.hasRightSource();
   playbackState.ready = playbackState.hasLeftSource;
+  audioOutput.reset();
+  if (audioOutputFactory && videoInputs.hasAudio()) {
+    try {
+      audioOutput =
+          audioOutputFactory->create(videoInputs.getAudioCodecContext());
+    } catch (const std::exception &e) {
+      logger->warn("Audio playback disabled: {}", e.what());
+    }
+  }
+  audioResync = true;
 }
 
 void vivictpp::VideoPlayback::setLeftSource(const SourceConfig &source) {
@@ -69,7 +115,7 @@ void vivictpp::VideoPlayback::setRightSource(const SourceConfig &source) {
 }
 
 void vivictpp::VideoPlayback::togglePlaying() {
-  if (playbackState.seeking) {
+  if (playbackState.seeking || !playbackState.ready) {
     return;
   }
   if (!playbackState.playing) {
@@ -80,23 +126,56 @@ void vivictpp::VideoPlayback::togglePlaying() {
 }
 
 void vivictpp::VideoPlayback::play() {
+  exporting = false;
   t0 = vivictpp::time::relativeTimeMicros();
   playbackStartPts = playbackState.pts;
   playbackState.playing = true;
+  // Frames stepped past while paused were not dropped
+  videoInputs.framesPresented(false);
+  if (videoInputs.showingCachedFrames() && !playbackState.seeking) {
+    seekInputs(playbackState.pts);
+  }
+  if (audioOutput) {
+    // Audio already taken from the decoder is lost when the position has
+    // jumped, so seek to get it back
+    if (audioResync && !playbackState.seeking &&
+        !videoInputs.audioPtsInRange(playbackState.pts)) {
+      seek(playbackState.pts);
+    }
+    audioOutput->start();
+  }
 }
 
-void vivictpp::VideoPlayback::pause() { playbackState.playing = false; }
+void vivictpp::VideoPlayback::pause() {
+  playbackState.playing = false;
+  if (audioOutput) {
+    audioOutput->stop();
+  }
+  if (videoInputs.stopCatchUp() && !playbackState.seeking) {
+    // Frames skipped while catching up would be missing when stepping
+    audioResync = true;
+    seekInputs(playbackState.pts);
+  }
+}
 
 void vivictpp::VideoPlayback::seek(vivictpp::time::Time seekPts,
                                    vivictpp::time::Time streamSeekOffset) {
-  logger->debug("seek: pts={}", seekPts);
+  VPP_LOG_DEBUG(logger, "seek: pts={}", seekPts);
+  if (!playbackState.ready) {
+    return;
+  }
   seekPts = std::max(seekPts, videoInputs.minPts());
   if (videoInputs.hasMaxPts()) {
     seekPts = std::min(seekPts, videoInputs.maxPts());
   }
-  if (!playbackState.seeking && videoInputs.ptsInRange(seekPts)) {
-    logger->debug("seek: pts is in range");
+  audioResync = true;
+  bool audioInRange = !audioOutput || !playbackState.playing ||
+                      videoInputs.audioPtsInRange(seekPts);
+  if (!playbackState.seeking && videoInputs.ptsInRange(seekPts) &&
+      audioInRange) {
+    VPP_LOG_DEBUG(logger, "seek: pts is in range");
     advanceFrame(seekPts);
+    videoInputs.framesPresented(false);
     stepped = true;
     if (playbackState.playing) {
       playbackStartPts = seekPts;
@@ -105,16 +184,39 @@ void vivictpp::VideoPlayback::seek(vivictpp::time::Time seekPts,
     // TODO: Make make special method for this
     int seekId = seekState.seekStart(seekPts);
     seekState.seekFinished(seekId, seekPts, false);
-  } else {
-    logger->debug("seek: pts is not in range");
-    playbackState.seeking = true;
+  } else if (!playbackState.seeking && !playbackState.playing &&
+             videoInputs.showCachedFrames(seekPts)) {
+    // Stepping back and forth while paused, the decoders are only seeked
+    // when playback starts or a frame is not cached
+    VPP_LOG_DEBUG(logger, "seek: frames are cached");
+    playbackState.pts = seekPts;
+    stepped = true;
     int seekId = seekState.seekStart(seekPts);
-    videoInputs.seek(
-        seekPts,
-        [this, seekId](vivictpp::time::Time pos, bool error) {
-          this->seekState.seekFinished(seekId, pos, error);
-        },
-        streamSeekOffset);
+    seekState.seekFinished(seekId, seekPts, false);
+  } else {
+    VPP_LOG_DEBUG(logger, "seek: pts is not in range");
+    seekInputs(seekPts, streamSeekOffset);
+  }
+}
+
+void vivictpp::VideoPlayback::seekInputs(
+    vivictpp::time::Time seekPts, vivictpp::time::Time streamSeekOffset) {
+  playbackState.seeking = true;
+  int seekId = seekState.seekStart(seekPts);
+  videoInputs.seek(
+      seekPts,
+      [this, seekId](vivictpp::time::Time pos, bool error) {
+        this->seekState.seekFinished(seekId, pos, error);
+      },
+      streamSeekOffset);
+}
+
+void vivictpp::VideoPlayback::setOverloadPolicy(OverloadPolicy policy) {
+  overloadPolicy = policy;
+  if (policy != OverloadPolicy::SKIP_NONREF && videoInputs.stopCatchUp() &&
+      !playbackState.seeking) {
+    audioResync = true;
+    seekInputs(playbackState.pts);
   }
 }
 
@@ -135,30 +237,30 @@ void vivictpp::VideoPlayback::seekRelativeFrame(int distance) {
   } else {
     vivictpp::time::Time seekPts;
     if (distance == 1)
-      seekPts = videoInputs.nextPts();
+      seekPts = videoInputs.nextStepPts(playbackState.pts);
     else if (distance == -1)
-      seekPts = videoInputs.previousPts();
+      seekPts = videoInputs.previousStepPts(playbackState.pts);
     else
       seekPts = playbackState.pts + distance * frameDuration;
     if (vivictpp::time::isNoPts(seekPts)) {
       seekPts = playbackState.pts + distance * frameDuration;
     }
-    logger->debug("seekRelativeFrame  seeking to {}", seekPts);
+    VPP_LOG_DEBUG(logger, "seekRelativeFrame  seeking to {}", seekPts);
     seek(seekPts);
   }
 }
 
 bool vivictpp::VideoPlayback::checkAdvanceFrame(int64_t nextPresent) {
-  logger->debug("checkAdvanceFrame");
+  VPP_LOG_DEBUG(logger, "checkAdvanceFrame");
   if (playbackState.seeking) {
     seekState.sync();
     if (!seekState.seekDone) {
-      logger->debug("checkAdvanceFrame: seekState.seekDone=false");
+      VPP_LOG_DEBUG(logger, "checkAdvanceFrame: seekState.seekDone=false");
       return false;
     }
     //    logger->debug("checkAdvanceFrame playbackState.seeking=true,
     //    seekEndPos={}", seekState.seekEndPos);
-    logger->debug("seekEndPos={} seekTarget={}", seekState.seekEndPos,
+    VPP_LOG_DEBUG(logger, "seekEndPos={} seekTarget={}", seekState.seekEndPos,
                   seekState.seekTarget);
     if (!videoInputs.ptsInRange(seekState.seekTarget) &&
         seekState.seekEndPos - seekState.seekTarget > 1000) {
@@ -174,6 +276,7 @@ bool vivictpp::VideoPlayback::checkAdvanceFrame(int64_t nextPresent) {
     }
     seekRetry = 0;
     advanceFrame(seekState.seekEndPos);
+    videoInputs.framesPresented(false);
     playbackState.seeking = false;
     if (playbackState.playing) {
       playbackStartPts = seekState.seekEndPos;
@@ -207,34 +310,194 @@ bool vivictpp::VideoPlayback::checkAdvanceFrame(int64_t nextPresent) {
     }
   }
 
+  playbackState.speedDen = speedFactorDen;
+  playbackState.speedNum = speedFactorNum;
+
+  if (videoInputs.rebalanceDecoders(vivictpp::time::relativeTimeMicros())) {
+    // Decoders pick up their new thread counts when flushed by a seek
+    audioResync = true;
+    seekInputs(playbackState.pts);
+    return false;
+  }
+
+  feedAudio();
+  syncToAudio();
+
   vivictpp::time::Time nextPts = videoInputs.nextPts();
   vivictpp::time::Time nextDisplayPts =
       playbackStartPts + speedFactorDen * (nextPresent - t0) / speedFactorNum;
+  playbackState.clockPts = nextDisplayPts;
   if (nextDisplayPts > videoInputs.maxPts()) {
     nextDisplayPts = videoInputs.maxPts();
   }
+  if (overloadPolicy == OverloadPolicy::SKIP_NONREF) {
+    videoInputs.updateCatchUp(nextDisplayPts);
+  }
   if (videoInputs.ptsInRange(nextPts)) {
     if (nextDisplayPts >= nextPts) {
       while (nextDisplayPts >= nextPts && videoInputs.ptsInRange(nextPts)) {
-        advanceFrame(nextPts);
+        // An input that was behind when late frames were dropped may still
+        // have frames before the playback position
+        advanceFrame(std::max(nextPts, playbackState.pts));
         if (std::abs(nextPts - videoInputs.maxPts()) < 1000) {
           pause();
         }
         nextPts = videoInputs.nextPts();
       }
+      videoInputs.framesPresented(true);
       return true;
     } else {
       return false;
     }
   }
+  if (overloadPolicy != OverloadPolicy::WAIT &&
+      nextDisplayPts - playbackState.pts > MAX_LATE_FRAMES * frameDuration) {
+    // Show what has been decoded up to the clock instead of waiting for the
+    // slowest input
+    VPP_LOG_DEBUG(logger, "checkAdvanceFrame: late, pts={} clockPts={}",
+                  playbackState.pts, nextDisplayPts);
+    if (videoInputs.step(nextDisplayPts) > 0) {
+      playbackState.pts = nextDisplayPts;
+      videoInputs.framesPresented(true);
+      return true;
+    }
+  }
   videoInputs.dropIfFullAndNextOutOfRange(nextPts, 1);
   return false;
 };
 
+void vivictpp::VideoPlayback::feedAudio() {
+  if (!audioOutput) {
+    return;
+  }
+  if (audioResync) {
+    audioOutput->clearQueue();
+    audioResync = false;
+  }
+  // Audio is not time stretched, so it is only played at normal speed.
+  // Audio behind the playback position is always dropped so that the decoder
+  // is never blocked on a full buffer.
+  bool realtime = playbackState.speedAdjust == 0;
+  vivictpp::workers::FrameBuffer &frames = videoInputs.audioFrames();
+  vivictpp::time::Time offset = videoInputs.audioPtsOffset();
+  while (!frames.isEmpty()) {
+    vivictpp::libav::Frame frame = frames.first();
+    vivictpp::time::Time pts = frames.currentPts() - offset;
+    vivictpp::time::Time end =
+        pts + av_rescale(frame->nb_samples, vivictpp::time::TIME_BASE,
+                         frame->sample_rate);
+    if (end > playbackState.pts) {
+      if (!realtime || audioOutput->queueDuration() >= AUDIO_QUEUE_TARGET) {
+        break;
+      }
+      audioOutput->queueAudio(frame, pts);
+    }
+    frames.drop(1);
+  }
+}
+
+void vivictpp::VideoPlayback::syncToAudio() {
+  playbackState.audioClock = false;
+  if (!audioOutput || playbackState.speedAdjust != 0 ||
+      audioOutput->queueDuration() == 0) {
+    return;
+  }
+  vivictpp::time::Time audioPts = audioOutput->currentPts();
+  if (vivictpp::time::isNoPts(audioPts)) {
+    return;
+  }
+  vivictpp::time::Time clockPts =
+      playbackStartPts + vivictpp::time::relativeTimeMicros() - t0;
+  vivictpp::time::Time drift = audioPts - clockPts;
+  // Small differences are corrected gradually so that frame pacing is not
+  // disturbed by jitter in the audio position
+  if (std::abs(drift) > AUDIO_MAX_DRIFT) {
+    playbackStartPts += drift;
+  } else {
+    playbackStartPts += drift / AUDIO_DRIFT_SMOOTHING;
+  }
+  playbackState.audioClock = true;
+}
+
 void vivictpp::VideoPlayback::advanceFrame(vivictpp::time::Time nextPts) {
-  logger->debug("advanceFrame nextPts={}", nextPts);
+  VPP_LOG_DEBUG(logger, "advanceFrame nextPts={}", nextPts);
   playbackState.pts = nextPts;
 
   videoInputs.step(playbackState.pts);
   //  logger->debug("After advance frame pts={}", videoInputs.);
 }
+
+void vivictpp::VideoPlayback::startExport(vivictpp::time::Time from,
+                                          vivictpp::time::Time to) {
+  if (!playbackState.ready) {
+    return;
+  }
+  if (playbackState.playing) {
+    pause();
+  }
+  exportFrom = std::max(from, videoInputs.minPts());
+  exportTo = videoInputs.hasMaxPts() ? std::min(to, videoInputs.maxPts()) : to;
+  exportedPts.assign(videoInputs.inputCount(), vivictpp::time::NO_TIME);
+  exportProgressTime = vivictpp::time::relativeTimeMicros();
+  VPP_LOG_DEBUG(logger, "startExport: from={} to={}", exportFrom, exportTo);
+  // Seeked even if from is buffered, frames before the current one may have
+  // been dropped from the buffers
+  seekInputs(exportFrom);
+  exporting = true;
+}
+
+std::vector<vivictpp::ExportFrame>
+vivictpp::VideoPlayback::takeExportFrames(size_t maxFrames) {
+  std::vector<ExportFrame> result;
+  if (!exporting) {
+    return result;
+  }
+  int64_t now = vivictpp::time::relativeTimeMicros();
+  // Waiting for the seek or for the caller is not a stall
+  if (playbackState.seeking || maxFrames == 0) {
+    exportProgressTime = now;
+  }
+  if (playbackState.seeking) {
+    return result;
+  }
+  std::vector<std::vector<std::pair<vivictpp::time::Time,
+                                    vivictpp::libav::Frame>>>
+      frames;
+  std::vector<std::vector<vivictpp::time::Time>> buffered;
+  for (size_t i = 0; i < exportedPts.size(); i++) {
+    // Frames after exportTo are included to know when an input is done
+    frames.push_back(videoInputs.bufferedFrames(
+        i, vivictpp::time::isNoPts(exportedPts[i]) ? vivictpp::time::NO_TIME
+                                                   : exportedPts[i] + 1));
+    buffered.emplace_back();
+    for (const auto &frame : frames.back()) {
+      buffered.back().push_back(frame.first);
+    }
+  }
+  vivictpp::video::ExportSelection selection =
+      vivictpp::video::selectExportFrames(buffered, exportFrom, exportTo,
+                                          maxFrames, exportedPts);
+  for (size_t i = 0; i < selection.frames.size(); i++) {
+    for (size_t j : selection.frames[i]) {
+      result.push_back(
+          {i, frames[i][j].first, std::move(frames[i][j].second)});
+      exportProgressTime = now;
+    }
+  }
+  bool done = selection.done;
+  vivictpp::time::Time stepPts = selection.stepPts;
+  if (now - exportProgressTime > EXPORT_STALL_MICROS) {
+    VPP_LOG_DEBUG(logger, "takeExportFrames: no new frames, stopping");
+    done = true;
+  }
+  if (done) {
+    exporting = false;
+  } else if (!vivictpp::time::isNoPts(stepPts) &&
+             stepPts > playbackState.pts && videoInputs.ptsInRange(stepPts)) {
+    // Shows the progress, and frees buffer space for the decoders
+    advanceFrame(stepPts);
+    videoInputs.framesPresented(false);
+    stepped = true;
+  }
+  return result;
+}
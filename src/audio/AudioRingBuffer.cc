@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/AudioRingBuffer.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t x) {
+  size_t result = 1;
+  while (result < x) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
+vivictpp::audio::AudioRingBuffer::AudioRingBuffer(size_t minCapacity)
+    : buffer(new uint8_t[roundUpToPowerOfTwo(minCapacity)]),
+      mask(roundUpToPowerOfTwo(minCapacity) - 1) {}
+
+size_t vivictpp::audio::AudioRingBuffer::readableBytes() const {
+  uint64_t w = writePos.load(std::memory_order_relaxed);
+  uint64_t r = std::max(readPos.load(std::memory_order_acquire),
+                        flushPos.load(std::memory_order_relaxed));
+  return w - r;
+}
+
+size_t vivictpp::audio::AudioRingBuffer::write(const uint8_t *data,
+                                               size_t size) {
+  uint64_t w = writePos.load(std::memory_order_relaxed);
+  // Flushed bytes are only free once the consumer has skipped them, it may
+  // still be copying them with its old read position
+  size_t n = std::min(
+      size, capacity() - (size_t)(w - readPos.load(std::memory_order_acquire)));
+  size_t offset = w & mask;
+  size_t first = std::min(n, capacity() - offset);
+  std::memcpy(buffer.get() + offset, data, first);
+  std::memcpy(buffer.get(), data + first, n - first);
+  writePos.store(w + n, std::memory_order_release);
+  return n;
+}
+
+void vivictpp::audio::AudioRingBuffer::flush() {
+  flushPos.store(writePos.load(std::memory_order_relaxed),
+                 std::memory_order_release);
+}
+
+size_t vivictpp::audio::AudioRingBuffer::read(uint8_t *data, size_t size) {
+  // flushPos must be loaded before writePos, it is never ahead of it
+  uint64_t r = std::max(readPos.load(std::memory_order_relaxed),
+                        flushPos.load(std::memory_order_acquire));
+  uint64_t w = writePos.load(std::memory_order_acquire);
+  size_t n = std::min(size, (size_t)(w - r));
+  size_t offset = r & mask;
+  size_t first = std::min(n, capacity() - offset);
+  std::memcpy(data, buffer.get() + offset, first);
+  std::memcpy(data + first, buffer.get(), n - first);
+  readPos.store(r + n, std::memory_order_release);
+  return n;
+}
@@ -92,12 +92,15 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::Controls::draw(
 
     ImGui::PopStyleColor();
     float sliderWidth = work_size.x - 60;
+    seekBarWidth = sliderWidth;
+    thumbnailTexture.update();
     float grabSize = 8.0f;
     float grabPadding = 2.0f; // Copy of value grap_padding in imgui_widgets.cpp
     ImGui::PushStyleVar(ImGuiStyleVar_GrabMinSize, grabSize);
     ImGui::PushItemWidth(sliderWidth);
     float durationSeconds = playbackState.duration / 1e6;
     ImGui::SliderFloat("##Seekbar", &seekValue, 0.0f, durationSeconds, "");
+    bool scrubbed = ImGui::IsItemActive() && ImGui::IsItemEdited();
     float oldSeekValue = seekValue;
     ImGui::PopItemWidth();
     if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal)) {
@@ -115,13 +118,16 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::Controls::draw(
           ImGui::GetCursorPosY() - thumbnailTexture.getHeight() - 8;
       ImVec2 p2(thumbnailPos.x + thumbnailTexture.getWidth(),
                 thumbnailPos.y + thumbnailTexture.getHeight());
-      auto thumbnail = thumbnailTexture.updateAndGetTexture(
+      auto thumbnail = thumbnailTexture.getRegion(
           (uint64_t)(1e6 * durationSeconds * posFrac));
-      ImGui::GetWindowDrawList()->AddRect(
-          {thumbnailPos.x - 1, thumbnailPos.y - 1}, {p2.x + 1, p2.y + 1},
-          border);
-      ImGui::GetWindowDrawList()->AddImage(
-          (ImTextureID)(intptr_t)thumbnail.get(), thumbnailPos, p2);
+      if (thumbnail.texture) {
+        ImGui::GetWindowDrawList()->AddRect(
+            {thumbnailPos.x - 1, thumbnailPos.y - 1}, {p2.x + 1, p2.y + 1},
+            border);
+        ImGui::GetWindowDrawList()->AddImage(
+            (ImTextureID)(intptr_t)thumbnail.texture, thumbnailPos, p2,
+            {thumbnail.u0, thumbnail.v0}, {thumbnail.u1, thumbnail.v1});
+      }
     }
     if (ImGui::IsItemActive()) {
       showControls = 70;
@@ -136,6 +142,11 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::Controls::draw(
       spdlog::info("Drag end: {}", seekValue);
       vivictpp::time::Time seekPos = (uint64_t)1e6 * oldSeekValue;
       actions.push_back({ActionType::Seek, seekPos});
+    } else if (scrubbed) {
+      // Show a nearby cached frame while dragging, the exact frame is shown
+      // after the seek when the drag ends
+      vivictpp::time::Time scrubPos = (uint64_t)1e6 * seekValue;
+      actions.push_back({ActionType::Scrub, scrubPos});
     }
     ImGui::PopStyleVar();
     ImGui::EndGroup();
@@ -30,8 +30,16 @@ i      Zoom out
 0      Reset pan and zoom to default
 s      Toggle scale content to fit window
 t      Toggle visibility of time
+T      Toggle presentation statistics
+h      Toggle performance HUD
+g      Toggle grid layout showing all videos
+x      Cycle difference view: off, difference, PSNR heatmap
 d      Toggle visibility of Stream and Frame metadata
 
+e      Export the current frames as images
+E      Export the visible area of the current frames
+Ctrl-e Mark start of export range, press again to export the range
+
 q      Quit application)";
 
 void vivictpp::imgui::showHelp(ui::DisplayState &displayState) {
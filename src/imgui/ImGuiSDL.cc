@@ -10,6 +10,8 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_sdlrenderer2.h"
 #include "platform_folders.h"
+#include "time/TimeUtils.hh"
+#include "tracing/Tracing.hh"
 #include "ui/FontSize.hh"
 #include <filesystem>
 #include <memory>
@@ -105,13 +107,43 @@ void vivictpp::imgui::ImGuiSDL::render() {
       (Uint8)(CLEAR_COLOR.z * 255), (Uint8)(CLEAR_COLOR.w * 255));
   SDL_RenderClear(renderer);
   ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
-  SDL_RenderPresent(renderer);
+  {
+    VPP_TRACE_SPAN("present");
+    SDL_RenderPresent(renderer);
+  }
+  renderStats.framesRendered.fetch_add(1, std::memory_order_relaxed);
   ImGui::EndFrame();
 }
 
 void vivictpp::imgui::ImGuiSDL::updateTextures(
     const ui::DisplayState &displayState) {
+  int64_t t0 = vivictpp::time::relativeTimeMicros();
   videoTextures.update(renderer, displayState);
+  recordTextureUpload(t0);
+}
+
+void vivictpp::imgui::ImGuiSDL::updateVisibleRegion(
+    const ui::DisplayState &displayState) {
+  int64_t t0 = vivictpp::time::relativeTimeMicros();
+  if (videoTextures.updateVisibleRegion(displayState)) {
+    recordTextureUpload(t0);
+  }
+}
+
+void vivictpp::imgui::ImGuiSDL::recordTextureUpload(int64_t t0) {
+  renderStats.textureUploadMicros.fetch_add(
+      vivictpp::time::relativeTimeMicros() - t0, std::memory_order_relaxed);
+  renderStats.textureUploads.fetch_add(1, std::memory_order_relaxed);
+}
+
+int vivictpp::imgui::ImGuiSDL::getDisplayRefreshRate() {
+  SDL_DisplayMode displayMode;
+  int displayIndex = SDL_GetWindowDisplayIndex(window);
+  if (displayIndex < 0 ||
+      SDL_GetCurrentDisplayMode(displayIndex, &displayMode) != 0) {
+    return 0;
+  }
+  return displayMode.refresh_rate;
 }
 
 void vivictpp::imgui::ImGuiSDL::fitWindowToTextures() {
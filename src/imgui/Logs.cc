@@ -6,12 +6,52 @@
 
 #include "imgui/Logs.hh"
 #include "logging/Logging.hh"
+#include "time/TimeUtils.hh"
+#include "tracing/Tracing.hh"
 
+#include "fmt/core.h"
+
+#include <filesystem>
+#include <stdexcept>
 #include <string>
 
+namespace {
+std::string traceMessage;
+
+void showTracingControls() {
+  bool tracing = vivictpp::tracing::isEnabled();
+  if (ImGui::Checkbox("Tracing", &tracing)) {
+    vivictpp::tracing::setEnabled(tracing);
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Save trace")) {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        fmt::format("vivictpp-trace-{}.json",
+                    vivictpp::time::relativeTimeMillis());
+    try {
+      vivictpp::tracing::writeChromeTrace(path);
+      traceMessage = "Trace written to " + path.string();
+    } catch (const std::exception &e) {
+      traceMessage = std::string("Failed to write trace: ") + e.what();
+    }
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Clear trace")) {
+    vivictpp::tracing::clear();
+    traceMessage.clear();
+  }
+  if (!traceMessage.empty()) {
+    ImGui::TextUnformatted(traceMessage.c_str());
+  }
+  ImGui::Separator();
+}
+} // namespace
+
 void vivictpp::imgui::showLogs(ui::DisplayState &displayState) {
   if (ImGui::Begin("Logs", &displayState.displayLogs,
                    ImGuiWindowFlags_NoCollapse)) {
+    showTracingControls();
     for (std::string row : vivictpp::logging::getMessages()) {
       ImGui::TextUnformatted(row.c_str());
     }
@@ -27,6 +27,18 @@ vivictpp::imgui::MainMenu::draw(const PlaybackState &playbackState,
         actions.push_back({ActionType::ShowQualityFileDialogRight});
       }
       ImGui::Separator();
+      if (ImGui::MenuItem("Export frames", "E", false, playbackState.ready)) {
+        actions.push_back({ActionType::ExportFrames});
+      }
+      if (ImGui::MenuItem("Export visible area", "Shift+E", false,
+                          playbackState.ready)) {
+        actions.push_back({ActionType::ExportVisibleArea});
+      }
+      if (ImGui::MenuItem("Mark/export range", "Ctrl+E", false,
+                          playbackState.ready)) {
+        actions.push_back({ActionType::ExportRange});
+      }
+      ImGui::Separator();
       if (ImGui::MenuItem("Settings", "Ctrl+Alt+S")) {
         actions.push_back({ActionType::ShowSettingsDialog});
       }
@@ -64,6 +76,22 @@ vivictpp::imgui::MainMenu::draw(const PlaybackState &playbackState,
       if (ImGui::MenuItem("Fit to screen", "Alt-F", displayState.fitToScreen)) {
         actions.push_back({ActionType::ToggleFitToScreen});
       }
+      if (ImGui::MenuItem("Presentation stats", "Shift-T",
+                          displayState.displayPresentationStats)) {
+        actions.push_back({ActionType::TogglePresentationStats});
+      }
+      if (ImGui::MenuItem("Performance HUD", "H",
+                          displayState.displayPerformanceHud)) {
+        actions.push_back({ActionType::TogglePerformanceHud});
+      }
+      if (ImGui::MenuItem("Grid layout", "G", displayState.gridLayout)) {
+        actions.push_back({ActionType::ToggleGridLayout});
+      }
+      if (ImGui::MenuItem("Difference view", "X",
+                          displayState.differenceMode !=
+                              vivictpp::video::DifferenceMode::OFF)) {
+        actions.push_back({ActionType::CycleDifferenceMode});
+      }
       ImGui::EndMenu();
     }
     if (ImGui::BeginMenu("Playback")) {
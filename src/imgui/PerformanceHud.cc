@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "imgui/PerformanceHud.hh"
+
+#include "imgui.h"
+#include "time/TimeUtils.hh"
+#include "ui/FontSize.hh"
+
+#include <cfloat>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+// Counters restart from zero when a source is reopened
+uint64_t delta(uint64_t current, uint64_t previous) {
+  return current >= previous ? current - previous : current;
+}
+
+void sparkline(const char *label, const float *values, int count, int offset,
+               const char *format, float value) {
+  char overlay[32];
+  snprintf(overlay, sizeof(overlay), format, value);
+  float scaling = vivictpp::ui::FontSize::getScaleFactor();
+  ImGui::PlotLines(label, values, count, offset, overlay, 0.0f, FLT_MAX,
+                   {160.0f * scaling, 28.0f * scaling});
+}
+
+} // namespace
+
+void vivictpp::imgui::PerformanceHud::Series::push(float value) {
+  values[offset] = value;
+  offset = (offset + 1) % HISTORY_SIZE;
+}
+
+float vivictpp::imgui::PerformanceHud::Series::last() const {
+  return values[(offset + HISTORY_SIZE - 1) % HISTORY_SIZE];
+}
+
+void vivictpp::imgui::PerformanceHud::update(
+    const std::array<const workers::PipelineStats *, 2> &pipelineStats,
+    const RenderStats &renderStats) {
+  int64_t now = vivictpp::time::relativeTimeMicros();
+  if (lastSampleTime != 0 && now - lastSampleTime < SAMPLE_INTERVAL_MICROS) {
+    return;
+  }
+  bool firstSample = lastSampleTime == 0;
+  float seconds = (now - lastSampleTime) / 1e6f;
+  lastSampleTime = now;
+
+  for (size_t i = 0; i < sides.size(); i++) {
+    const workers::PipelineStats *stats = pipelineStats[i];
+    SideSeries &side = sides[i];
+    side.active = stats != nullptr;
+    if (!stats) {
+      lastPipeline[i] = {};
+      continue;
+    }
+    side.framesDropped = stats->framesDropped.load(std::memory_order_relaxed);
+    side.catchUps = stats->catchUps.load(std::memory_order_relaxed);
+    PipelineTotals totals{
+        stats->framesDecoded.load(std::memory_order_relaxed),
+        stats->framesFiltered.load(std::memory_order_relaxed),
+        stats->filterMicros.load(std::memory_order_relaxed)};
+    PipelineTotals &last = lastPipeline[i];
+    if (!firstSample) {
+      uint64_t filtered = delta(totals.framesFiltered, last.framesFiltered);
+      side.packetQueue.push(
+          stats->packetQueueDepth.load(std::memory_order_relaxed));
+      side.frameBuffer.push(
+          stats->frameBufferFill.load(std::memory_order_relaxed));
+      side.decodeFps.push(delta(totals.framesDecoded, last.framesDecoded) /
+                          seconds);
+      side.filterMs.push(
+          filtered == 0
+              ? 0.0f
+              : delta(totals.filterMicros, last.filterMicros) / 1000.0f /
+                    filtered);
+    }
+    last = totals;
+  }
+
+  RenderTotals totals{
+      renderStats.framesRendered.load(std::memory_order_relaxed),
+      renderStats.textureUploads.load(std::memory_order_relaxed),
+      renderStats.textureUploadMicros.load(std::memory_order_relaxed)};
+  if (!firstSample) {
+    uint64_t uploads = delta(totals.textureUploads, lastRender.textureUploads);
+    uploadMs.push(uploads == 0 ? 0.0f
+                               : delta(totals.textureUploadMicros,
+                                       lastRender.textureUploadMicros) /
+                                     1000.0f / uploads);
+    renderFps.push(delta(totals.framesRendered, lastRender.framesRendered) /
+                   seconds);
+  }
+  lastRender = totals;
+}
+
+void vivictpp::imgui::PerformanceHud::drawSide(const char *title,
+                                               const SideSeries &side) {
+  ImGui::BeginGroup();
+  ImGui::PushID(title);
+  ImGui::TextUnformatted(title);
+  sparkline("packet queue", side.packetQueue.values.data(), HISTORY_SIZE,
+            side.packetQueue.offset, "%.0f", side.packetQueue.last());
+  sparkline("frame buffer", side.frameBuffer.values.data(), HISTORY_SIZE,
+            side.frameBuffer.offset, "%.0f", side.frameBuffer.last());
+  sparkline("decode fps", side.decodeFps.values.data(), HISTORY_SIZE,
+            side.decodeFps.offset, "%.1f", side.decodeFps.last());
+  sparkline("filter ms/frame", side.filterMs.values.data(), HISTORY_SIZE,
+            side.filterMs.offset, "%.2f", side.filterMs.last());
+  ImGui::Text("dropped %llu, catch-ups %llu",
+              (unsigned long long)side.framesDropped,
+              (unsigned long long)side.catchUps);
+  ImGui::PopID();
+  ImGui::EndGroup();
+}
+
+void vivictpp::imgui::PerformanceHud::draw(ui::DisplayState &displayState) {
+  const ImGuiViewport *viewport = ImGui::GetMainViewport();
+  ImGui::SetNextWindowPos({viewport->WorkPos.x + viewport->WorkSize.x / 2,
+                           viewport->WorkPos.y + 60},
+                          ImGuiCond_FirstUseEver, {0.5f, 0.0f});
+  ImGui::SetNextWindowBgAlpha(0.6f);
+  if (!ImGui::Begin("Performance", &displayState.displayPerformanceHud,
+                    ImGuiWindowFlags_NoCollapse |
+                        ImGuiWindowFlags_AlwaysAutoResize |
+                        ImGuiWindowFlags_NoFocusOnAppearing |
+                        ImGuiWindowFlags_NoNav)) {
+    ImGui::End();
+    return;
+  }
+  if (sides[0].active) {
+    drawSide("Left", sides[0]);
+  }
+  if (sides[1].active) {
+    ImGui::SameLine();
+    drawSide("Right", sides[1]);
+  }
+  ImGui::Separator();
+  sparkline("upload ms", uploadMs.values.data(), HISTORY_SIZE, uploadMs.offset,
+            "%.2f", uploadMs.last());
+  sparkline("render fps", renderFps.values.data(), HISTORY_SIZE,
+            renderFps.offset, "%.1f", renderFps.last());
+  ImGui::End();
+}
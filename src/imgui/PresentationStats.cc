@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "imgui/PresentationStats.hh"
+
+#include "imgui.h"
+#include "imgui/WidgetUtils.hh"
+#include "libs/implot/implot.h"
+#include "time/TimeUtils.hh"
+#include "ui/FontSize.hh"
+
+#include <filesystem>
+#include <vector>
+
+void vivictpp::imgui::PresentationStats::draw(
+    ui::DisplayState &displayState, ui::FramePacer &framePacer) {
+  if (!ImGui::Begin("Presentation stats",
+                    &displayState.displayPresentationStats,
+                    ImGuiWindowFlags_NoCollapse)) {
+    ImGui::End();
+    return;
+  }
+  ui::PresentStats stats = framePacer.getStats();
+  float cw = 160.0f * vivictpp::ui::FontSize::getScaleFactor();
+  tableRow2(cw, "refresh rate", "%.2f Hz", stats.refreshRate);
+  tableRow2(cw, "presents", "%lld", (long long)stats.presents);
+  tableRow2(cw, "missed vsyncs", "%lld", (long long)stats.missedVsyncs);
+  tableRow2(cw, "late frames", "%lld", (long long)stats.lateFrames);
+  tableRow2(cw, "duplicated frames", "%lld",
+            (long long)stats.duplicatedFrames);
+  tableRow2(cw, "judder", "%.2f ms", stats.judderMs);
+  tableRow2(cw, "present interval", "%.2f ms", stats.meanIntervalMs);
+  tableRow2(cw, "max interval", "%.2f ms", stats.maxIntervalMs);
+
+  std::vector<ui::PresentRecord> history = framePacer.getHistory();
+  std::vector<float> intervals;
+  intervals.reserve(history.size());
+  for (const auto &record : history) {
+    intervals.push_back(record.interval / 1000.0f);
+  }
+  if (ImPlot::BeginPlot("##PresentIntervals", ImVec2(-1, 150),
+                        ImPlotFlags_NoMenus | ImPlotFlags_NoLegend)) {
+    ImPlot::SetupAxes(nullptr, "ms", ImPlotAxisFlags_NoTickLabels,
+                      ImPlotAxisFlags_AutoFit);
+    ImPlot::SetupAxisLimits(ImAxis_X1, 0, (double)intervals.size(),
+                            ImPlotCond_Always);
+    ImPlot::PlotLine("Present interval", intervals.data(),
+                     (int)intervals.size());
+    ImPlot::EndPlot();
+  }
+
+  if (ImGui::Button("Reset")) {
+    framePacer.resetStats();
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Export CSV")) {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        fmt::format("vivictpp-presents-{}.csv",
+                    vivictpp::time::relativeTimeMillis());
+    try {
+      framePacer.exportCsv(path);
+      exportMessage = "Exported to " + path.string();
+    } catch (const std::exception &e) {
+      exportMessage = e.what();
+    }
+  }
+  if (!exportMessage.empty()) {
+    ImGui::TextWrapped("%s", exportMessage.c_str());
+  }
+  ImGui::End();
+}
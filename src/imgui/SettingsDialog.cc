@@ -18,6 +18,11 @@ std::vector<std::string> getSelectableLogLevels();
 static const std::vector<std::string> selectableLogLevels =
     getSelectableLogLevels();
 
+static const std::vector<std::string> overloadPolicies = {"wait", "drop",
+                                                          "skip"};
+
+static const std::vector<std::string> exportFormats = {"png", "tiff", "pgm"};
+
 static const std::string longestLoggerName =
     longestString(vivictpp::logging::getLoggers());
 
@@ -56,6 +61,7 @@ vivictpp::imgui::SettingsDialog::SettingsDialog(vivictpp::Settings _settings)
       hwAccelFormats(vivictpp::libav::allHwAccelFormats()),
       decoders(vivictpp::libav::allVideoDecoders()) {
   copyAndNullTerminate(settings.logFile, logFileStr, 512);
+  copyAndNullTerminate(settings.exportDirectory, exportDirStr, 512);
   initHwAccelStatuses();
 }
 
@@ -133,6 +139,58 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::SettingsDialog::draw(
     ImGui::Unindent();
     ImGui::Separator();
 
+    ImGui::Text("Opening files");
+    ImGui::Indent();
+    ImGui::Checkbox("Fast probe", &modifiedSettings.fastProbe);
+    ImGui::BeginDisabled(!modifiedSettings.fastProbe);
+    ts = ImGui::CalcTextSize("000000");
+    ImGui::SetNextItemWidth(ts.x + 3 * ImGui::GetFrameHeight());
+    if (ImGui::InputInt("Probe size (kB)", &modifiedSettings.probeSizeKb)) {
+      modifiedSettings.probeSizeKb =
+          std::clamp(modifiedSettings.probeSizeKb, 32, 65536);
+    }
+    ImGui::SetNextItemWidth(ts.x + 3 * ImGui::GetFrameHeight());
+    if (ImGui::InputInt("Analyze duration (ms)",
+                        &modifiedSettings.analyzeDurationMs, 100)) {
+      modifiedSettings.analyzeDurationMs =
+          std::clamp(modifiedSettings.analyzeDurationMs, 0, 60000);
+    }
+    ImGui::EndDisabled();
+    ImGui::Unindent();
+    ImGui::Separator();
+
+    ImGui::Text("Switching video streams");
+    ImGui::Indent();
+    ts = ImGui::CalcTextSize("00");
+    ImGui::SetNextItemWidth(ts.x + 3 * ImGui::GetFrameHeight());
+    if (ImGui::InputInt("Standby decoders per input",
+                        &modifiedSettings.standbyDecoders)) {
+      modifiedSettings.standbyDecoders =
+          std::clamp(modifiedSettings.standbyDecoders, 0, 8);
+    }
+    ImGui::Unindent();
+    ImGui::Separator();
+
+    ImGui::Text("Playback");
+    ImGui::Indent();
+    ImGui::Text("When decoding can not keep up");
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.6f);
+    comboBox("##Overload policy", overloadPolicies,
+             modifiedSettings.overloadPolicy);
+    ImGui::Unindent();
+    ImGui::Separator();
+
+    ImGui::Text("Export");
+    ImGui::Indent();
+    ImGui::Text("Image format");
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.6f);
+    comboBox("##Export format", exportFormats, modifiedSettings.exportFormat);
+    ImGui::Text("Directory");
+    ImGui::InputText("### Export directory", exportDirStr,
+                     IM_ARRAYSIZE(exportDirStr));
+    ImGui::Unindent();
+    ImGui::Separator();
+
     ImGui::Text("Metrics");
     ImGui::Indent();
     ImGui::Checkbox("Autoload metrics", &modifiedSettings.autoloadMetrics);
@@ -205,6 +263,7 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::SettingsDialog::draw(
             settings.disableFontAutoScaling;
     modifiedSettings = settings;
     copyAndNullTerminate(settings.logFile, logFileStr, 512);
+    copyAndNullTerminate(settings.exportDirectory, exportDirStr, 512);
     initHwAccelStatuses();
     displayState.displaySettingsDialog = false;
   }
@@ -214,6 +273,7 @@ std::vector<vivictpp::imgui::Action> vivictpp::imgui::SettingsDialog::draw(
   if (ImGui::Button("OK")) {
     // Save settings
     modifiedSettings.logFile = std::string(logFileStr);
+    modifiedSettings.exportDirectory = std::string(exportDirStr);
     modifiedSettings.hwAccels.clear();
     for (auto &status : hwAccelStatuses) {
       if (status.enabled) {
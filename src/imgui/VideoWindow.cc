@@ -22,8 +22,12 @@
 #include "spdlog/logger.h"
 #include "time/TimeUtils.hh"
 #include "ui/DisplayState.hh"
+#include <cmath>
 #include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 float alignForWidthPos(float width, float alignment = 0.5f,
                        float offset = 0.0f) {
@@ -72,8 +76,109 @@ ImVec2 resolutionToImVec2(const Resolution &resolution) {
   return {(float)resolution.w, (float)resolution.h};
 }
 
+// Part of an image drawn at imagePos with size imageSize that is inside the
+// view, in normalized image coordinates
+vivictpp::ui::VisibleRect visibleRect(const ImVec2 &imagePos,
+                                      const ImVec2 &imageSize,
+                                      const ImVec2 &viewSize) {
+  if (imageSize.x <= 0 || imageSize.y <= 0) {
+    return {};
+  }
+  return {std::clamp(-imagePos.x / imageSize.x, 0.0f, 1.0f),
+          std::clamp(-imagePos.y / imageSize.y, 0.0f, 1.0f),
+          std::clamp((viewSize.x - imagePos.x) / imageSize.x, 0.0f, 1.0f),
+          std::clamp((viewSize.y - imagePos.y) / imageSize.y, 0.0f, 1.0f)};
+}
+
+const ImGuiWindowFlags VIDEO_WINDOW_FLAGS =
+    ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoDecoration |
+    ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+    ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoBringToFrontOnFocus |
+    ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar;
+
+// Draws every input fitted into its own cell of a grid with as many columns
+// as rows, or one more. Zoom and scroll do not apply to the grid.
+void VideoWindow::drawGrid(vivictpp::ui::VideoTextures &videoTextures,
+                           const vivictpp::ui::DisplayState &displayState) {
+  const ImGuiViewport *viewport = ImGui::GetMainViewport();
+  pos = {0, viewport->WorkPos.y};
+  size = viewport->WorkSize;
+  videoPos = {0, 0};
+  videoSize = size;
+  leftVisibleRect = {};
+  rightVisibleRect = {};
+
+  std::vector<std::pair<SDL_Texture *, const VideoMetadata *>> cells;
+  cells.push_back({videoTextures.leftTexture.get(),
+                   &displayState.leftVideoMetadata});
+  if (!displayState.rightFrame.empty()) {
+    cells.push_back({videoTextures.rightTexture.get(),
+                     &displayState.rightVideoMetadata});
+  }
+  for (size_t i = 0; i < videoTextures.extraTextures.size() &&
+                     i < displayState.extraVideoMetadata.size();
+       i++) {
+    cells.push_back({videoTextures.extraTextures[i].get(),
+                     &displayState.extraVideoMetadata[i]});
+  }
+  int columns = (int)std::ceil(std::sqrt((float)cells.size()));
+  int rows = ((int)cells.size() + columns - 1) / columns;
+  ImVec2 cellSize = {std::floor(size.x / columns),
+                     std::floor(size.y / rows)};
+
+  ImGui::SetNextWindowPos(pos);
+  ImGui::SetNextWindowSize(size);
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+  bool open;
+  if (ImGui::Begin("Vivict++", &open, VIDEO_WINDOW_FLAGS)) {
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    for (size_t i = 0; i < cells.size(); i++) {
+      ImVec2 cellPos = {pos.x + (i % columns) * cellSize.x,
+                        pos.y + (i / columns) * cellSize.y};
+      const Resolution &resolution = cells[i].second->displayResolution;
+      ImVec2 scaledSize = resolutionToImVec2(
+          resolution.scaleKeepingAspectRatio(cellSize.x, cellSize.y));
+      ImVec2 p1 = {cellPos.x + std::floor((cellSize.x - scaledSize.x) / 2),
+                   cellPos.y + std::floor((cellSize.y - scaledSize.y) / 2)};
+      drawList->AddImage((ImTextureID)(intptr_t)cells[i].first, p1,
+                         {p1.x + scaledSize.x, p1.y + scaledSize.y});
+      drawList->AddText({cellPos.x + 4, cellPos.y + 4}, 0xC0FFFFFF,
+                        cells[i].second->source.c_str());
+    }
+  }
+  ImGui::End();
+  ImGui::PopStyleVar(2);
+}
+
+void VideoWindow::drawDifference(vivictpp::ui::VideoTextures &videoTextures,
+                                 ImVec2 p1, ImVec2 p2, bool stale) {
+  ImGui::GetWindowDrawList()->AddImage(
+      (ImTextureID)(intptr_t)videoTextures.differenceTexture.get(), p1, p2);
+  std::string psnr =
+      videoTextures.difference()->psnr >= vivictpp::video::MAX_PSNR
+          ? std::string("PSNR: identical")
+          : fmt::format("PSNR: {:.2f} dB", videoTextures.difference()->psnr);
+  drawLabel(stale ? psnr + " (computing...)" : psnr, p1);
+}
+
+void VideoWindow::drawLabel(const std::string &text, ImVec2 p1) {
+  ImDrawList *drawList = ImGui::GetWindowDrawList();
+  ImVec2 textPos = {std::max(p1.x, pos.x) + 8, std::max(p1.y, pos.y) + 8};
+  ImVec2 textSize = ImGui::CalcTextSize(text.c_str());
+  drawList->AddRectFilled({textPos.x - 4, textPos.y - 2},
+                          {textPos.x + textSize.x + 4,
+                           textPos.y + textSize.y + 2},
+                          0xA0000000);
+  drawList->AddText(textPos, 0xFFFFFFFF, text.c_str());
+}
+
 void VideoWindow::draw(vivictpp::ui::VideoTextures &videoTextures,
                        const vivictpp::ui::DisplayState &displayState) {
+  if (displayState.gridLayout) {
+    drawGrid(videoTextures, displayState);
+    return;
+  }
   const ImGuiViewport *viewport = ImGui::GetMainViewport();
   ImVec2 work_size = viewport->WorkSize;
   ImVec2 work_pos = viewport->WorkPos;
@@ -97,13 +202,7 @@ void VideoWindow::draw(vivictpp::ui::VideoTextures &videoTextures,
   ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
 
   bool myBool2;
-  if (ImGui::Begin(
-          "Vivict++", &myBool2,
-          ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoDecoration |
-              ImGuiWindowFlags_NoSavedSettings |
-              ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav |
-              ImGuiWindowFlags_NoBringToFrontOnFocus |
-              ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar)) {
+  if (ImGui::Begin("Vivict++", &myBool2, VIDEO_WINDOW_FLAGS)) {
     ImVec2 viewSize = work_size;
 
     if (scrollUpdated) {
@@ -136,10 +235,26 @@ void VideoWindow::draw(vivictpp::ui::VideoTextures &videoTextures,
         std::clamp(ImGui::GetMousePos().x, pad.x, pad.x + scaledVideoSize.x);
     ImVec2 drawPos = {pad.x + leftPad.x - scrollX,
                       pad.y + leftPad.y - scrollY}; // cursorPos;
+    leftVisibleRect = visibleRect(drawPos, leftScaledSize, viewSize);
     ImVec2 uvMin(0, 0);
 
     ImVec2 uvMax(1, 1);
     ImVec2 p2(drawPos.x + leftScaledSize.x, drawPos.y + leftScaledSize.y);
+    using vivictpp::video::DifferenceStatus;
+    bool differenceOn =
+        displayState.differenceMode != vivictpp::video::DifferenceMode::OFF;
+    if (differenceOn && videoTextures.difference() &&
+        displayState.differenceStatus != DifferenceStatus::UNSUPPORTED) {
+      // Shown in place of both videos, at the position of the left one
+      drawDifference(videoTextures, drawPos, p2,
+                     displayState.differenceStatus ==
+                         DifferenceStatus::COMPUTING);
+      ImGui::End();
+      ImGui::PopStyleVar(2);
+      return;
+    }
+    // The wipe is shown until there is a difference image
+    ImVec2 labelPos = drawPos;
     if (!displayState.splitScreenDisabled) {
       p2.x = std::min(splitX, drawPos.x + leftScaledSize.x);
       uvMax.x =
@@ -156,6 +271,9 @@ void VideoWindow::draw(vivictpp::ui::VideoTextures &videoTextures,
               .scaleKeepingAspectRatio(scaledVideoSize.x, scaledVideoSize.y));
       ImVec2 rightPad = {(scaledVideoSize.x - rightScaledSize.x) / 2,
                          (scaledVideoSize.y - rightScaledSize.y) / 2};
+      rightVisibleRect = visibleRect(
+          {pad.x + rightPad.x - scrollX, pad.y + rightPad.y - scrollY},
+          rightScaledSize, viewSize);
 
       p2 = {pad.x + rightPad.x + rightScaledSize.x - scrollX,
             pad.y + rightPad.y + rightScaledSize.y - scrollY};
@@ -174,6 +292,12 @@ void VideoWindow::draw(vivictpp::ui::VideoTextures &videoTextures,
                                           {splitX, pad.y + scaledVideoSize.y},
                                           0x80FFFFFF, 0.5);
     }
+    if (differenceOn && !displayState.rightFrame.empty()) {
+      drawLabel(displayState.differenceStatus == DifferenceStatus::UNSUPPORTED
+                    ? "Difference not supported for these pixel formats"
+                    : "Computing difference...",
+                labelPos);
+    }
   }
   ImGui::End();
   ImGui::PopStyleVar(2);
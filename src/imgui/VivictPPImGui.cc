@@ -16,7 +16,12 @@
 #include "imgui/VideoWindow.hh"
 #include "imgui_internal.h"
 #include "libs/implot/implot.h"
+#include "sdl/SDLAudioOutput.hh"
+#include "spdlog/spdlog.h"
 #include "time/TimeUtils.hh"
+#include "tracing/Tracing.hh"
+#include <algorithm>
+#include <cctype>
 #include <memory>
 
 // ImU32 transparentBg = ImGui::ColorConvertFloat4ToU32({0.0f, 0.0f, 0.0f,
@@ -25,23 +30,21 @@
 vivictpp::imgui::VivictPPImGui::VivictPPImGui(
     const VivictPPConfig &vivictPPConfig)
     : settings(vivictPPConfig.settings), imGuiSDL(settings),
-      videoPlayback(vivictPPConfig.sourceConfigs), settingsDialog(settings),
+      videoPlayback(vivictPPConfig.sourceConfigs,
+                    vivictPPConfig.disableAudio
+                        ? nullptr
+                        : &vivictpp::sdl::audioOutputFactory),
+      settingsDialog(settings),
       plotWindow(videoPlayback.getVideoInputs().getLeftVideoIndex(),
                  videoPlayback.getVideoInputs().getRightVideoIndex()) {
   displayState.splitScreenDisabled = vivictPPConfig.sourceConfigs.size() < 2;
   if (displayState.splitScreenDisabled) {
     displayState.splitPercent = 100;
   }
-  if (videoPlayback.getPlaybackState().ready) {
-    displayState.updateFrames(videoPlayback.getVideoInputs().firstFrames());
-    displayState.updateMetadata(videoPlayback.getVideoInputs().metadata());
-    displayState.updateDecoderMetadata(
-        videoPlayback.getVideoInputs().decoderMetadata());
-    imGuiSDL.updateThumbnails(
-        videoPlayback.getVideoInputs().getLeftVideoIndex());
-    imGuiSDL.updateTextures(displayState);
-    imGuiSDL.fitWindowToTextures();
-  }
+  displayState.gridLayout = vivictPPConfig.sourceConfigs.size() > 2;
+  videoPlayback.setOverloadPolicy(
+      vivictpp::parseOverloadPolicy(settings.overloadPolicy));
+  videoPlayback.getVideoInputs().setStandbyDecoders(settings.standbyDecoders);
   if (vivictPPConfig.sourceConfigs.size() > 0) {
     leftQualityMetricsLoader.autoloadMetrics(
         vivictPPConfig.sourceConfigs[0].path,
@@ -65,6 +68,55 @@ vivictpp::imgui::VivictPPImGui::VivictPPImGui(
   }
 }
 
+void vivictpp::imgui::VivictPPImGui::onInputsOpened() {
+  differenceWorker.clear();
+  imGuiSDL.getVideoTextures().clearDifference();
+  displayState.updateFrames(videoPlayback.getVideoInputs().firstFrames());
+  displayState.updateMetadata(videoPlayback.getVideoInputs().metadata());
+  displayState.updateDecoderMetadata(
+      videoPlayback.getVideoInputs().decoderMetadata());
+  imGuiSDL.updateThumbnails(videoPlayback.getVideoInputs().getLeftVideoIndex());
+  imGuiSDL.updateTextures(displayState);
+  imGuiSDL.fitWindowToTextures();
+}
+
+const char *openStageName(OpenStage stage) {
+  switch (stage) {
+  case OpenStage::PROBING:
+    return "Probing";
+  case OpenStage::OPENING_DECODER:
+    return "Opening decoder";
+  case OpenStage::PREROLLING:
+    return "Decoding first frame";
+  case OpenStage::READY:
+    return "Ready";
+  }
+  return "";
+}
+
+void drawOpenProgress(const std::vector<OpenProgress> &progress) {
+  const ImGuiViewport *viewport = ImGui::GetMainViewport();
+  ImGui::SetNextWindowPos({viewport->WorkPos.x + viewport->WorkSize.x / 2,
+                           viewport->WorkPos.y + viewport->WorkSize.y / 2},
+                          ImGuiCond_Always, {0.5f, 0.5f});
+  if (ImGui::Begin("Opening", nullptr,
+                   ImGuiWindowFlags_AlwaysAutoResize |
+                       ImGuiWindowFlags_NoDecoration |
+                       ImGuiWindowFlags_NoSavedSettings |
+                       ImGuiWindowFlags_NoFocusOnAppearing |
+                       ImGuiWindowFlags_NoNav)) {
+    for (const auto &p : progress) {
+      // Stages are of very different length, this only shows how far along
+      // each input is
+      float fraction = ((int)p.stage + 1) / ((int)OpenStage::READY + 1.0f);
+      ImGui::TextUnformatted(p.source.c_str());
+      ImGui::ProgressBar(fraction, {ImGui::GetFontSize() * 24, 0},
+                         openStageName(p.stage));
+    }
+  }
+  ImGui::End();
+}
+
 void drawSplash() {
   const ImGuiViewport *viewport = ImGui::GetMainViewport();
   ImVec2 work_size = viewport->WorkSize;
@@ -92,6 +144,7 @@ void drawSplash() {
 }
 
 void vivictpp::imgui::VivictPPImGui::run() {
+  vivictpp::tracing::setThreadName("ui");
 
   while (!done) {
     std::shared_ptr<vivictpp::qualitymetrics::QualityMetrics> newValue =
@@ -116,20 +169,58 @@ void vivictpp::imgui::VivictPPImGui::run() {
     }
     handleActions(fileDialog.draw());
     handleActions(qualityFileDialog.draw());
+    if (videoPlayback.checkOpened()) {
+      onInputsOpened();
+    }
     if (videoPlayback.getPlaybackState().ready) {
       handleActions(controls.draw(videoPlayback.getPlaybackState(),
                                   displayState,
                                   imGuiSDL.getThumbnailTexture()));
+      videoPlayback.getVideoInputs().setSeekBarWidth(
+          (int)controls.getSeekBarWidth());
+      framePacer.setDisplayRefreshRate(imGuiSDL.getDisplayRefreshRate());
+      if (videoPlayback.isPlaying() &&
+          videoPlayback.getClockOrigin() != alignedClockOrigin) {
+        alignedClockOrigin =
+            framePacer.alignClockOrigin(videoPlayback.getClockOrigin());
+        videoPlayback.setClockOrigin(alignedClockOrigin);
+      }
       int64_t tNextPresent =
-          tLastPresent + (int64_t)(1e6 * ImGui::GetIO().DeltaTime);
-      if (videoPlayback.checkAdvanceFrame(tNextPresent)) {
+          framePacer.predictNextVsync(vivictpp::time::relativeTimeMicros());
+      if (videoPlayback.isExporting()) {
+        submitExportFrames();
+      }
+      if (!scrubbing && videoPlayback.checkAdvanceFrame(tNextPresent)) {
         displayState.updateFrames(videoPlayback.getVideoInputs().firstFrames());
         imGuiSDL.updateTextures(displayState);
       }
       displayState.pts = videoPlayback.getPlaybackState().pts;
+      if (!scrubbing) {
+        // Keeps the frames nearest the playback position cached for the
+        // start of the next drag
+        videoPlayback.getVideoInputs().setScrubCenter(displayState.pts);
+      }
       displayState.isPlaying = videoPlayback.isPlaying();
+      if (displayState.differenceMode != vivictpp::video::DifferenceMode::OFF &&
+          !displayState.rightFrame.empty()) {
+        // Until the difference of the current frames is done, the previous
+        // one is shown
+        vivictpp::video::DifferenceWorker::Image difference =
+            differenceWorker.get(displayState.leftFrame,
+                                 displayState.rightFrame,
+                                 displayState.differenceMode,
+                                 displayState.isPlaying);
+        displayState.differenceStatus =
+            vivictpp::video::DifferenceWorker::status(difference);
+        imGuiSDL.updateDifference(difference);
+      }
       videoWindow.draw(imGuiSDL.getVideoTextures(), displayState);
+      displayState.leftVisibleRect = videoWindow.getLeftVisibleRect();
+      displayState.rightVisibleRect = videoWindow.getRightVisibleRect();
+      imGuiSDL.updateVisibleRegion(displayState);
       handleActions(plotWindow.draw(displayState));
+    } else if (videoPlayback.isOpening()) {
+      drawOpenProgress(videoPlayback.openProgress());
     } else {
       drawSplash();
     }
@@ -150,11 +241,184 @@ void vivictpp::imgui::VivictPPImGui::run() {
     if (displayState.displaySettingsDialog) {
       handleActions(settingsDialog.draw(displayState));
     }
+    if (displayState.displayPresentationStats) {
+      presentationStats.draw(displayState, framePacer);
+    }
+    if (displayState.displayPerformanceHud &&
+        videoPlayback.getPlaybackState().ready) {
+      performanceHud.update(videoPlayback.getVideoInputs().pipelineStats(),
+                            imGuiSDL.getRenderStats());
+      performanceHud.draw(displayState);
+    }
     imGuiSDL.render();
     if (settingsDialog.isFontSettingsUpdated()) {
       imGuiSDL.updateFontSettings(settingsDialog.getModifiedSettings());
     }
-    tLastPresent = vivictpp::time::relativeTimeMicros();
+    const PlaybackState &playbackState = videoPlayback.getPlaybackState();
+    framePacer.recordPresent(
+        vivictpp::time::relativeTimeMicros(),
+        {displayState.pts, playbackState.clockPts,
+         videoPlayback.getFrameDuration(),
+         (double)playbackState.speedDen / playbackState.speedNum,
+         playbackState.playing && !playbackState.seeking});
+  }
+}
+
+// Scrub frames can only replace the current frame if they fit its texture
+bool canShowScrubFrame(const vivictpp::libav::Frame &current,
+                       const vivictpp::libav::Frame &scrubFrame) {
+  return !current.empty() && !scrubFrame.empty() &&
+         current->width == scrubFrame->width &&
+         current->height == scrubFrame->height &&
+         current->format == scrubFrame->format;
+}
+
+void vivictpp::imgui::VivictPPImGui::showScrubFrames(
+    vivictpp::time::Time pts) {
+  std::vector<vivictpp::libav::Frame> frames =
+      videoPlayback.getVideoInputs().scrubFrames(pts);
+  bool updated = false;
+  if (canShowScrubFrame(displayState.leftFrame, frames[0])) {
+    displayState.leftFrame = std::move(frames[0]);
+    updated = true;
+  }
+  if (canShowScrubFrame(displayState.rightFrame, frames[1])) {
+    displayState.rightFrame = std::move(frames[1]);
+    updated = true;
+  }
+  for (size_t i = 2; i < frames.size(); i++) {
+    if (i - 2 < displayState.extraFrames.size() &&
+        canShowScrubFrame(displayState.extraFrames[i - 2], frames[i])) {
+      displayState.extraFrames[i - 2] = std::move(frames[i]);
+      updated = true;
+    }
+  }
+  if (updated) {
+    imGuiSDL.updateTextures(displayState);
+  }
+}
+
+std::string fileNamePart(const std::string &source) {
+  std::string name = std::filesystem::path(source).stem().string();
+  for (char &c : name) {
+    if (!std::isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') {
+      c = '_';
+    }
+  }
+  return name;
+}
+
+vivictpp::video::CropRect cropRect(const vivictpp::libav::Frame &frame,
+                                   const vivictpp::ui::VisibleRect &rect) {
+  int x0 = std::clamp((int)(rect.x0 * frame->width), 0, frame->width);
+  int y0 = std::clamp((int)(rect.y0 * frame->height), 0, frame->height);
+  int x1 = std::clamp((int)(rect.x1 * frame->width + 0.5f), x0, frame->width);
+  int y1 =
+      std::clamp((int)(rect.y1 * frame->height + 0.5f), y0, frame->height);
+  return {x0, y0, x1 - x0, y1 - y0};
+}
+
+std::filesystem::path
+vivictpp::imgui::VivictPPImGui::exportPath(size_t input,
+                                           vivictpp::time::Time pts) {
+  std::string side;
+  std::string source;
+  if (input == 0) {
+    side = "left";
+    source = displayState.leftVideoMetadata.source;
+  } else if (input == 1) {
+    side = "right";
+    source = displayState.rightVideoMetadata.source;
+  } else {
+    side = fmt::format("input{}", input + 1);
+    if (input - 2 < displayState.extraVideoMetadata.size()) {
+      source = displayState.extraVideoMetadata[input - 2].source;
+    }
+  }
+  vivictpp::video::ExportFormat format =
+      vivictpp::video::parseExportFormat(settings.exportFormat);
+  return std::filesystem::path(settings.exportDirectory) /
+         fmt::format("{}_{}_{:012d}.{}", side, fileNamePart(source), pts,
+                     vivictpp::video::exportFormatExtension(format));
+}
+
+void vivictpp::imgui::VivictPPImGui::exportFrames(bool visibleArea) {
+  vivictpp::video::ExportFormat format =
+      vivictpp::video::parseExportFormat(settings.exportFormat);
+  if (!displayState.leftFrame.empty()) {
+    frameExporter.submit(
+        displayState.leftFrame, exportPath(0, displayState.pts), format,
+        visibleArea ? cropRect(displayState.leftFrame,
+                               displayState.leftVisibleRect)
+                    : vivictpp::video::CropRect{});
+  }
+  if (!displayState.rightFrame.empty()) {
+    frameExporter.submit(
+        displayState.rightFrame, exportPath(1, displayState.pts), format,
+        visibleArea ? cropRect(displayState.rightFrame,
+                               displayState.rightVisibleRect)
+                    : vivictpp::video::CropRect{});
+  }
+  // Inputs only shown in the grid layout have no visible area
+  for (size_t i = 0; !visibleArea && i < displayState.extraFrames.size();
+       i++) {
+    if (!displayState.extraFrames[i].empty()) {
+      frameExporter.submit(displayState.extraFrames[i],
+                           exportPath(i + 2, displayState.pts), format);
+    }
+  }
+}
+
+void vivictpp::imgui::VivictPPImGui::exportRange() {
+  if (videoPlayback.isExporting()) {
+    videoPlayback.stopExport();
+    spdlog::info("Export cancelled");
+    return;
+  }
+  if (vivictpp::time::isNoPts(exportRangeStart)) {
+    exportRangeStart = displayState.pts;
+    spdlog::info("Export range starts at {}",
+                 vivictpp::time::formatTime(exportRangeStart));
+    return;
+  }
+  vivictpp::time::Time from = std::min(exportRangeStart, displayState.pts);
+  vivictpp::time::Time to = std::max(exportRangeStart, displayState.pts);
+  exportRangeStart = vivictpp::time::NO_TIME;
+  spdlog::info("Exporting frames from {} to {}",
+               vivictpp::time::formatTime(from),
+               vivictpp::time::formatTime(to));
+  videoPlayback.startExport(from, to);
+}
+
+void vivictpp::imgui::VivictPPImGui::submitExportFrames() {
+  // Enough to keep the encoding threads busy, more would only hold frames in
+  // memory
+  const size_t maxPending =
+      4 * (size_t)vivictpp::video::FrameExporter::defaultThreadCount();
+  size_t pending = frameExporter.pending();
+  std::vector<vivictpp::ExportFrame> frames = videoPlayback.takeExportFrames(
+      pending < maxPending ? maxPending - pending : 0);
+  vivictpp::video::ExportFormat format =
+      vivictpp::video::parseExportFormat(settings.exportFormat);
+  for (auto &frame : frames) {
+    frameExporter.submit(frame.frame, exportPath(frame.input, frame.pts),
+                         format);
+  }
+  if (!videoPlayback.isExporting()) {
+    spdlog::info("All frames of the range exported, {} images left to write",
+                 frameExporter.pending());
+  }
+}
+
+vivictpp::video::DifferenceMode
+nextDifferenceMode(vivictpp::video::DifferenceMode mode) {
+  switch (mode) {
+  case vivictpp::video::DifferenceMode::OFF:
+    return vivictpp::video::DifferenceMode::DIFFERENCE;
+  case vivictpp::video::DifferenceMode::DIFFERENCE:
+    return vivictpp::video::DifferenceMode::HEATMAP;
+  default:
+    return vivictpp::video::DifferenceMode::OFF;
   }
 }
 
@@ -201,8 +465,24 @@ vivictpp::imgui::Action vivictpp::imgui::VivictPPImGui::handleKeyEvent(
         return {vivictpp::imgui::ToggleFullscreen};
       }
     case 'T':
+      if (keyEvent.isShift())
+        return {vivictpp::imgui::TogglePresentationStats};
       return {vivictpp::imgui::ToggleDisplayTime};
       break;
+    case 'H':
+      return {vivictpp::imgui::TogglePerformanceHud};
+    case 'G':
+      return {vivictpp::imgui::ToggleGridLayout};
+    case 'X':
+      return {vivictpp::imgui::CycleDifferenceMode};
+    case 'E':
+      if (keyEvent.isCtrl())
+        return {vivictpp::imgui::ExportRange};
+      else if (keyEvent.isShift())
+        return {vivictpp::imgui::ExportVisibleArea};
+      else if (keyEvent.noModifiers())
+        return {vivictpp::imgui::ExportFrames};
+      break;
     case 'D':
       if (keyEvent.shift)
         return {vivictpp::imgui::ToggleImGuiDemo};
@@ -292,15 +572,28 @@ void vivictpp::imgui::VivictPPImGui::handleActions(
                                displayState.zoom);
       break;
     case ActionType::Seek:
+      scrubbing = false;
+      videoPlayback.getVideoInputs().setScrubbing(false);
+      videoPlayback.stopExport();
       videoPlayback.seek(action.seek);
       break;
+    case ActionType::Scrub:
+      if (!scrubbing) {
+        videoPlayback.getVideoInputs().setScrubbing(true);
+      }
+      scrubbing = true;
+      showScrubFrames(action.seek);
+      break;
     case ActionType::SeekRelative:
+      videoPlayback.stopExport();
       videoPlayback.seekRelative(action.seek);
       break;
     case ActionType::StepForward:
+      videoPlayback.stopExport();
       videoPlayback.seekRelativeFrame(1);
       break;
     case ActionType::StepBackward:
+      videoPlayback.stopExport();
       videoPlayback.seekRelativeFrame(-1);
       break;
     case ActionType::ToggleFullscreen:
@@ -363,10 +656,42 @@ void vivictpp::imgui::VivictPPImGui::handleActions(
       settings = settingsDialog.getSettings();
       vivictpp::saveSettings(settings);
       vivictpp::logging::setLogLevels(settings.logLevels);
+      videoPlayback.setOverloadPolicy(
+          vivictpp::parseOverloadPolicy(settings.overloadPolicy));
+      videoPlayback.getVideoInputs().setStandbyDecoders(
+          settings.standbyDecoders);
       break;
     case ActionType::ShowLogs:
       displayState.displayLogs = !displayState.displayLogs;
       break;
+    case ActionType::TogglePresentationStats:
+      displayState.displayPresentationStats =
+          !displayState.displayPresentationStats;
+      break;
+    case ActionType::TogglePerformanceHud:
+      displayState.displayPerformanceHud = !displayState.displayPerformanceHud;
+      break;
+    case ActionType::ToggleGridLayout:
+      displayState.gridLayout = !displayState.gridLayout;
+      // Extra frames are not uploaded while the grid layout is hidden
+      imGuiSDL.updateVisibleRegion(displayState);
+      break;
+    case ActionType::CycleDifferenceMode:
+      displayState.differenceMode = nextDifferenceMode(
+          displayState.differenceMode);
+      // The image of the previous mode must not be shown while the new one
+      // is computed
+      imGuiSDL.getVideoTextures().clearDifference();
+      break;
+    case ActionType::ExportFrames:
+      exportFrames(false);
+      break;
+    case ActionType::ExportVisibleArea:
+      exportFrames(true);
+      break;
+    case ActionType::ExportRange:
+      exportRange();
+      break;
     case ActionType::ShowQualityFileDialogLeft:
       qualityFileDialog.openLeft(displayState.leftVideoMetadata.source);
       break;
@@ -386,6 +711,11 @@ void vivictpp::imgui::VivictPPImGui::handleActions(
 
 void vivictpp::imgui::VivictPPImGui::openFile(
     const vivictpp::imgui::Action &action) {
+  if (videoPlayback.isOpening()) {
+    spdlog::warn("Can not open {} while other files are being opened",
+                 action.file);
+    return;
+  }
   std::vector<std::string> hwAccels;
   if (fileDialog.selectedHwAccel() == "auto") {
     hwAccels = settings.hwAccels;
@@ -398,14 +728,21 @@ void vivictpp::imgui::VivictPPImGui::openFile(
   } else {
     preferredDecoders.push_back(fileDialog.selectedDecoder());
   }
+  std::string formatOptions = fileDialog.formatOptions();
+  if (settings.fastProbe) {
+    formatOptions = vivictpp::libav::withProbeLimits(
+        formatOptions, settings.probeSizeKb, settings.analyzeDurationMs);
+  }
   SourceConfig sourceConfig = {action.file, hwAccels, preferredDecoders,
-                               fileDialog.filter(), fileDialog.formatOptions()};
+                               fileDialog.filter(), formatOptions};
   if (action.type == ActionType::OpenFileLeft) {
     videoPlayback.setLeftSource(sourceConfig);
   } else {
     videoPlayback.setRightSource(sourceConfig);
     displayState.splitScreenDisabled = false;
   }
+  differenceWorker.clear();
+  imGuiSDL.getVideoTextures().clearDifference();
   displayState.updateFrames(videoPlayback.getVideoInputs().firstFrames());
   displayState.updateMetadata(videoPlayback.getVideoInputs().metadata());
   displayState.updateDecoderMetadata(
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "libav/CachedIO.hh"
+#include "libav/AVErrorUtils.hh"
+#include "libav/SegmentCache.hh"
+#include "logging/Logging.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+const int IO_BUFFER_SIZE = 32 * 1024;
+
+// The part of a cached file read by one AVIOContext, byte ranges of HLS
+// segments are read as if they were the whole file. Demuxers look up options
+// such as cookies on the opaque of an AVIOContext, so it starts with a class.
+struct CachedFile {
+  const AVClass *avClass;
+  vivictpp::libav::SegmentCache::Data data;
+  int64_t begin;
+  int64_t end;
+  int64_t pos;
+  // Protocol options of the input, used for the files the demuxer opens
+  std::string requestOptions;
+};
+
+const AVClass cachedFileClass = {"CachedFile", av_default_item_name, nullptr,
+                                 LIBAVUTIL_VERSION_INT};
+
+int (*defaultIoOpen)(AVFormatContext *s, AVIOContext **pb, const char *url,
+                     int flags, AVDictionary **options);
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+int (*defaultIoClose2)(AVFormatContext *s, AVIOContext *pb);
+#else
+void (*defaultIoClose)(AVFormatContext *s, AVIOContext *pb);
+#endif
+
+vivictpp::logging::Logger logger() {
+  static vivictpp::logging::Logger logger =
+      vivictpp::logging::getOrCreateLogger("vivictpp::libav::SegmentCache");
+  return logger;
+}
+
+bool isRemote(const std::string &url) {
+  return url.compare(0, 7, "http://") == 0 ||
+         url.compare(0, 8, "https://") == 0;
+}
+
+int interrupted(void *opaque) {
+  return static_cast<const std::atomic_bool *>(opaque)->load();
+}
+
+vivictpp::libav::SegmentCache::Data
+download(const vivictpp::libav::SegmentCache::Request &request) {
+  const std::string &url = request.url;
+  VPP_LOG_DEBUG(logger(), "Downloading {}", url);
+  AVIOContext *io = nullptr;
+  AVIOInterruptCB interruptCallback = {
+      interrupted, const_cast<std::atomic_bool *>(request.cancelled)};
+  // Headers, cookies and the like, avio_open2 removes the ones it uses
+  AVDictionary *options = nullptr;
+  av_dict_parse_string(&options, request.options.c_str(), "=", ":", 0);
+  vivictpp::libav::AVResult result = avio_open2(
+      &io, url.c_str(), AVIO_FLAG_READ, &interruptCallback, &options);
+  av_dict_free(&options);
+  result.throwOnError("Failed to open " + url);
+  auto data = std::make_shared<std::vector<uint8_t>>();
+  int64_t size = avio_size(io);
+  if (size > 0) {
+    data->reserve(size);
+  }
+  std::vector<uint8_t> buffer(IO_BUFFER_SIZE);
+  int n = 0;
+  while (!*request.cancelled &&
+         (n = avio_read(io, buffer.data(), buffer.size())) > 0) {
+    data->insert(data->end(), buffer.begin(), buffer.begin() + n);
+  }
+  avio_closep(&io);
+  if (*request.cancelled) {
+    throw std::runtime_error("Cancelled download of " + url);
+  }
+  if (n < 0 && n != AVERROR_EOF) {
+    vivictpp::libav::AVResult(n).throwOnError("Failed to read " + url);
+  }
+  return data;
+}
+
+int64_t option(AVDictionary *options, const char *key, int64_t defaultValue) {
+  AVDictionaryEntry *entry = av_dict_get(options, key, nullptr, 0);
+  return entry ? std::strtoll(entry->value, nullptr, 10) : defaultValue;
+}
+
+// Options as a string that av_dict_parse_string reads back, without the
+// byte range of the file
+std::string requestOptions(AVDictionary *options) {
+  AVDictionary *copy = nullptr;
+  av_dict_copy(&copy, options, 0);
+  av_dict_set(&copy, "offset", nullptr, 0);
+  av_dict_set(&copy, "end_offset", nullptr, 0);
+  char *buffer = nullptr;
+  std::string result;
+  if (av_dict_get_string(copy, &buffer, '=', ':') >= 0 && buffer) {
+    result = buffer;
+  }
+  av_freep(&buffer);
+  av_dict_free(&copy);
+  return result;
+}
+
+int readCached(void *opaque, uint8_t *buf, int bufSize) {
+  CachedFile *file = static_cast<CachedFile *>(opaque);
+  int64_t n = std::min<int64_t>(bufSize, file->end - file->pos);
+  if (n <= 0) {
+    return AVERROR_EOF;
+  }
+  std::memcpy(buf, file->data->data() + file->pos, n);
+  file->pos += n;
+  return static_cast<int>(n);
+}
+
+int64_t seekCached(void *opaque, int64_t offset, int whence) {
+  CachedFile *file = static_cast<CachedFile *>(opaque);
+  int64_t size = file->end - file->begin;
+  int64_t target;
+  switch (whence & ~AVSEEK_FORCE) {
+  case AVSEEK_SIZE:
+    return size;
+  case SEEK_SET:
+    target = offset;
+    break;
+  case SEEK_CUR:
+    target = file->pos - file->begin + offset;
+    break;
+  case SEEK_END:
+    target = size + offset;
+    break;
+  default:
+    return AVERROR(EINVAL);
+  }
+  if (target < 0 || target > size) {
+    return AVERROR(EINVAL);
+  }
+  file->pos = file->begin + target;
+  return target;
+}
+
+int openCached(const vivictpp::libav::SegmentCache::Data &data,
+               int64_t begin, int64_t end, const std::string &requestOptions,
+               AVIOContext **pb) {
+  CachedFile *file = new CachedFile{&cachedFileClass, data,  begin,
+                                    end,              begin, requestOptions};
+  uint8_t *buffer = static_cast<uint8_t *>(av_malloc(IO_BUFFER_SIZE));
+  *pb = buffer ? avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, file,
+                                    readCached, nullptr, seekCached)
+               : nullptr;
+  if (!*pb) {
+    av_free(buffer);
+    delete file;
+    return AVERROR(ENOMEM);
+  }
+  (*pb)->seekable = AVIO_SEEKABLE_NORMAL;
+  return 0;
+}
+
+int cachedIoOpen(AVFormatContext *s, AVIOContext **pb, const char *url,
+                 int flags, AVDictionary **options) {
+  // Only the top level playlist is read through s->pb, if it was not opened
+  // by openCachedInput the input is read without the cache
+  if (!s->pb || s->pb->read_packet != readCached ||
+      (flags & AVIO_FLAG_WRITE) || !isRemote(url)) {
+    return defaultIoOpen(s, pb, url, flags, options);
+  }
+  // The demuxer only passes on the options it found on s->pb, which are
+  // those of the input
+  const std::string &inputOptions =
+      static_cast<CachedFile *>(s->pb->opaque)->requestOptions;
+  vivictpp::libav::SegmentCache::Data data;
+  try {
+    data = vivictpp::libav::sharedSegmentCache().get(url, inputOptions);
+  } catch (const std::exception &e) {
+    logger()->warn("{}", e.what());
+    return AVERROR(EIO);
+  }
+  int64_t size = data->size();
+  AVDictionary *dict = options ? *options : nullptr;
+  int64_t begin = std::clamp<int64_t>(option(dict, "offset", 0), 0, size);
+  int64_t end = option(dict, "end_offset", -1);
+  end = end < 0 ? size : std::clamp<int64_t>(end, begin, size);
+  return openCached(data, begin, end, inputOptions, pb);
+}
+
+bool closeCached(AVIOContext *pb) {
+  if (!pb || pb->read_packet != readCached) {
+    return false;
+  }
+  delete static_cast<CachedFile *>(pb->opaque);
+  av_freep(&pb->buffer);
+  avio_context_free(&pb);
+  return true;
+}
+
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+int cachedIoClose2(AVFormatContext *s, AVIOContext *pb) {
+  return closeCached(pb) ? 0 : defaultIoClose2(s, pb);
+}
+#else
+void cachedIoClose(AVFormatContext *s, AVIOContext *pb) {
+  if (!closeCached(pb)) {
+    defaultIoClose(s, pb);
+  }
+}
+#endif
+
+} // namespace
+
+vivictpp::libav::SegmentCache &vivictpp::libav::sharedSegmentCache() {
+  static vivictpp::libav::SegmentCache cache(download, {});
+  return cache;
+}
+
+bool vivictpp::libav::useSegmentCache(const std::string &inputFile,
+                                      AVDictionary *options) {
+  // A persistent connection is reused by the HLS demuxer through the
+  // URLContext of the previous segment, which a cached segment does not have
+  AVDictionaryEntry *persistent =
+      av_dict_get(options, "http_persistent", nullptr, 0);
+  if (persistent && std::strtol(persistent->value, nullptr, 10) != 0) {
+    return false;
+  }
+  return isRemote(inputFile) && SegmentCache::isPlaylist(inputFile);
+}
+
+AVIOContext *vivictpp::libav::openCachedInput(const std::string &inputFile,
+                                              AVDictionary *options) {
+  std::string inputOptions = requestOptions(options);
+  SegmentCache::Data data = sharedSegmentCache().get(inputFile, inputOptions);
+  AVIOContext *pb = nullptr;
+  AVResult result = openCached(data, 0, data->size(), inputOptions, &pb);
+  result.throwOnError("Failed to open " + inputFile);
+  return pb;
+}
+
+void vivictpp::libav::closeCachedInput(AVIOContext **pb) {
+  if (*pb) {
+    closeCached(*pb);
+    *pb = nullptr;
+  }
+}
+
+void vivictpp::libav::installSegmentCache(AVFormatContext *formatContext,
+                                          AVDictionary **options) {
+  // The defaults are the same for all format contexts
+  static std::once_flag saveDefaults;
+  std::call_once(saveDefaults, [formatContext]() {
+    defaultIoOpen = formatContext->io_open;
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+    defaultIoClose2 = formatContext->io_close2;
+#else
+    defaultIoClose = formatContext->io_close;
+#endif
+  });
+  formatContext->io_open = cachedIoOpen;
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+  formatContext->io_close2 = cachedIoClose2;
+#else
+  formatContext->io_close = cachedIoClose;
+#endif
+  // The HLS demuxer defaults to persistent connections, useSegmentCache
+  // leaves inputs that ask for one to the demuxer
+  av_dict_set(options, "http_persistent", "0", AV_DICT_DONT_OVERWRITE);
+}
@@ -5,6 +5,7 @@
 #include "libav/Decoder.hh"
 #include "libav/AVErrorUtils.hh"
 #include "libav/Utils.hh"
+#include "tracing/Tracing.hh"
 #include <set>
 
 extern "C" {
@@ -38,7 +39,7 @@ vivictpp::libav::Decoder::Decoder(AVCodecParameters *codecParameters,
       swPixelFormat(AV_PIX_FMT_NONE) {
   initCodecContext(codecParameters, decoderOptions);
   initHardwareContext(decoderOptions.hwAccels);
-  openCodec();
+  openCodec(decoderOptions.threads);
 }
 
 const AVCodec *
@@ -152,7 +153,7 @@ void vivictpp::libav::Decoder::initHardwareContext(
       }
     }
 
-    logger->debug("Decoder {} does not support device type {}.",
+    VPP_LOG_DEBUG(logger, "Decoder {} does not support device type {}.",
                   this->codecContext.get()->codec->name,
                   av_hwdevice_get_type_name(type));
   }
@@ -160,9 +161,13 @@ void vivictpp::libav::Decoder::initHardwareContext(
                this->codecContext.get()->codec->name);
 }
 
-void vivictpp::libav::Decoder::openCodec() {
+void vivictpp::libav::Decoder::openCodec(int threads) {
   AVDictionary *decoderOptions = nullptr;
-  av_dict_set(&decoderOptions, "threads", "auto", 0);
+  if (threads > 0) {
+    av_dict_set_int(&decoderOptions, "threads", threads, 0);
+  } else {
+    av_dict_set(&decoderOptions, "threads", "auto", 0);
+  }
 #if LIBAVCODEC_VERSION_MAJOR >= 60
   av_dict_set(&decoderOptions, "flags", "+copy_opaque", AV_DICT_MULTIKEY);
 #endif
@@ -190,18 +195,22 @@ void vivictpp::libav::Decoder::flush() {
 
 std::vector<vivictpp::libav::Frame>
 vivictpp::libav::Decoder::handlePacket(Packet packet) {
-  logger->trace("handlePacket");
-  vivictpp::libav::AVResult ret =
-      avcodec_send_packet(this->codecContext.get(), packet.avPacket());
+  VPP_LOG_TRACE(logger, "handlePacket");
+  vivictpp::libav::AVResult ret;
+  {
+    VPP_TRACE_SPAN("send_packet");
+    ret = avcodec_send_packet(this->codecContext.get(), packet.avPacket());
+  }
   if (ret.error() && !ret.eof()) {
     throw std::runtime_error(std::string("Send packet failed: ") +
                              ret.getMessage());
   }
   std::vector<Frame> result;
+  VPP_TRACE_SPAN("receive_frame");
   while ((ret = avcodec_receive_frame(this->codecContext.get(),
                                       nextFrame.avFrame()))
              .success()) {
-    result.push_back(nextFrame);
+    result.push_back(std::move(nextFrame));
     nextFrame.reset();
   }
   if (ret.success() || ret.eof() || ret.eagain()) {
@@ -18,6 +18,7 @@ extern "C" {
 #include <libavfilter/buffersrc.h>
 #include <libavformat/avformat.h>
 #include <libavutil/channel_layout.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libavutil/pixdesc.h>
 }
@@ -25,12 +26,41 @@ extern "C" {
 #include "libav/AVErrorUtils.hh"
 #include "libav/HwAccelUtils.hh"
 #include "libav/Utils.hh"
+#include "tracing/Tracing.hh"
+#include "video/BitDepth.hh"
 #include "spdlog/spdlog.h"
 
 int64_t getValidChannelLayout(int64_t channelLayout, int channels);
 
 void freeFilterGraph(AVFilterGraph *graph) { avfilter_graph_free(&graph); }
 
+namespace {
+
+void freeBufferPool(AVBufferPool *pool) { av_buffer_pool_uninit(&pool); }
+
+// Formats that are converted to 8 bits without libswscale
+struct BitDepthConversion {
+  AVPixelFormat output;
+  int bitDepth;
+  // Chroma is stored interleaved in a single plane
+  bool semiPlanar;
+};
+
+BitDepthConversion bitDepthConversion(AVPixelFormat format) {
+  switch (format) {
+  case AV_PIX_FMT_YUV420P10LE:
+    return {AV_PIX_FMT_YUV420P, 10, false};
+  case AV_PIX_FMT_YUV420P12LE:
+    return {AV_PIX_FMT_YUV420P, 12, false};
+  case AV_PIX_FMT_P010LE:
+    return {AV_PIX_FMT_NV12, 16, true};
+  default:
+    return {AV_PIX_FMT_NONE, 0, false};
+  }
+}
+
+} // namespace
+
 vivictpp::libav::Filter::Filter(std::string definition)
     : eof_(false), bufferSrcCtx(nullptr), bufferSinkCtx(nullptr),
       graph(nullptr), definition(definition) {}
@@ -81,6 +111,7 @@ void vivictpp::libav::Filter::createFilter(AVFilterContext **filt_ctx,
 
 vivictpp::libav::Frame
 vivictpp::libav::Filter::filterFrame(const vivictpp::libav::Frame &inFrame) {
+  VPP_TRACE_SPAN("filter");
   if (av_buffersrc_add_frame_flags(bufferSrcCtx, inFrame.avFrame(),
                                    AV_BUFFERSRC_FLAG_KEEP_REF) < 0) {
     throw std::runtime_error("Error feeding filtergraph");
@@ -95,7 +126,7 @@ vivictpp::libav::Filter::filterFrame(const vivictpp::libav::Frame &inFrame) {
   if (ret < 0) {
     throw std::runtime_error("Error getting frame from filtergraph");
   }
-  Frame frame = nextFrame;
+  Frame frame = std::move(nextFrame);
   nextFrame.reset();
   return frame;
 }
@@ -124,7 +155,55 @@ vivictpp::libav::Frame vivictpp::libav::VideoFilter::filterFrame(
     formatParameters.hwFramesContext = inFrame.avFrame()->hw_frames_ctx;
     configure();
   }
-  return Filter::filterFrame(inFrame);
+  Frame frame = Filter::filterFrame(inFrame);
+  if (reduceFrom == AV_PIX_FMT_NONE || frame.empty()) {
+    return frame;
+  }
+  return reduceBitDepth(frame);
+}
+
+vivictpp::libav::Frame
+vivictpp::libav::VideoFilter::reduceBitDepth(const Frame &frame) {
+  VPP_TRACE_SPAN("reduceBitDepth");
+  const AVFrame *in = frame.avFrame();
+  BitDepthConversion conversion =
+      bitDepthConversion(static_cast<AVPixelFormat>(in->format));
+  if (conversion.output == AV_PIX_FMT_NONE) {
+    return frame;
+  }
+  int size = av_image_get_buffer_size(conversion.output, in->width,
+                                      in->height, 64);
+  if (!bufferPool || size != bufferPoolSize) {
+    bufferPool.reset(av_buffer_pool_init(size, nullptr), &freeBufferPool);
+    bufferPoolSize = size;
+  }
+  Frame reduced;
+  AVFrame *out = reduced.avFrame();
+  out->buf[0] = av_buffer_pool_get(bufferPool.get());
+  if (!out->buf[0]) {
+    throw std::runtime_error("Failed to allocate frame buffer");
+  }
+  av_image_fill_arrays(out->data, out->linesize, out->buf[0]->data,
+                       conversion.output, in->width, in->height, 64);
+  out->format = conversion.output;
+  out->width = in->width;
+  out->height = in->height;
+  av_frame_copy_props(out, in);
+
+  int chromaWidth = AV_CEIL_RSHIFT(in->width, 1);
+  int chromaHeight = AV_CEIL_RSHIFT(in->height, 1);
+  int nPlanes = conversion.semiPlanar ? 2 : 3;
+  for (int p = 0; p < nPlanes; p++) {
+    int width = p == 0 ? in->width
+                : conversion.semiPlanar ? 2 * chromaWidth
+                                        : chromaWidth;
+    int height = p == 0 ? in->height : chromaHeight;
+    vivictpp::video::reduceBitDepth(
+        {reinterpret_cast<const uint16_t *>(in->data[p]), in->linesize[p] / 2,
+         width, height},
+        conversion.bitDepth, {out->data[p], out->linesize[p], width, height});
+  }
+  return reduced;
 }
 
 void vivictpp::libav::VideoFilter::configure() {
@@ -171,8 +250,22 @@ void vivictpp::libav::VideoFilter::configure() {
     }
   }
 
+  // Without a custom filter, frames that only need their bit depth reduced
+  // are converted after the graph, which is much faster than the swscale
+  // conversion done by the format filter
+  AVPixelFormat graphFormat = hwDownloadFormat != AV_PIX_FMT_NONE
+                                  ? hwDownloadFormat
+                                  : formatParameters.pixelFormat;
+  reduceFrom = AV_PIX_FMT_NONE;
+  if (definition == "null" && hwFilter.empty() &&
+      bitDepthConversion(graphFormat).output == outputFormat) {
+    reduceFrom = graphFormat;
+  }
+  AVPixelFormat sinkFormat =
+      reduceFrom != AV_PIX_FMT_NONE ? reduceFrom : outputFormat;
+
   enum AVPixelFormat pix_fmts[] = {AV_PIX_FMT_NV12, AV_PIX_FMT_NONE};
-  pix_fmts[0] = outputFormat;
+  pix_fmts[0] = sinkFormat;
 
   snprintf(args, sizeof(args),
            "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=%d/%d",
@@ -209,7 +302,7 @@ void vivictpp::libav::VideoFilter::configure() {
                  av_get_pix_fmt_name(hwDownloadFormat) + ",";
   }
 
-  filterStr += std::string("format=") + av_get_pix_fmt_name(outputFormat);
+  filterStr += std::string("format=") + av_get_pix_fmt_name(sinkFormat);
 
   if (!definition.empty()) {
     filterStr += std::string(",") + definition;
@@ -4,13 +4,66 @@
 
 #include "libav/FormatHandler.hh"
 #include "libav/AVErrorUtils.hh"
+#include "libav/CachedIO.hh"
+#include "libav/ProbeCache.hh"
+#include "time/TimeUtils.hh"
+#include "tracing/Tracing.hh"
 
 #include "spdlog/spdlog.h"
 
+#include <filesystem>
 #include <iostream>
 #include <libavutil/dict.h>
 #include <string>
 
+namespace {
+
+vivictpp::libav::ProbeCache &probeCache() {
+  static vivictpp::libav::ProbeCache cache;
+  return cache;
+}
+
+// Local files that change on disk must be probed again
+std::string probeCacheKey(const std::string &inputFile,
+                          const std::string &formatOptions) {
+  std::string key = inputFile + "\n" + formatOptions;
+  std::error_code ec;
+  auto modified = std::filesystem::last_write_time(inputFile, ec);
+  if (!ec) {
+    key += "\n" + std::to_string(modified.time_since_epoch().count());
+  }
+  return key;
+}
+
+bool hasOption(const std::string &formatOptions, const std::string &key) {
+  size_t pos = 0;
+  while ((pos = formatOptions.find(key + "=", pos)) != std::string::npos) {
+    if (pos == 0 || formatOptions[pos - 1] == ':') {
+      return true;
+    }
+    pos++;
+  }
+  return false;
+}
+
+} // namespace
+
+std::string vivictpp::libav::withProbeLimits(const std::string &formatOptions,
+                                             int probeSizeKb,
+                                             int analyzeDurationMs) {
+  std::string result = formatOptions;
+  auto add = [&result](const std::string &keyValue) {
+    result += (result.empty() ? "" : ":") + keyValue;
+  };
+  if (!hasOption(formatOptions, "probesize")) {
+    add("probesize=" + std::to_string((int64_t)probeSizeKb * 1024));
+  }
+  if (!hasOption(formatOptions, "analyzeduration")) {
+    add("analyzeduration=" + std::to_string((int64_t)analyzeDurationMs * 1000));
+  }
+  return result;
+}
+
 void parseFormatOptions(std::string formatOptions, std::string &format,
                         AVDictionary **options) {
   if (formatOptions.empty()) {
@@ -58,17 +111,47 @@ vivictpp::libav::FormatHandler::FormatHandler(std::string inputFile,
     throw std::runtime_error(std::string("Unknown format: ") + format);
   }
 
+  if (useSegmentCache(this->inputFile, options)) {
+    if (!(this->formatContext = avformat_alloc_context())) {
+      av_dict_free(&options);
+      throw std::runtime_error("Failed to allocate format context");
+    }
+    installSegmentCache(this->formatContext, &options);
+    try {
+      cachedInput = openCachedInput(this->inputFile, options);
+    } catch (const std::exception &e) {
+      avformat_free_context(this->formatContext);
+      av_dict_free(&options);
+      throw std::runtime_error(std::string("Failed to open input: ") +
+                               e.what());
+    }
+    this->formatContext->pb = cachedInput;
+  }
   vivictpp::libav::AVResult result = avformat_open_input(
       &this->formatContext, this->inputFile.c_str(), inputFormat, &options);
   av_dict_free(&options);
   if (result.error()) {
+    closeCachedInput(&cachedInput);
     throw std::runtime_error(std::string("Failed to open input: ") +
                              result.getMessage());
   }
 
-  // Retrieve stream information
-  if (avformat_find_stream_info(formatContext, nullptr) < 0) {
-    throw std::runtime_error("Failed to find stream info");
+  // Retrieve stream information, the same input is usually opened more than
+  // once
+  std::string cacheKey = probeCacheKey(this->inputFile, formatOptions);
+  if (probeCache().lookup(cacheKey, formatContext)) {
+    VPP_LOG_DEBUG(logger, "Using cached stream info for {}", this->inputFile);
+  } else {
+    int64_t t0 = vivictpp::time::relativeTimeMicros();
+    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+      probeCache().abandon(cacheKey);
+      avformat_close_input(&this->formatContext);
+      closeCachedInput(&cachedInput);
+      throw std::runtime_error("Failed to find stream info");
+    }
+    probeCache().store(cacheKey, formatContext);
+    VPP_LOG_DEBUG(logger, "Found stream info for {} in {} ms", this->inputFile,
+                  (vivictpp::time::relativeTimeMicros() - t0) / 1000);
   }
 
   // Dump information about file onto standard error
@@ -95,6 +178,7 @@ vivictpp::libav::FormatHandler::~FormatHandler() {
   if (formatContext) {
     avformat_close_input(&this->formatContext);
   }
+  closeCachedInput(&cachedInput);
   if (packet) {
     av_packet_unref(packet);
   }
@@ -112,7 +196,8 @@ void vivictpp::libav::FormatHandler::setActiveStreams(
 }
 
 void vivictpp::libav::FormatHandler::setStreamActive(int streamIndex) {
-  logger->debug("FormatHandler::setStreamActive streamIndex={}", streamIndex);
+  VPP_LOG_DEBUG(logger, "FormatHandler::setStreamActive streamIndex={}",
+                streamIndex);
   this->formatContext->streams[streamIndex]->discard = AVDISCARD_DEFAULT;
   activeStreams.insert(streamIndex);
 }
@@ -172,9 +257,11 @@ void vivictpp::libav::FormatHandler::seek(vivictpp::time::Time t) {
 }
 
 AVPacket *vivictpp::libav::FormatHandler::nextPacket() {
+  VPP_TRACE_SPAN("demux");
   vivictpp::libav::AVResult ret;
   while ((ret = av_read_frame(this->formatContext, this->packet)).success()) {
-    logger->debug("FormatHandler::nextPacket  Got packet: pts={} dts={} "
+    VPP_LOG_DEBUG(logger,
+                  "FormatHandler::nextPacket  Got packet: pts={} dts={} "
                   "stream_index={} keyframe={}",
                   this->packet->pts, this->packet->dts,
                   this->packet->stream_index,
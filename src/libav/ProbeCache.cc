@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "libav/ProbeCache.hh"
+
+namespace {
+
+void freeCodecParameters(AVCodecParameters *codecpar) {
+  avcodec_parameters_free(&codecpar);
+}
+
+bool sameRational(AVRational a, AVRational b) {
+  return a.num == b.num && a.den == b.den;
+}
+
+} // namespace
+
+bool vivictpp::libav::ProbeCache::lookup(const std::string &key,
+                                         AVFormatContext *formatContext) {
+  std::unique_lock<std::mutex> lock(m);
+  probeDone.wait(lock, [&]() { return probing.count(key) == 0; });
+  auto it = entries.find(key);
+  if (it != entries.end() && matches(it->second, formatContext)) {
+    apply(it->second, formatContext);
+    return true;
+  }
+  probing.insert(key);
+  return false;
+}
+
+void vivictpp::libav::ProbeCache::store(const std::string &key,
+                                        const AVFormatContext *formatContext) {
+  Entry entry{formatContext->start_time, formatContext->duration,
+              formatContext->bit_rate, {}};
+  for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+    const AVStream *stream = formatContext->streams[i];
+    std::shared_ptr<AVCodecParameters> codecpar(avcodec_parameters_alloc(),
+                                                freeCodecParameters);
+    if (!codecpar ||
+        avcodec_parameters_copy(codecpar.get(), stream->codecpar) < 0) {
+      abandon(key);
+      return;
+    }
+    entry.streams.push_back({codecpar, stream->time_base,
+                             stream->avg_frame_rate, stream->r_frame_rate,
+                             stream->sample_aspect_ratio, stream->start_time,
+                             stream->duration, stream->nb_frames});
+  }
+  {
+    std::lock_guard<std::mutex> lock(m);
+    entries[key] = entry;
+    probing.erase(key);
+  }
+  probeDone.notify_all();
+}
+
+void vivictpp::libav::ProbeCache::abandon(const std::string &key) {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    probing.erase(key);
+  }
+  probeDone.notify_all();
+}
+
+size_t vivictpp::libav::ProbeCache::size() {
+  std::lock_guard<std::mutex> lock(m);
+  return entries.size();
+}
+
+bool vivictpp::libav::ProbeCache::matches(
+    const Entry &entry, const AVFormatContext *formatContext) {
+  // Demuxers that find their streams while reading packets may not have
+  // created all of them yet, such inputs are probed again
+  if (entry.streams.size() != formatContext->nb_streams) {
+    return false;
+  }
+  for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+    const AVStream *stream = formatContext->streams[i];
+    const StreamInfo &info = entry.streams[i];
+    if (stream->codecpar->codec_type != info.codecpar->codec_type ||
+        stream->codecpar->codec_id != info.codecpar->codec_id ||
+        !sameRational(stream->time_base, info.timeBase)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void vivictpp::libav::ProbeCache::apply(const Entry &entry,
+                                        AVFormatContext *formatContext) {
+  formatContext->start_time = entry.startTime;
+  formatContext->duration = entry.duration;
+  formatContext->bit_rate = entry.bitRate;
+  for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+    AVStream *stream = formatContext->streams[i];
+    const StreamInfo &info = entry.streams[i];
+    avcodec_parameters_copy(stream->codecpar, info.codecpar.get());
+    stream->avg_frame_rate = info.avgFrameRate;
+    stream->r_frame_rate = info.rFrameRate;
+    stream->sample_aspect_ratio = info.sampleAspectRatio;
+    stream->start_time = info.startTime;
+    stream->duration = info.duration;
+    stream->nb_frames = info.nbFrames;
+  }
+}
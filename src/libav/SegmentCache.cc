@@ -0,0 +1,360 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "libav/SegmentCache.hh"
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+namespace {
+
+std::string withoutQuery(const std::string &url) {
+  return url.substr(0, url.find('?'));
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool startsWith(const std::string &s, const std::string &prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+std::filesystem::path defaultSpillDir() {
+  std::error_code ec;
+  std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+  if (ec) {
+    tmp = ".";
+  }
+  std::random_device random;
+  std::ostringstream name;
+  name << "vivictpp-segments-" << std::hex << random() << random();
+  return tmp / name.str();
+}
+
+} // namespace
+
+vivictpp::libav::SegmentCache::SegmentCache(Fetcher fetcher, Options options)
+    : fetcher(fetcher), options(options) {
+  if (this->options.spillDir.empty()) {
+    this->options.spillDir = defaultSpillDir();
+  }
+}
+
+vivictpp::libav::SegmentCache::~SegmentCache() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    stop = true;
+    // Interrupts a prefetch in progress
+    cancelled = true;
+  }
+  changed.notify_all();
+  if (prefetchThread.joinable()) {
+    prefetchThread.join();
+  }
+  if (spillCounter > 0) {
+    std::error_code ec;
+    std::filesystem::remove_all(options.spillDir, ec);
+  }
+}
+
+bool vivictpp::libav::SegmentCache::isPlaylist(const std::string &url) {
+  std::string path = withoutQuery(url);
+  return endsWith(path, ".m3u8") || endsWith(path, ".m3u") ||
+         endsWith(path, ".mpd");
+}
+
+std::string vivictpp::libav::SegmentCache::resolve(
+    const std::string &playlistUrl, const std::string &uri) {
+  if (uri.find("://") != std::string::npos) {
+    return uri;
+  }
+  std::string base = withoutQuery(playlistUrl);
+  if (startsWith(uri, "/")) {
+    size_t schemeEnd = base.find("://");
+    size_t hostEnd = base.find(
+        '/', schemeEnd == std::string::npos ? 0 : schemeEnd + 3);
+    return base.substr(0, hostEnd) + uri;
+  }
+  return base.substr(0, base.rfind('/') + 1) + uri;
+}
+
+vivictpp::libav::SegmentCache::Data
+vivictpp::libav::SegmentCache::get(const std::string &url,
+                                   const std::string &requestOptions) {
+  std::unique_lock<std::mutex> lock(m);
+  Data data = fetch(url, requestOptions, lock);
+  schedulePrefetch(url);
+  return data;
+}
+
+void vivictpp::libav::SegmentCache::setFetcher(Fetcher fetcher) {
+  std::lock_guard<std::mutex> lock(m);
+  this->fetcher = fetcher;
+}
+
+vivictpp::libav::SegmentCache::Data
+vivictpp::libav::SegmentCache::fetch(const std::string &url,
+                                     const std::string &requestOptions,
+                                     std::unique_lock<std::mutex> &lock) {
+  // Another thread may be downloading the same url, for instance the
+  // prefetcher or the handler indexing the same input
+  changed.wait(lock, [&]() { return inFlight.count(url) == 0; });
+  auto it = entries.find(url);
+  if (it != entries.end()) {
+    Entry &entry = it->second;
+    lru.splice(lru.begin(), lru, entry.lruPos);
+    return load(entry);
+  }
+  inFlight.insert(url);
+  Fetcher currentFetcher = fetcher;
+  lock.unlock();
+  Data data;
+  try {
+    data = currentFetcher({url, requestOptions, &cancelled});
+  } catch (...) {
+    lock.lock();
+    inFlight.erase(url);
+    changed.notify_all();
+    throw;
+  }
+  lock.lock();
+  inFlight.erase(url);
+  fetches++;
+  // Playlists of live streams change and must be downloaded every time
+  if (!isPlaylist(url) || parsePlaylist(url, requestOptions, data)) {
+    insert(url, data);
+  }
+  changed.notify_all();
+  return data;
+}
+
+vivictpp::libav::SegmentCache::Data
+vivictpp::libav::SegmentCache::load(Entry &entry) {
+  if (entry.data) {
+    return entry.data;
+  }
+  std::ifstream in(entry.spillFile, std::ios::binary);
+  auto data = std::make_shared<std::vector<uint8_t>>(
+      std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  std::error_code ec;
+  std::filesystem::remove(entry.spillFile, ec);
+  entry.spillFile.clear();
+  _diskBytes -= entry.size;
+  entry.data = data;
+  _memoryBytes += entry.size;
+  evict();
+  return data;
+}
+
+void vivictpp::libav::SegmentCache::insert(const std::string &url,
+                                           const Data &data) {
+  lru.push_front(url);
+  Entry &entry = entries[url];
+  entry.data = data;
+  entry.size = data->size();
+  entry.lruPos = lru.begin();
+  _memoryBytes += entry.size;
+  evict();
+}
+
+void vivictpp::libav::SegmentCache::evict() {
+  // The most recently used entry is always kept in memory, it is about to be
+  // read
+  std::vector<std::string> toSpill;
+  size_t memory = _memoryBytes;
+  for (auto pos = lru.rbegin();
+       memory > options.memoryBytes && std::next(pos) != lru.rend(); ++pos) {
+    const Entry &entry = entries[*pos];
+    if (entry.data) {
+      toSpill.push_back(*pos);
+      memory -= entry.size;
+    }
+  }
+  for (const std::string &url : toSpill) {
+    auto it = entries.find(url);
+    Entry &entry = it->second;
+    std::filesystem::path file =
+        options.spillDir / (std::to_string(spillCounter++) + ".seg");
+    std::error_code ec;
+    std::filesystem::create_directories(options.spillDir, ec);
+    std::ofstream out(file, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(entry.data->data()),
+              entry.data->size());
+    out.close();
+    if (entry.size > options.diskBytes || !out) {
+      std::filesystem::remove(file, ec);
+      erase(it);
+      continue;
+    }
+    entry.data.reset();
+    entry.spillFile = file;
+    _memoryBytes -= entry.size;
+    _diskBytes += entry.size;
+  }
+
+  std::vector<std::string> toErase;
+  size_t disk = _diskBytes;
+  for (auto pos = lru.rbegin(); disk > options.diskBytes && pos != lru.rend();
+       ++pos) {
+    const Entry &entry = entries[*pos];
+    if (!entry.data) {
+      toErase.push_back(*pos);
+      disk -= entry.size;
+    }
+  }
+  for (const std::string &url : toErase) {
+    erase(entries.find(url));
+  }
+}
+
+void vivictpp::libav::SegmentCache::erase(
+    std::map<std::string, Entry>::iterator it) {
+  Entry &entry = it->second;
+  if (entry.data) {
+    _memoryBytes -= entry.size;
+  } else {
+    std::error_code ec;
+    std::filesystem::remove(entry.spillFile, ec);
+    _diskBytes -= entry.size;
+  }
+  lru.erase(entry.lruPos);
+  entries.erase(it);
+}
+
+bool vivictpp::libav::SegmentCache::parsePlaylist(
+    const std::string &url, const std::string &requestOptions,
+    const Data &data) {
+  std::string text(data->begin(), data->end());
+  if (endsWith(withoutQuery(url), ".mpd")) {
+    // Segments of DASH manifests are usually given by templates, so they are
+    // only cached when requested, not prefetched
+    return text.find("type=\"dynamic\"") == std::string::npos;
+  }
+  std::vector<std::string> uris;
+  bool endList = false;
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == '#') {
+      endList = endList || startsWith(line, "#EXT-X-ENDLIST");
+      continue;
+    }
+    std::string uri = resolve(url, line);
+    if (!isPlaylist(uri)) {
+      uris.push_back(uri);
+    }
+  }
+  // Live playlists are read again and again
+  forgetPlaylist(url);
+  size_t bytes = url.size();
+  for (size_t i = 0; i < uris.size(); i++) {
+    segments[uris[i]] = {url, i};
+    bytes += uris[i].size();
+  }
+  playlistOrder.push_back(url);
+  playlists[url] = {uris, requestOptions, bytes,
+                    std::prev(playlistOrder.end())};
+  indexBytes += bytes;
+  while (indexBytes > options.indexBytes && playlistOrder.size() > 1) {
+    forgetPlaylist(playlistOrder.front());
+  }
+  // A master playlist only lists other playlists
+  return endList || uris.empty();
+}
+
+void vivictpp::libav::SegmentCache::forgetPlaylist(const std::string &url) {
+  auto it = playlists.find(url);
+  if (it == playlists.end()) {
+    return;
+  }
+  for (const std::string &uri : it->second.uris) {
+    auto segment = segments.find(uri);
+    // The segment may also be in a playlist read later
+    if (segment != segments.end() && segment->second.playlist == url) {
+      segments.erase(segment);
+    }
+  }
+  indexBytes -= it->second.bytes;
+  playlistOrder.erase(it->second.orderPos);
+  playlists.erase(it);
+}
+
+void vivictpp::libav::SegmentCache::schedulePrefetch(const std::string &url) {
+  auto it = segments.find(url);
+  if (it == segments.end() || options.lookahead <= 0) {
+    return;
+  }
+  // Only prefetch around the latest request, earlier ones are obsolete
+  // after a seek
+  prefetchQueue.clear();
+  const std::vector<std::string> &uris =
+      playlists[it->second.playlist].uris;
+  for (size_t i = it->second.index + 1;
+       i < uris.size() && i <= it->second.index + options.lookahead; i++) {
+    if (entries.count(uris[i]) == 0 && inFlight.count(uris[i]) == 0) {
+      prefetchQueue.push_back(uris[i]);
+    }
+  }
+  if (prefetchQueue.empty()) {
+    return;
+  }
+  if (!prefetchThread.joinable()) {
+    prefetchThread = std::thread(&SegmentCache::prefetchLoop, this);
+  }
+  changed.notify_all();
+}
+
+void vivictpp::libav::SegmentCache::prefetchLoop() {
+  std::unique_lock<std::mutex> lock(m);
+  while (!stop) {
+    if (prefetchQueue.empty()) {
+      changed.wait(lock);
+      continue;
+    }
+    std::string url = prefetchQueue.front();
+    prefetchQueue.pop_front();
+    auto segment = segments.find(url);
+    if (entries.count(url) != 0 || inFlight.count(url) != 0 ||
+        segment == segments.end()) {
+      continue;
+    }
+    std::string requestOptions =
+        playlists[segment->second.playlist].requestOptions;
+    try {
+      fetch(url, requestOptions, lock);
+    } catch (...) {
+      // Fetched again when requested
+    }
+  }
+}
+
+size_t vivictpp::libav::SegmentCache::fetchCount() {
+  std::lock_guard<std::mutex> lock(m);
+  return fetches;
+}
+
+size_t vivictpp::libav::SegmentCache::memoryBytes() {
+  std::lock_guard<std::mutex> lock(m);
+  return _memoryBytes;
+}
+
+size_t vivictpp::libav::SegmentCache::diskBytes() {
+  std::lock_guard<std::mutex> lock(m);
+  return _diskBytes;
+}
+
+bool vivictpp::libav::SegmentCache::contains(const std::string &url) {
+  std::lock_guard<std::mutex> lock(m);
+  return entries.count(url) != 0;
+}
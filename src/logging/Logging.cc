@@ -41,6 +41,7 @@ static const std::vector<std::string> loggers{
     "vivictpp::workers::DecoderWorker",
     "vivictpp::workers::PacketWorker",
     "vivictpp::libav::FormatHandler",
+    "vivictpp::libav::SegmentCache",
     "vivictpp::seeklog",
     "vivictpp::libav::Decoder",
     "SeekState",
@@ -48,6 +49,10 @@ static const std::vector<std::string> loggers{
     "vivictpp::VideoPlayback",
     "vivictpp::workers::FrameBuffer",
     "vivictpp::video::VideoIndexer",
+    "vivictpp::video::ScrubCache",
+    "vivictpp::video::ThumbnailGenerator",
+    "vivictpp::video::DifferenceWorker",
+    "vivictpp::video::FrameExporter",
     "libav",
     "vivictpp::qualityMetrics::QualityMetrics"};
 
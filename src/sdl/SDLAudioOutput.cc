@@ -12,54 +12,115 @@ extern "C" {
 }
 
 #include "spdlog/spdlog.h"
+#include "time/TimeUtils.hh"
+#include <algorithm>
+#include <cstring>
 #include <exception>
 
 vivictpp::sdl::SDLAudioOutput::SDLAudioOutput(AVCodecContext *codecContext)
-    : sampleFormat(codecContext->sample_fmt),
+    : sampleFormat(AV_SAMPLE_FMT_S16),
       channels(vivictpp::libav::getChannels(codecContext)),
-      bytesPerSample(av_get_bytes_per_sample(sampleFormat) * channels) {
+      bytesPerSample(av_get_bytes_per_sample(sampleFormat) * channels),
+      ringBuffer(std::make_unique<vivictpp::audio::AudioRingBuffer>(
+          (size_t)codecContext->sample_rate * bytesPerSample *
+          RING_BUFFER_MILLIS / 1000)) {
+  // Frames are converted to s16 by the audio filter of the decoder
+  if (SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+    throw SDLException("Failed to initialize SDL audio");
+  }
   SDL_AudioSpec wantedSpec;
-  wantedSpec.channels = vivictpp::libav::getChannels(codecContext);
+  wantedSpec.channels = channels;
   wantedSpec.freq = codecContext->sample_rate;
   wantedSpec.format = AUDIO_S16SYS;
-  wantedSpec.samples = 1024;
+  wantedSpec.samples = 512;
   wantedSpec.silence = 0;
-  wantedSpec.callback = nullptr;
-  wantedSpec.userdata = nullptr;
+  wantedSpec.callback = &SDLAudioOutput::audioCallback;
+  wantedSpec.userdata = this;
 
-  audioDevice = SDL_OpenAudioDevice(nullptr, 0, &wantedSpec, &obtainedSpec,
-                                    SDL_AUDIO_ALLOW_FREQUENCY_CHANGE |
-                                        SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+  // Let SDL convert if the device does not support the wanted spec, so that
+  // ring buffer data and sample counts are always in the format of the frames
+  audioDevice = SDL_OpenAudioDevice(nullptr, 0, &wantedSpec, &obtainedSpec, 0);
   if (audioDevice <= 0) {
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
     throw std::runtime_error("Failed to open audio device");
   }
 }
 
 vivictpp::sdl::SDLAudioOutput::~SDLAudioOutput() {
   SDL_CloseAudioDevice(audioDevice);
+  SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+
+void vivictpp::sdl::SDLAudioOutput::audioCallback(void *userdata,
+                                                  Uint8 *stream, int len) {
+  static_cast<SDLAudioOutput *>(userdata)->fill(stream, len);
+}
+
+void vivictpp::sdl::SDLAudioOutput::fill(Uint8 *stream, int len) {
+  size_t n = ringBuffer->read(stream, len);
+  if (n < (size_t)len) {
+    std::memset(stream + n, obtainedSpec.silence, len - n);
+  }
+  uint32_t seq = clockSeq.load(std::memory_order_relaxed);
+  clockSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  clockPos.store(ringBuffer->readPosition(), std::memory_order_relaxed);
+  clockTime.store(vivictpp::time::relativeTimeMicros(),
+                  std::memory_order_relaxed);
+  clockSeq.store(seq + 2, std::memory_order_release);
 }
 
 void vivictpp::sdl::SDLAudioOutput::queueAudio(
-    const vivictpp::libav::Frame &frame) {
-  uint32_t size = (uint32_t)av_samples_get_buffer_size(
+    const vivictpp::libav::Frame &frame, vivictpp::time::Time pts) {
+  size_t size = (size_t)av_samples_get_buffer_size(
       NULL, vivictpp::libav::getChannels(frame.avFrame()),
       frame.avFrame()->nb_samples, (AVSampleFormat)frame.avFrame()->format, 1);
-  SDL_QueueAudio(audioDevice, frame.avFrame()->data[0], size);
-  lastPts =
-      av_rescale(frame.pts(), vivictpp::time::TIME_BASE, obtainedSpec.freq);
+  if (vivictpp::time::isNoPts(basePts)) {
+    basePts = pts;
+    basePos = ringBuffer->writePosition();
+  }
+  if (ringBuffer->write(frame.avFrame()->data[0], size) < size) {
+    spdlog::warn("Audio ring buffer full, dropping samples");
+  }
 }
 
 void vivictpp::sdl::SDLAudioOutput::clearQueue() {
-  SDL_ClearQueuedAudio(audioDevice);
+  ringBuffer->flush();
+  basePts = vivictpp::time::NO_TIME;
 }
 
 vivictpp::time::Time vivictpp::sdl::SDLAudioOutput::currentPts() {
-  return lastPts - queueDuration();
+  if (vivictpp::time::isNoPts(basePts)) {
+    return vivictpp::time::NO_TIME;
+  }
+  uint32_t seq;
+  uint64_t pos;
+  int64_t time;
+  do {
+    seq = clockSeq.load(std::memory_order_acquire);
+    pos = clockPos.load(std::memory_order_relaxed);
+    time = clockTime.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != clockSeq.load(std::memory_order_relaxed));
+  if (pos <= basePos) {
+    return vivictpp::time::NO_TIME;
+  }
+  // The bytes handed over in the last callback start playing when the
+  // previous device buffer has been played, assume that takes one buffer
+  int64_t bytesPerSecond = (int64_t)obtainedSpec.freq * bytesPerSample;
+  int64_t deviceBuffer = (int64_t)obtainedSpec.samples * bytesPerSample;
+  int64_t elapsed = vivictpp::time::relativeTimeMicros() - time;
+  int64_t played =
+      (int64_t)(pos - basePos) - deviceBuffer +
+      std::min(deviceBuffer,
+               av_rescale(elapsed, bytesPerSecond, vivictpp::time::TIME_BASE));
+  played = std::max<int64_t>(0, played - played % bytesPerSample);
+  return basePts +
+         av_rescale(played, vivictpp::time::TIME_BASE, bytesPerSecond);
 }
 
 uint32_t vivictpp::sdl::SDLAudioOutput::queuedSamples() {
-  uint32_t queueSize = SDL_GetQueuedAudioSize(audioDevice);
-  return queueSize / bytesPerSample;
+  return ringBuffer->readableBytes() / bytesPerSample;
 }
 
 vivictpp::time::Time vivictpp::sdl::SDLAudioOutput::queueDuration() {
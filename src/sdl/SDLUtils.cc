@@ -31,17 +31,39 @@ vivictpp::sdl::SDLTexture::SDLTexture(SDL_Renderer *renderer, int w, int h,
     : texturePtr(createTexture(renderer, w, h, pixelFormat)),
       pixelFormat(pixelFormat) {}
 
-void vivictpp::sdl::SDLTexture::update(const vivictpp::libav::Frame &frame) {
+void vivictpp::sdl::SDLTexture::update(const vivictpp::libav::Frame &frame,
+                                       const SDL_Rect *rect) {
+  int x = rect ? rect->x : 0;
+  int y = rect ? rect->y : 0;
+  const uint8_t *luma = frame->data[0] + y * frame->linesize[0] + x;
   if (pixelFormat == SDL_PIXELFORMAT_YV12) {
-    SDL_UpdateYUVTexture(texturePtr.get(), nullptr, frame->data[0],
-                         frame->linesize[0], frame->data[1], frame->linesize[1],
-                         frame->data[2], frame->linesize[2]);
+    SDL_UpdateYUVTexture(
+        texturePtr.get(), rect, luma, frame->linesize[0],
+        frame->data[1] + (y / 2) * frame->linesize[1] + x / 2,
+        frame->linesize[1],
+        frame->data[2] + (y / 2) * frame->linesize[2] + x / 2,
+        frame->linesize[2]);
   } else {
-    SDL_UpdateNVTexture(texturePtr.get(), nullptr, frame->data[0],
-                        frame->linesize[0], frame->data[1], frame->linesize[1]);
+    // NV12 has interleaved chroma, two bytes per chroma sample
+    SDL_UpdateNVTexture(texturePtr.get(), rect, luma, frame->linesize[0],
+                        frame->data[1] + (y / 2) * frame->linesize[1] + x,
+                        frame->linesize[1]);
   }
 }
 
+void vivictpp::sdl::SDLTexture::updateAt(const uint8_t *const planes[3],
+                                         const int linesizes[3], int x, int y,
+                                         int w, int h) {
+  SDL_Rect dst = {x, y, w, h};
+  SDL_UpdateYUVTexture(texturePtr.get(), &dst, planes[0], linesizes[0],
+                       planes[1], linesizes[1], planes[2], linesizes[2]);
+}
+
+void vivictpp::sdl::SDLTexture::updatePixels(const uint8_t *pixels,
+                                             int pitch) {
+  SDL_UpdateTexture(texturePtr.get(), nullptr, pixels, pitch);
+}
+
 vivictpp::sdl::SDLWindow vivictpp::sdl::createWindow(int width, int height,
                                                      int flags) {
   auto window = std::unique_ptr<SDL_Window, std::function<void(SDL_Window *)>>(
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+  const char *name;
+  int64_t start;
+  int64_t end;
+};
+
+// Single producer ring buffer, written only by the owning thread. Readers
+// copy the events and discard any that may have been overwritten while
+// copying.
+class ThreadBuffer {
+public:
+  static constexpr uint64_t CAPACITY = 1 << 15;
+
+  ThreadBuffer(int threadId) : threadId(threadId) {}
+
+  void push(const TraceEvent &event) {
+    uint64_t index = writeCount.load(std::memory_order_relaxed);
+    events[index % CAPACITY] = event;
+    writeCount.store(index + 1, std::memory_order_release);
+  }
+
+  std::vector<TraceEvent> snapshot() {
+    uint64_t end = writeCount.load(std::memory_order_acquire);
+    uint64_t begin = std::max<uint64_t>(
+        end > CAPACITY ? end - CAPACITY : 0, clearedCount.load());
+    std::vector<TraceEvent> result;
+    result.reserve(end - begin);
+    for (uint64_t i = begin; i < end; i++) {
+      result.push_back(events[i % CAPACITY]);
+    }
+    // Drop events the writer may have overwritten while we were copying. The
+    // writer may be in the middle of writing event after, which goes to the
+    // slot of event after - CAPACITY.
+    uint64_t after = writeCount.load(std::memory_order_acquire);
+    if (after >= CAPACITY && after - CAPACITY >= begin) {
+      size_t overwritten = std::min<uint64_t>(after - CAPACITY - begin + 1,
+                                              (uint64_t)result.size());
+      result.erase(result.begin(), result.begin() + overwritten);
+    }
+    drainedCount.store(end);
+    return result;
+  }
+
+  void clear() {
+    clearedCount.store(writeCount.load(std::memory_order_acquire));
+  }
+
+  // True if all events have been written out or cleared
+  bool drained() const {
+    uint64_t written = writeCount.load(std::memory_order_acquire);
+    return written <= clearedCount.load() || written <= drainedCount.load();
+  }
+
+  const int threadId;
+  std::string threadName;
+  // Set when the owning thread has exited
+  bool exited{false};
+
+private:
+  std::array<TraceEvent, CAPACITY> events;
+  std::atomic<uint64_t> writeCount{0};
+  std::atomic<uint64_t> clearedCount{0};
+  std::atomic<uint64_t> drainedCount{0};
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+int nextThreadId{1};
+
+// Removes the buffers of exited threads whose events have been written out or
+// cleared. registryMutex must be held.
+void releaseExitedBuffers() {
+  threadBuffers.erase(std::remove_if(threadBuffers.begin(),
+                                     threadBuffers.end(),
+                                     [](const auto &buffer) {
+                                       return buffer->exited &&
+                                              buffer->drained();
+                                     }),
+                      threadBuffers.end());
+}
+
+// The buffer of a thread is only allocated when it traces its first span, so
+// that threads do not use memory for tracing while it is disabled
+struct ThreadState {
+  std::string threadName;
+  std::shared_ptr<ThreadBuffer> buffer;
+
+  ~ThreadState() {
+    if (buffer) {
+      std::lock_guard<std::mutex> lock(registryMutex);
+      buffer->exited = true;
+      releaseExitedBuffers();
+    }
+  }
+};
+
+ThreadState &threadState() {
+  thread_local ThreadState state;
+  return state;
+}
+
+ThreadBuffer &threadBuffer() {
+  ThreadState &state = threadState();
+  if (!state.buffer) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    state.buffer = std::make_shared<ThreadBuffer>(nextThreadId++);
+    state.buffer->threadName = state.threadName;
+    threadBuffers.push_back(state.buffer);
+  }
+  return *state.buffer;
+}
+
+void writeJsonString(std::ostream &out, const std::string &str) {
+  out << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if ((unsigned char)c < 0x20) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+void vivictpp::tracing::setEnabled(bool enabled) {
+  tracingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+int64_t vivictpp::tracing::nowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void vivictpp::tracing::recordSpan(const char *name, int64_t startNanos,
+                                   int64_t endNanos) {
+  threadBuffer().push({name, startNanos, endNanos});
+}
+
+void vivictpp::tracing::setThreadName(const std::string &name) {
+  ThreadState &state = threadState();
+  state.threadName = name;
+  if (state.buffer) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    state.buffer->threadName = name;
+  }
+}
+
+void vivictpp::tracing::clear() {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (auto &buffer : threadBuffers) {
+    buffer->clear();
+  }
+  releaseExitedBuffers();
+}
+
+void vivictpp::tracing::writeChromeTrace(const std::filesystem::path &path) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Failed to open " + path.string());
+  }
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffers = threadBuffers;
+  }
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  auto separator = [&]() {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+  };
+  for (const auto &buffer : buffers) {
+    std::string threadName;
+    {
+      std::lock_guard<std::mutex> lock(registryMutex);
+      threadName = buffer->threadName;
+    }
+    if (!threadName.empty()) {
+      separator();
+      out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->threadId << ",\"args\":{\"name\":";
+      writeJsonString(out, threadName);
+      out << "}}";
+    }
+    for (const auto &event : buffer->snapshot()) {
+      separator();
+      // Chrome trace timestamps are in microseconds, fractions are allowed
+      out << "{\"name\":";
+      writeJsonString(out, event.name);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+          << ",\"ts\":" << event.start / 1000 << "." << std::setfill('0')
+          << std::setw(3) << event.start % 1000
+          << ",\"dur\":" << (event.end - event.start) / 1000 << "."
+          << std::setw(3) << (event.end - event.start) % 1000 << "}";
+    }
+  }
+  out << "]}\n";
+  std::lock_guard<std::mutex> lock(registryMutex);
+  releaseExitedBuffers();
+}
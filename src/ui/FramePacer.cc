@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ui/FramePacer.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+vivictpp::ui::FramePacer::FramePacer(size_t historySize)
+    : history(std::max<size_t>(historySize, 1)) {}
+
+void vivictpp::ui::FramePacer::setDisplayRefreshRate(int refreshRate) {
+  int64_t interval = refreshRate > 0 ? 1000000 / refreshRate : 0;
+  if (interval == nominalRefreshInterval) {
+    return;
+  }
+  nominalRefreshInterval = interval;
+  if (interval > 0) {
+    refreshInterval = interval;
+  }
+}
+
+void vivictpp::ui::FramePacer::updateRefreshInterval(int64_t interval) {
+  if (interval <= 0) {
+    return;
+  }
+  int64_t reference =
+      nominalRefreshInterval > 0 ? nominalRefreshInterval : refreshInterval;
+  // Only intervals close to one refresh period say anything about the vsync
+  // rate, longer ones are missed vsyncs
+  if (interval < reference * 3 / 4 || interval > reference * 5 / 4) {
+    return;
+  }
+  refreshInterval = (refreshInterval * 31 + interval) / 32;
+}
+
+int64_t vivictpp::ui::FramePacer::predictNextVsync(int64_t now) const {
+  if (lastPresentTime == 0 || now < lastPresentTime) {
+    return now + refreshInterval;
+  }
+  int64_t vsyncs = (now - lastPresentTime) / refreshInterval + 1;
+  return lastPresentTime + vsyncs * refreshInterval;
+}
+
+int64_t
+vivictpp::ui::FramePacer::alignClockOrigin(int64_t clockOrigin) const {
+  if (lastPresentTime == 0) {
+    return clockOrigin;
+  }
+  int64_t target = lastPresentTime + refreshInterval / 4;
+  int64_t shift = (target - clockOrigin) % refreshInterval;
+  if (shift < 0) {
+    shift += refreshInterval;
+  }
+  return clockOrigin + shift;
+}
+
+void vivictpp::ui::FramePacer::recordPresent(int64_t presentTime,
+                                             const PresentInfo &presentInfo) {
+  PresentRecord record;
+  record.presentTime = presentTime;
+  record.interval = lastPresentTime > 0 ? presentTime - lastPresentTime : 0;
+  record.pts = presentInfo.pts;
+  record.clockPts = presentInfo.clockPts;
+  record.playing = presentInfo.playing;
+  record.newFrame = presentInfo.pts != lastPts;
+  updateRefreshInterval(record.interval);
+
+  int vsyncs = 1;
+  if (record.interval > 0) {
+    vsyncs = std::max<int>(
+        1, (int)std::llround((double)record.interval / refreshInterval));
+  }
+  if (vsyncs > 1) {
+    record.missedVsync = true;
+    stats.missedVsyncs += vsyncs - 1;
+  }
+
+  if (presentInfo.playing && presentInfo.frameDuration > 0) {
+    if (record.newFrame) {
+      // How many vsyncs the previous frame should stay on screen given the
+      // frame rate and speed, e.g. 2 or 3 for 24p on 60 Hz
+      double cadence = presentInfo.frameDuration / presentInfo.speed /
+                       (double)refreshInterval;
+      if (holdVsyncs > (int)std::ceil(cadence - 0.01)) {
+        record.duplicated = true;
+        stats.duplicatedFrames++;
+      }
+      if (presentInfo.clockPts - presentInfo.pts > presentInfo.frameDuration) {
+        record.late = true;
+        stats.lateFrames++;
+      }
+      holdVsyncs = vsyncs;
+    } else {
+      holdVsyncs += vsyncs;
+    }
+  } else {
+    holdVsyncs = 0;
+  }
+
+  history[historyPos] = record;
+  historyPos = (historyPos + 1) % history.size();
+  historyCount = std::min(historyCount + 1, history.size());
+  lastPresentTime = presentTime;
+  lastPts = presentInfo.pts;
+  stats.presents++;
+}
+
+std::vector<vivictpp::ui::PresentRecord>
+vivictpp::ui::FramePacer::getHistory() const {
+  std::vector<PresentRecord> result;
+  result.reserve(historyCount);
+  size_t start = (historyPos + history.size() - historyCount) % history.size();
+  for (size_t i = 0; i < historyCount; i++) {
+    result.push_back(history[(start + i) % history.size()]);
+  }
+  return result;
+}
+
+vivictpp::ui::PresentStats vivictpp::ui::FramePacer::getStats() const {
+  PresentStats result = stats;
+  result.refreshRate = 1e6 / refreshInterval;
+  double intervalSum = 0;
+  int intervalCount = 0;
+  double errorSum = 0;
+  double errorSquareSum = 0;
+  int errorCount = 0;
+  for (const auto &record : getHistory()) {
+    if (record.interval > 0) {
+      intervalSum += record.interval;
+      intervalCount++;
+      result.maxIntervalMs =
+          std::max(result.maxIntervalMs, record.interval / 1000.0);
+    }
+    if (record.playing && record.newFrame) {
+      double error = (record.clockPts - record.pts) / 1000.0;
+      errorSum += error;
+      errorSquareSum += error * error;
+      errorCount++;
+    }
+  }
+  if (intervalCount > 0) {
+    result.meanIntervalMs = intervalSum / intervalCount / 1000.0;
+  }
+  if (errorCount > 1) {
+    double mean = errorSum / errorCount;
+    result.judderMs =
+        std::sqrt(std::max(0.0, errorSquareSum / errorCount - mean * mean));
+  }
+  return result;
+}
+
+void vivictpp::ui::FramePacer::resetStats() {
+  stats = PresentStats();
+  historyCount = 0;
+  historyPos = 0;
+}
+
+void vivictpp::ui::FramePacer::exportCsv(
+    const std::filesystem::path &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Failed to open " + path.string());
+  }
+  out << "present_time_us,interval_us,pts_us,clock_pts_us,playing,"
+         "new_frame,missed_vsync,late,duplicated\n";
+  for (const auto &record : getHistory()) {
+    out << record.presentTime << "," << record.interval << "," << record.pts
+        << "," << record.clockPts << "," << record.playing << ","
+        << record.newFrame << ","
+        << record.missedVsync << "," << record.late << ","
+        << record.duplicated << "\n";
+  }
+}
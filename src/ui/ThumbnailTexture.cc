@@ -6,34 +6,109 @@
 
 #include "video/VideoIndexer.hh"
 
-vivictpp::sdl::SDLTexture &vivictpp::ui::ThumbnailTexture::updateAndGetTexture(
-    const vivictpp::time::Time &pts) {
+#include <algorithm>
+
+namespace {
+
+int roundUpToEven(int x) { return (x + 1) & ~1; }
+
+} // namespace
+
+void vivictpp::ui::ThumbnailTexture::reset() {
+  uploadedVersion = -1;
+  uploadedGeneration = -1;
+  entries.clear();
+  pages.clear();
+  nextSlot = 0;
+  columns = 0;
+  rows = 0;
+}
+
+void vivictpp::ui::ThumbnailTexture::update() {
   if (!videoIndex) {
-    return texture;
+    return;
+  }
+  // Read before the version, so that a clear in between is seen at the next
+  // update at the latest
+  int generation = videoIndex->getGeneration();
+  if (generation != uploadedGeneration) {
+    // The index has been cleared and is being rebuilt, possibly for another
+    // source with as many thumbnails
+    reset();
+    uploadedGeneration = generation;
+  }
+  int version = videoIndex->getThumbnailsVersion();
+  if (version == uploadedVersion) {
+    return;
   }
-  const auto &thumbnail = getThumbnail(pts);
-  if (thumbnail.pts != currentTime && !thumbnail.frame.empty()) {
-    auto frame = thumbnail.frame;
-    if (!texture || frame->width != this->width ||
-        frame->height != this->height) {
-      texture = vivictpp::sdl::SDLTexture(this->renderer, frame->width,
-                                          frame->height, SDL_PIXELFORMAT_YV12);
-      this->width = frame->width;
-      this->height = frame->height;
+  // Thumbnails are never removed from the index except by clearing it, so
+  // the ones not uploaded yet are the ones added after the uploaded ones
+  std::vector<vivictpp::video::Thumbnail> thumbnails =
+      videoIndex->copyThumbnails(entries.size());
+  if (columns == 0 && !thumbnails.empty()) {
+    // All thumbnails of a stream are scaled the same way, so the first one
+    // decides the cell size
+    width = roundUpToEven(thumbnails.front().width);
+    height = roundUpToEven(thumbnails.front().height);
+    columns = std::max(1, MAX_PAGE_SIZE / width);
+    rows = std::max(1, MAX_PAGE_SIZE / height);
+  }
+  for (const auto &thumbnail : thumbnails) {
+    auto it = std::lower_bound(
+        entries.begin(), entries.end(), thumbnail.pts,
+        [](const Entry &e, vivictpp::time::Time pts) { return e.pts < pts; });
+    if (it != entries.end() && it->pts == thumbnail.pts) {
+      continue;
     }
-    texture.update(frame);
-    currentTime = thumbnail.pts;
+    int w = std::min(thumbnail.width & ~1, width);
+    int h = std::min(thumbnail.height & ~1, height);
+    const uint8_t *const planes[3] = {thumbnail.plane(0), thumbnail.plane(1),
+                                      thumbnail.plane(2)};
+    const int linesizes[3] = {thumbnail.linesize(0), thumbnail.linesize(1),
+                              thumbnail.linesize(2)};
+    int slot = allocateSlot();
+    int cell = slot % (columns * rows);
+    pages[slot / (columns * rows)].updateAt(planes, linesizes,
+                                            (cell % columns) * width,
+                                            (cell / columns) * height, w, h);
+    entries.insert(it, {thumbnail.pts, slot, w, h});
   }
-  return texture;
+  uploadedVersion = version;
 }
 
-const vivictpp::video::Thumbnail &
-vivictpp::ui::ThumbnailTexture::getThumbnail(const vivictpp::time::Time &pts) {
-  const auto &thumbnails = videoIndex->getThumbnails();
-  for (size_t i = 1; i < thumbnails.size(); i++) {
-    if (thumbnails[i].pts > pts) {
-      return thumbnails[i - 1];
-    }
+int vivictpp::ui::ThumbnailTexture::allocateSlot() {
+  int slot = nextSlot++;
+  if (slot / (columns * rows) >= (int)pages.size()) {
+    pages.emplace_back(renderer, columns * width, rows * height,
+                       SDL_PIXELFORMAT_YV12);
   }
-  return thumbnails[thumbnails.size() - 1];
+  return slot;
+}
+
+vivictpp::ui::ThumbnailRegion
+vivictpp::ui::ThumbnailTexture::getRegion(vivictpp::time::Time pts) const {
+  if (entries.empty()) {
+    return {};
+  }
+  auto it = std::upper_bound(
+      entries.begin(), entries.end(), pts,
+      [](vivictpp::time::Time pts, const Entry &e) { return pts < e.pts; });
+  return region(it == entries.begin() ? *it : *(it - 1));
+}
+
+vivictpp::ui::ThumbnailRegion
+vivictpp::ui::ThumbnailTexture::region(const Entry &entry) const {
+  int cell = entry.slot % (columns * rows);
+  float pageWidth = columns * width;
+  float pageHeight = rows * height;
+  float x = (cell % columns) * width;
+  float y = (cell / columns) * height;
+  ThumbnailRegion result;
+  result.texture = pages[entry.slot / (columns * rows)].get();
+  result.u0 = x / pageWidth;
+  result.v0 = y / pageHeight;
+  result.u1 = (x + entry.width) / pageWidth;
+  result.v1 = (y + entry.height) / pageHeight;
+  result.pts = entry.pts;
+  return result;
 }
@@ -3,6 +3,44 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "ui/VideoTextures.hh"
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Extra area uploaded around the visible part, relative to the visible size,
+// so that small scroll steps do not require a new upload
+constexpr float UPLOAD_MARGIN = 0.25f;
+// Upload the whole frame when the visible part covers more than this
+constexpr float FULL_UPLOAD_THRESHOLD = 0.6f;
+
+int alignDown(int v) { return v & ~1; }
+int alignUp(int v) { return (v + 1) & ~1; }
+
+// Rectangle of a w x h frame covering visibleRect expanded by margin, with
+// even position and size as required by 4:2:0 chroma subsampling
+SDL_Rect toPixelRect(const vivictpp::ui::VisibleRect &visibleRect, int w,
+                     int h, float margin) {
+  float mx = (visibleRect.x1 - visibleRect.x0) * margin;
+  float my = (visibleRect.y1 - visibleRect.y0) * margin;
+  int x0 = alignDown(std::clamp(
+      (int)std::floor((visibleRect.x0 - mx) * w) - 1, 0, w));
+  int y0 = alignDown(std::clamp(
+      (int)std::floor((visibleRect.y0 - my) * h) - 1, 0, h));
+  int x1 = std::min(w, alignUp((int)std::ceil((visibleRect.x1 + mx) * w) + 1));
+  int y1 = std::min(h, alignUp((int)std::ceil((visibleRect.y1 + my) * h) + 1));
+  return {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+bool contains(const SDL_Rect &outer, const SDL_Rect &inner) {
+  return inner.x >= outer.x && inner.y >= outer.y &&
+         inner.x + inner.w <= outer.x + outer.w &&
+         inner.y + inner.h <= outer.y + outer.h;
+}
+
+} // namespace
 
 SDL_PixelFormatEnum getTexturePixelFormat(const vivictpp::libav::Frame &frame) {
   if (!frame.empty() &&
@@ -75,16 +113,123 @@ bool vivictpp::ui::VideoTextures::initTextures(
         displayState.rightVideoMetadata.filteredResolution.h,
         getTexturePixelFormat(displayState.rightFrame));
   }
+  extraTextures.clear();
+  for (size_t i = 0; i < displayState.extraVideoMetadata.size() &&
+                     i < displayState.extraFrames.size();
+       i++) {
+    const Resolution &resolution =
+        displayState.extraVideoMetadata[i].filteredResolution;
+    extraTextures.emplace_back(
+        renderer, resolution.w, resolution.h,
+        getTexturePixelFormat(displayState.extraFrames[i]));
+  }
   videoMetadataVersion = displayState.videoMetadataVersion;
+  leftRegion = {};
+  rightRegion = {};
+  uploadedDifference.reset();
   return true;
 }
 
+// Uploads only the visible part of the frame, with some margin, when zoomed
+// in. Falls back to uploading the whole frame when most of it is visible.
+void vivictpp::ui::VideoTextures::upload(vivictpp::sdl::SDLTexture &texture,
+                                         const vivictpp::libav::Frame &frame,
+                                         const VisibleRect &visibleRect,
+                                         UploadedRegion &region) {
+  VPP_TRACE_SPAN("texture_upload");
+  int w = frame->width;
+  int h = frame->height;
+  SDL_Rect rect = toPixelRect(visibleRect, w, h, UPLOAD_MARGIN);
+  if (rect.w == 0 || rect.h == 0 ||
+      (float)rect.w * rect.h >= FULL_UPLOAD_THRESHOLD * w * h) {
+    texture.update(frame);
+    region = {true, true, {0, 0, w, h}};
+  } else {
+    texture.update(frame, &rect);
+    region = {true, false, rect};
+  }
+}
+
 bool vivictpp::ui::VideoTextures::update(SDL_Renderer *renderer,
                                          const DisplayState &displayState) {
   bool textureSizeChanged = initTextures(renderer, displayState);
-  leftTexture.update(displayState.leftFrame);
+  upload(leftTexture, displayState.leftFrame, displayState.leftVisibleRect,
+         leftRegion);
   if (!displayState.rightFrame.empty()) {
-    rightTexture.update(displayState.rightFrame);
+    upload(rightTexture, displayState.rightFrame,
+           displayState.rightVisibleRect, rightRegion);
+  }
+  if (displayState.gridLayout) {
+    uploadExtraFrames(displayState);
+  } else {
+    // Extra frames are only drawn in the grid layout
+    extraTexturesDirty = !extraTextures.empty();
   }
   return textureSizeChanged;
 }
+
+void vivictpp::ui::VideoTextures::uploadExtraFrames(
+    const DisplayState &displayState) {
+  for (size_t i = 0;
+       i < extraTextures.size() && i < displayState.extraFrames.size(); i++) {
+    if (!displayState.extraFrames[i].empty()) {
+      VPP_TRACE_SPAN("texture_upload");
+      extraTextures[i].update(displayState.extraFrames[i]);
+    }
+  }
+  extraTexturesDirty = false;
+}
+
+bool vivictpp::ui::VideoTextures::updateVisibleRegion(
+    const DisplayState &displayState) {
+  auto needsUpload = [](const UploadedRegion &region,
+                        const vivictpp::libav::Frame &frame,
+                        const VisibleRect &visibleRect) {
+    if (!region.valid || region.full) {
+      return false;
+    }
+    SDL_Rect visible =
+        toPixelRect(visibleRect, frame->width, frame->height, 0.0f);
+    return !contains(region.rect, visible);
+  };
+  bool uploaded = false;
+  if (!displayState.leftFrame.empty() &&
+      needsUpload(leftRegion, displayState.leftFrame,
+                  displayState.leftVisibleRect)) {
+    upload(leftTexture, displayState.leftFrame, displayState.leftVisibleRect,
+           leftRegion);
+    uploaded = true;
+  }
+  if (!displayState.rightFrame.empty() &&
+      needsUpload(rightRegion, displayState.rightFrame,
+                  displayState.rightVisibleRect)) {
+    upload(rightTexture, displayState.rightFrame,
+           displayState.rightVisibleRect, rightRegion);
+    uploaded = true;
+  }
+  if (displayState.gridLayout && extraTexturesDirty) {
+    uploadExtraFrames(displayState);
+    uploaded = true;
+  }
+  return uploaded;
+}
+
+void vivictpp::ui::VideoTextures::updateDifference(
+    SDL_Renderer *renderer,
+    const std::shared_ptr<const vivictpp::video::DifferenceImage> &image) {
+  if (!image || image == uploadedDifference || image->width == 0) {
+    return;
+  }
+  int w = 0;
+  int h = 0;
+  if (differenceTexture) {
+    SDL_QueryTexture(differenceTexture.get(), nullptr, nullptr, &w, &h);
+  }
+  if (!differenceTexture || w != image->width || h != image->height) {
+    differenceTexture = vivictpp::sdl::SDLTexture(
+        renderer, image->width, image->height, SDL_PIXELFORMAT_RGBA32);
+  }
+  VPP_TRACE_SPAN("texture_upload");
+  differenceTexture.updatePixels(image->rgba.data(), image->width * 4);
+  uploadedDifference = image;
+}
@@ -0,0 +1,288 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/Bilinear.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#if defined(VIVICTPP_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int POSITION_BITS = 16;
+constexpr int WEIGHT_BITS = 8;
+constexpr uint32_t WEIGHT_ONE = 1 << WEIGHT_BITS;
+constexpr uint32_t ROUNDING = 1 << (2 * WEIGHT_BITS - 1);
+
+// Source index and weight of the next source sample for each destination
+// sample along one axis. Indices are monotonically increasing.
+struct Axis {
+  std::vector<int32_t> index;
+  std::vector<int32_t> weight;
+};
+
+Axis computeAxis(double start, double length, int dstSize, int srcSize) {
+  Axis axis;
+  axis.index.resize(dstSize);
+  axis.weight.resize(dstSize);
+  const int64_t maxPos = static_cast<int64_t>(srcSize - 1) << POSITION_BITS;
+  const double scale = length / dstSize;
+  for (int d = 0; d < dstSize; d++) {
+    double pos = start + (d + 0.5) * scale - 0.5;
+    int64_t fixedPos = std::llround(pos * (1 << POSITION_BITS));
+    fixedPos = std::clamp<int64_t>(fixedPos, 0, maxPos);
+    axis.index[d] = static_cast<int32_t>(fixedPos >> POSITION_BITS);
+    axis.weight[d] = static_cast<int32_t>(
+        (fixedPos & ((1 << POSITION_BITS) - 1)) >>
+        (POSITION_BITS - WEIGHT_BITS));
+  }
+  return axis;
+}
+
+template <typename T> T narrow(uint32_t v) {
+  return static_cast<T>((v + ROUNDING) >> (2 * WEIGHT_BITS));
+}
+
+template <typename T>
+void referenceResample(const vivictpp::video::Plane<const T> &src,
+                       const vivictpp::video::SourceRect &srcRect,
+                       const vivictpp::video::Plane<T> &dst) {
+  Axis xAxis = computeAxis(srcRect.x, srcRect.w, dst.width, src.width);
+  Axis yAxis = computeAxis(srcRect.y, srcRect.h, dst.height, src.height);
+  for (int dy = 0; dy < dst.height; dy++) {
+    int y0 = yAxis.index[dy];
+    int y1 = std::min(y0 + 1, src.height - 1);
+    uint32_t wy = yAxis.weight[dy];
+    const T *row0 = src.data + static_cast<ptrdiff_t>(y0) * src.stride;
+    const T *row1 = src.data + static_cast<ptrdiff_t>(y1) * src.stride;
+    T *out = dst.data + static_cast<ptrdiff_t>(dy) * dst.stride;
+    for (int dx = 0; dx < dst.width; dx++) {
+      int x0 = xAxis.index[dx];
+      int x1 = std::min(x0 + 1, src.width - 1);
+      uint32_t wx = xAxis.weight[dx];
+      uint32_t left = row0[x0] * (WEIGHT_ONE - wy) + row1[x0] * wy;
+      uint32_t right = row0[x1] * (WEIGHT_ONE - wy) + row1[x1] * wy;
+      out[dx] = narrow<T>(left * (WEIGHT_ONE - wx) + right * wx);
+    }
+  }
+}
+
+// The separable implementation first blends the two source rows needed for a
+// destination row into tmp, then interpolates horizontally from tmp. Both
+// passes use the same integer arithmetic as the reference so results are
+// identical.
+
+template <typename T>
+void verticalPassScalar(const T *row0, const T *row1, int begin, int n,
+                        uint32_t wy, uint32_t *tmp) {
+  for (int x = begin; x < n; x++) {
+    tmp[x] = row0[x] * (WEIGHT_ONE - wy) + row1[x] * wy;
+  }
+}
+
+template <typename T>
+void horizontalPassScalar(const uint32_t *tmp, const int32_t *index,
+                          const int32_t *weight, int begin, int n, T *out) {
+  for (int dx = begin; dx < n; dx++) {
+    uint32_t wx = weight[dx];
+    out[dx] =
+        narrow<T>(tmp[index[dx]] * (WEIGHT_ONE - wx) + tmp[index[dx] + 1] * wx);
+  }
+}
+
+#if defined(VIVICTPP_HAVE_AVX2)
+
+template <typename T>
+VIVICTPP_TARGET_AVX2 void verticalPassAvx2(const T *row0, const T *row1, int n,
+                                           uint32_t wy, uint32_t *tmp) {
+  const __m256i w0 = _mm256_set1_epi32(WEIGHT_ONE - wy);
+  const __m256i w1 = _mm256_set1_epi32(wy);
+  int x = 0;
+  for (; x + 8 <= n; x += 8) {
+    __m256i a, b;
+    if constexpr (std::is_same_v<T, uint8_t>) {
+      a = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row0 + x)));
+      b = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row1 + x)));
+    } else {
+      a = _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x)));
+      b = _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + x)));
+    }
+    __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(a, w0),
+                                 _mm256_mullo_epi32(b, w1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(tmp + x), v);
+  }
+  verticalPassScalar(row0, row1, x, n, wy, tmp);
+}
+
+template <typename T>
+VIVICTPP_TARGET_AVX2 void horizontalPassAvx2(const uint32_t *tmp,
+                                             const int32_t *index,
+                                             const int32_t *weight, int n,
+                                             T *out) {
+  const int *base = reinterpret_cast<const int *>(tmp);
+  const __m256i one = _mm256_set1_epi32(WEIGHT_ONE);
+  const __m256i rounding = _mm256_set1_epi32(ROUNDING);
+  int dx = 0;
+  for (; dx + 8 <= n; dx += 8) {
+    __m256i idx =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + dx));
+    __m256i w1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + dx));
+    __m256i w0 = _mm256_sub_epi32(one, w1);
+    __m256i left = _mm256_i32gather_epi32(base, idx, 4);
+    __m256i right = _mm256_i32gather_epi32(base + 1, idx, 4);
+    __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(left, w0),
+                                 _mm256_mullo_epi32(right, w1));
+    v = _mm256_srli_epi32(_mm256_add_epi32(v, rounding), 2 * WEIGHT_BITS);
+    // Pack 8 x 32 bit to 8 x 16 bit, packus works per 128 bit lane so
+    // gather the two halves with a permute afterwards
+    __m256i packed = _mm256_packus_epi32(v, v);
+    packed = _mm256_permute4x64_epi64(packed, 0x08);
+    __m128i v16 = _mm256_castsi256_si128(packed);
+    if constexpr (std::is_same_v<T, uint8_t>) {
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(out + dx),
+                       _mm_packus_epi16(v16, v16));
+    } else {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + dx), v16);
+    }
+  }
+  horizontalPassScalar(tmp, index, weight, dx, n, out);
+}
+
+#endif
+
+#if defined(VIVICTPP_HAVE_NEON)
+
+template <typename T>
+void verticalPassNeon(const T *row0, const T *row1, int n, uint32_t wy,
+                      uint32_t *tmp) {
+  const uint16_t w0 = static_cast<uint16_t>(WEIGHT_ONE - wy);
+  const uint16_t w1 = static_cast<uint16_t>(wy);
+  int x = 0;
+  for (; x + 8 <= n; x += 8) {
+    uint16x8_t a, b;
+    if constexpr (std::is_same_v<T, uint8_t>) {
+      a = vmovl_u8(vld1_u8(row0 + x));
+      b = vmovl_u8(vld1_u8(row1 + x));
+    } else {
+      a = vld1q_u16(row0 + x);
+      b = vld1q_u16(row1 + x);
+    }
+    uint32x4_t lo = vmlal_n_u16(vmull_n_u16(vget_low_u16(a), w0),
+                                vget_low_u16(b), w1);
+    uint32x4_t hi = vmlal_n_u16(vmull_n_u16(vget_high_u16(a), w0),
+                                vget_high_u16(b), w1);
+    vst1q_u32(tmp + x, lo);
+    vst1q_u32(tmp + x + 4, hi);
+  }
+  verticalPassScalar(row0, row1, x, n, wy, tmp);
+}
+
+#endif
+
+template <typename T>
+void separableResample(const vivictpp::video::Plane<const T> &src,
+                       const vivictpp::video::SourceRect &srcRect,
+                       const vivictpp::video::Plane<T> &dst,
+                       vivictpp::video::SimdLevel simdLevel) {
+  using vivictpp::video::SimdLevel;
+  Axis xAxis = computeAxis(srcRect.x, srcRect.w, dst.width, src.width);
+  Axis yAxis = computeAxis(srcRect.y, srcRect.h, dst.height, src.height);
+
+  // Only the source columns covered by the rect are blended vertically
+  const int xBegin = xAxis.index.front();
+  const int xEnd = std::min(xAxis.index.back() + 1, src.width - 1);
+  const int n = xEnd - xBegin + 1;
+  for (auto &i : xAxis.index) {
+    i -= xBegin;
+  }
+  // One extra element so that index + 1 is always valid, its weight is 0
+  std::vector<uint32_t> tmp(n + 1);
+
+  int lastY0 = -1;
+  int32_t lastWy = -1;
+  for (int dy = 0; dy < dst.height; dy++) {
+    const int y0 = yAxis.index[dy];
+    const int32_t wy = yAxis.weight[dy];
+    // When zoomed in, consecutive rows often sample the same position
+    if (y0 != lastY0 || wy != lastWy) {
+      const int y1 = std::min(y0 + 1, src.height - 1);
+      const T *row0 =
+          src.data + static_cast<ptrdiff_t>(y0) * src.stride + xBegin;
+      const T *row1 =
+          src.data + static_cast<ptrdiff_t>(y1) * src.stride + xBegin;
+      switch (simdLevel) {
+#if defined(VIVICTPP_HAVE_AVX2)
+      case SimdLevel::AVX2:
+        verticalPassAvx2(row0, row1, n, wy, tmp.data());
+        break;
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+      case SimdLevel::NEON:
+        verticalPassNeon(row0, row1, n, wy, tmp.data());
+        break;
+#endif
+      default:
+        verticalPassScalar(row0, row1, 0, n, wy, tmp.data());
+      }
+      tmp[n] = tmp[n - 1];
+      lastY0 = y0;
+      lastWy = wy;
+    }
+    T *out = dst.data + static_cast<ptrdiff_t>(dy) * dst.stride;
+#if defined(VIVICTPP_HAVE_AVX2)
+    if (simdLevel == SimdLevel::AVX2) {
+      horizontalPassAvx2(tmp.data(), xAxis.index.data(), xAxis.weight.data(),
+                         dst.width, out);
+      continue;
+    }
+#endif
+    horizontalPassScalar(tmp.data(), xAxis.index.data(), xAxis.weight.data(),
+                         0, dst.width, out);
+  }
+}
+
+template <typename T>
+void resample(const vivictpp::video::Plane<const T> &src,
+              const vivictpp::video::SourceRect &srcRect,
+              const vivictpp::video::Plane<T> &dst,
+              vivictpp::video::SimdLevel simdLevel) {
+  if (dst.width <= 0 || dst.height <= 0 || src.width <= 0 ||
+      src.height <= 0 || srcRect.w <= 0 || srcRect.h <= 0) {
+    return;
+  }
+  if (simdLevel == vivictpp::video::SimdLevel::SCALAR) {
+    referenceResample(src, srcRect, dst);
+  } else {
+    separableResample(src, srcRect, dst, simdLevel);
+  }
+}
+
+} // namespace
+
+void vivictpp::video::bilinearResample(const Plane<const uint8_t> &src,
+                                       const SourceRect &srcRect,
+                                       const Plane<uint8_t> &dst,
+                                       SimdLevel simdLevel) {
+  resample(src, srcRect, dst, simdLevel);
+}
+
+void vivictpp::video::bilinearResample(const Plane<const uint16_t> &src,
+                                       const SourceRect &srcRect,
+                                       const Plane<uint16_t> &dst,
+                                       SimdLevel simdLevel) {
+  resample(src, srcRect, dst, simdLevel);
+}
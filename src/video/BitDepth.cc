@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/BitDepth.hh"
+
+#include <algorithm>
+
+#if defined(VIVICTPP_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int DITHER_SIZE = 8;
+
+// Bayer matrix, thresholds 0 to 63
+constexpr uint8_t BAYER[DITHER_SIZE][DITHER_SIZE] = {
+    {0, 32, 8, 40, 2, 34, 10, 42},   {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44, 4, 36, 14, 46, 6, 38},  {60, 28, 52, 20, 62, 30, 54, 22},
+    {3, 35, 11, 43, 1, 33, 9, 41},   {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47, 7, 39, 13, 45, 5, 37},  {63, 31, 55, 23, 61, 29, 53, 21}};
+
+// Values added to the samples of a row before shifting, repeated twice so
+// that 16 samples can be loaded at once
+struct RowOffsets {
+  alignas(32) uint16_t values[2 * DITHER_SIZE];
+};
+
+RowOffsets rowOffsets(int y, int shift, bool dither) {
+  RowOffsets offsets;
+  for (int x = 0; x < 2 * DITHER_SIZE; x++) {
+    offsets.values[x] =
+        dither ? static_cast<uint16_t>(
+                     (BAYER[y % DITHER_SIZE][x % DITHER_SIZE] << shift) >> 6)
+               : static_cast<uint16_t>(1 << (shift - 1));
+  }
+  return offsets;
+}
+
+// Saturating add, so that all simd levels give the same result for samples
+// close to the maximum 16 bit value
+inline uint8_t reduce(uint16_t v, uint16_t offset, int shift) {
+  uint32_t sum = std::min<uint32_t>(v + offset, 0xffff);
+  return static_cast<uint8_t>(std::min<uint32_t>(sum >> shift, 255));
+}
+
+void reduceRowScalar(const uint16_t *src, uint8_t *dst, int begin, int n,
+                     const RowOffsets &offsets, int shift) {
+  for (int x = begin; x < n; x++) {
+    dst[x] = reduce(src[x], offsets.values[x % DITHER_SIZE], shift);
+  }
+}
+
+#if defined(VIVICTPP_HAVE_AVX2)
+
+VIVICTPP_TARGET_AVX2 void reduceRowAvx2(const uint16_t *src, uint8_t *dst,
+                                        int n, const RowOffsets &offsets,
+                                        int shift) {
+  const __m256i offset =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(offsets.values));
+  const __m128i count = _mm_cvtsi32_si128(shift);
+  int x = 0;
+  for (; x + 32 <= n; x += 32) {
+    __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x));
+    __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x + 16));
+    a = _mm256_srl_epi16(_mm256_adds_epu16(a, offset), count);
+    b = _mm256_srl_epi16(_mm256_adds_epu16(b, offset), count);
+    // packus works per 128 bit lane, put the lanes back in order
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), packed);
+  }
+  reduceRowScalar(src, dst, x, n, offsets, shift);
+}
+
+#endif
+
+#if defined(VIVICTPP_HAVE_NEON)
+
+void reduceRowNeon(const uint16_t *src, uint8_t *dst, int n,
+                   const RowOffsets &offsets, int shift) {
+  const uint16x8_t offset = vld1q_u16(offsets.values);
+  const int16x8_t count = vdupq_n_s16(static_cast<int16_t>(-shift));
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    uint16x8_t a = vshlq_u16(vqaddq_u16(vld1q_u16(src + x), offset), count);
+    uint16x8_t b =
+        vshlq_u16(vqaddq_u16(vld1q_u16(src + x + 8), offset), count);
+    vst1q_u8(dst + x, vcombine_u8(vqmovn_u16(a), vqmovn_u16(b)));
+  }
+  reduceRowScalar(src, dst, x, n, offsets, shift);
+}
+
+#endif
+
+} // namespace
+
+void vivictpp::video::reduceBitDepth(const Plane<const uint16_t> &src,
+                                     int bitDepth, const Plane<uint8_t> &dst,
+                                     bool dither, SimdLevel simdLevel) {
+  const int shift = std::clamp(bitDepth, 9, 16) - 8;
+  const int width = std::min(src.width, dst.width);
+  const int height = std::min(src.height, dst.height);
+  for (int y = 0; y < height; y++) {
+    const uint16_t *in = src.data + static_cast<ptrdiff_t>(y) * src.stride;
+    uint8_t *out = dst.data + static_cast<ptrdiff_t>(y) * dst.stride;
+    RowOffsets offsets = rowOffsets(y, shift, dither);
+    switch (simdLevel) {
+#if defined(VIVICTPP_HAVE_AVX2)
+    case SimdLevel::AVX2:
+      reduceRowAvx2(in, out, width, offsets, shift);
+      break;
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+    case SimdLevel::NEON:
+      reduceRowNeon(in, out, width, offsets, shift);
+      break;
+#endif
+    default:
+      reduceRowScalar(in, out, 0, width, offsets, shift);
+    }
+  }
+}
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/CpuFeatures.hh"
+
+#if defined(VIVICTPP_HAVE_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+#ifdef VIVICTPP_HAVE_AVX2
+bool cpuSupportsAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx) {
+    return false;
+  }
+  // The OS must save the ymm registers on context switch
+  if ((_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#endif
+}
+#endif
+
+} // namespace
+
+vivictpp::video::SimdLevel vivictpp::video::detectSimdLevel() {
+  static const SimdLevel simdLevel = []() {
+#if defined(VIVICTPP_HAVE_AVX2)
+    return cpuSupportsAvx2() ? SimdLevel::AVX2 : SimdLevel::SCALAR;
+#elif defined(VIVICTPP_HAVE_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::SCALAR;
+#endif
+  }();
+  return simdLevel;
+}
+
+const char *vivictpp::video::simdLevelName(SimdLevel simdLevel) {
+  switch (simdLevel) {
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::NEON:
+    return "neon";
+  default:
+    return "scalar";
+  }
+}
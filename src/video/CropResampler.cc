@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/CropResampler.hh"
+
+#include "libav/AVErrorUtils.hh"
+
+#include <stdexcept>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+
+namespace {
+
+bool isTenBit(int format) { return format == AV_PIX_FMT_YUV420P10LE; }
+
+template <typename T>
+void resamplePlane(const AVFrame *src, AVFrame *dst, int plane,
+                   const vivictpp::video::SourceRect &rect, int width,
+                   int height) {
+  int stride = src->linesize[plane] / static_cast<int>(sizeof(T));
+  int dstStride = dst->linesize[plane] / static_cast<int>(sizeof(T));
+  int srcWidth = plane == 0 ? src->width : (src->width + 1) / 2;
+  int srcHeight = plane == 0 ? src->height : (src->height + 1) / 2;
+  vivictpp::video::bilinearResample(
+      vivictpp::video::Plane<const T>{
+          reinterpret_cast<const T *>(src->data[plane]), stride, srcWidth,
+          srcHeight},
+      rect,
+      vivictpp::video::Plane<T>{reinterpret_cast<T *>(dst->data[plane]),
+                                dstStride, width, height});
+}
+
+} // namespace
+
+bool vivictpp::video::canResampleCrop(const vivictpp::libav::Frame &frame) {
+  if (frame.empty()) {
+    return false;
+  }
+  int format = frame.avFrame()->format;
+  return format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P ||
+         isTenBit(format);
+}
+
+vivictpp::libav::Frame
+vivictpp::video::resampleCrop(const vivictpp::libav::Frame &frame,
+                              const SourceRect &crop, int width, int height) {
+  if (!canResampleCrop(frame)) {
+    throw std::runtime_error("Unsupported pixel format for crop resampling");
+  }
+  const AVFrame *src = frame.avFrame();
+  vivictpp::libav::Frame result;
+  AVFrame *dst = result.avFrame();
+  dst->format = src->format;
+  dst->width = width;
+  dst->height = height;
+  vivictpp::libav::AVResult ret = av_frame_get_buffer(dst, 0);
+  ret.throwOnError("Failed to allocate frame buffer");
+  ret = av_frame_copy_props(dst, src);
+  ret.throwOnError("Failed to copy frame props");
+
+  const SourceRect chromaCrop = {crop.x / 2, crop.y / 2, crop.w / 2,
+                                 crop.h / 2};
+  const int chromaWidth = (width + 1) / 2;
+  const int chromaHeight = (height + 1) / 2;
+  if (isTenBit(src->format)) {
+    resamplePlane<uint16_t>(src, dst, 0, crop, width, height);
+    resamplePlane<uint16_t>(src, dst, 1, chromaCrop, chromaWidth,
+                            chromaHeight);
+    resamplePlane<uint16_t>(src, dst, 2, chromaCrop, chromaWidth,
+                            chromaHeight);
+  } else {
+    resamplePlane<uint8_t>(src, dst, 0, crop, width, height);
+    resamplePlane<uint8_t>(src, dst, 1, chromaCrop, chromaWidth, chromaHeight);
+    resamplePlane<uint8_t>(src, dst, 2, chromaCrop, chromaWidth, chromaHeight);
+  }
+  return result;
+}
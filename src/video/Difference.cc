@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/Difference.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(VIVICTPP_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// PSNR range of the heatmap palette, blocks at or above HEATMAP_MAX_PSNR are
+// not coloured
+constexpr double HEATMAP_MIN_PSNR = 20.0;
+constexpr double HEATMAP_MAX_PSNR = 50.0;
+
+using Rgb = std::array<uint8_t, 3>;
+
+// Black through blue, cyan, green and yellow to red
+std::array<Rgb, 256> makePalette() {
+  const std::array<Rgb, 6> stops = {Rgb{0, 0, 0},     Rgb{0, 0, 180},
+                                    Rgb{0, 180, 180}, Rgb{0, 200, 0},
+                                    Rgb{255, 220, 0}, Rgb{255, 0, 0}};
+  std::array<Rgb, 256> palette;
+  for (int i = 0; i < 256; i++) {
+    double pos = i * (stops.size() - 1) / 255.0;
+    size_t stop = std::min(static_cast<size_t>(pos), stops.size() - 2);
+    double t = pos - stop;
+    for (int c = 0; c < 3; c++) {
+      palette[i][c] = static_cast<uint8_t>(
+          std::lround(stops[stop][c] * (1 - t) + stops[stop + 1][c] * t));
+    }
+  }
+  return palette;
+}
+
+const std::array<Rgb, 256> &palette() {
+  static const std::array<Rgb, 256> palette = makePalette();
+  return palette;
+}
+
+void absDifferenceScalar(const uint8_t *a, const uint8_t *b, uint8_t *dst,
+                         int begin, int n) {
+  for (int x = begin; x < n; x++) {
+    dst[x] = static_cast<uint8_t>(std::abs(a[x] - b[x]));
+  }
+}
+
+uint64_t squaredDifferenceScalar(const uint8_t *a, const uint8_t *b,
+                                 int begin, int n) {
+  uint64_t sum = 0;
+  for (int x = begin; x < n; x++) {
+    int d = a[x] - b[x];
+    sum += d * d;
+  }
+  return sum;
+}
+
+#if defined(VIVICTPP_HAVE_AVX2)
+
+VIVICTPP_TARGET_AVX2 void absDifferenceAvx2(const uint8_t *a, const uint8_t *b,
+                                            uint8_t *dst, int n) {
+  int x = 0;
+  for (; x + 32 <= n; x += 32) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + x));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + x));
+    __m256i d = _mm256_or_si256(_mm256_subs_epu8(va, vb),
+                                _mm256_subs_epu8(vb, va));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), d);
+  }
+  absDifferenceScalar(a, b, dst, x, n);
+}
+
+VIVICTPP_TARGET_AVX2 uint64_t squaredDifferenceAvx2(const uint8_t *a,
+                                                    const uint8_t *b, int n) {
+  // Each 32 bit lane gets at most 2 * 255^2 per iteration, rows would need
+  // to be millions of samples wide to overflow
+  __m256i acc = _mm256_setzero_si256();
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m256i va = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x)));
+    __m256i vb = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x)));
+    __m256i d = _mm256_sub_epi16(va, vb);
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+  }
+  alignas(32) uint32_t lanes[8];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  uint64_t sum = 0;
+  for (uint32_t lane : lanes) {
+    sum += lane;
+  }
+  return sum + squaredDifferenceScalar(a, b, x, n);
+}
+
+#endif
+
+#if defined(VIVICTPP_HAVE_NEON)
+
+void absDifferenceNeon(const uint8_t *a, const uint8_t *b, uint8_t *dst,
+                       int n) {
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    vst1q_u8(dst + x, vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x)));
+  }
+  absDifferenceScalar(a, b, dst, x, n);
+}
+
+uint64_t squaredDifferenceNeon(const uint8_t *a, const uint8_t *b, int n) {
+  uint32x4_t acc = vdupq_n_u32(0);
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    uint8x16_t d = vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x));
+    acc = vpadalq_u16(acc, vmull_u8(vget_low_u8(d), vget_low_u8(d)));
+    acc = vpadalq_u16(acc, vmull_u8(vget_high_u8(d), vget_high_u8(d)));
+  }
+  uint64x2_t sum2 = vpaddlq_u32(acc);
+  uint64_t sum = vgetq_lane_u64(sum2, 0) + vgetq_lane_u64(sum2, 1);
+  return sum + squaredDifferenceScalar(a, b, x, n);
+}
+
+#endif
+
+const uint8_t *row(const vivictpp::video::Plane<const uint8_t> &plane,
+                   int y) {
+  return plane.data + static_cast<ptrdiff_t>(y) * plane.stride;
+}
+
+uint8_t chromaU(const vivictpp::video::YuvPlanes &planes, int x, int y) {
+  return planes.interleavedChroma ? row(planes.u, y)[2 * x]
+                                  : row(planes.u, y)[x];
+}
+
+uint8_t chromaV(const vivictpp::video::YuvPlanes &planes, int x, int y) {
+  return planes.interleavedChroma ? row(planes.u, y)[2 * x + 1]
+                                  : row(planes.v, y)[x];
+}
+
+// Largest difference of the u and v samples at each chroma position
+std::vector<uint8_t>
+chromaDifference(const vivictpp::video::YuvPlanes &left,
+                 const vivictpp::video::YuvPlanes &right, int chromaWidth,
+                 int chromaHeight, vivictpp::video::SimdLevel simdLevel) {
+  using vivictpp::video::Plane;
+  std::vector<uint8_t> result(static_cast<size_t>(chromaWidth) *
+                              chromaHeight);
+  if (left.interleavedChroma != right.interleavedChroma) {
+    // An nv12 frame, usually from a hardware decoder, compared to a planar
+    // one. Rare enough to not need simd.
+    for (int y = 0; y < chromaHeight; y++) {
+      for (int x = 0; x < chromaWidth; x++) {
+        result[static_cast<size_t>(y) * chromaWidth + x] = static_cast<uint8_t>(
+            std::max(std::abs(chromaU(left, x, y) - chromaU(right, x, y)),
+                     std::abs(chromaV(left, x, y) - chromaV(right, x, y))));
+      }
+    }
+    return result;
+  }
+  if (left.interleavedChroma) {
+    std::vector<uint8_t> uv(result.size() * 2);
+    vivictpp::video::absDifference(
+        left.u, right.u, {uv.data(), 2 * chromaWidth, 2 * chromaWidth,
+                          chromaHeight},
+        simdLevel);
+    for (size_t i = 0; i < result.size(); i++) {
+      result[i] = std::max(uv[2 * i], uv[2 * i + 1]);
+    }
+    return result;
+  }
+  std::vector<uint8_t> v(result.size());
+  vivictpp::video::absDifference(
+      left.u, right.u, {result.data(), chromaWidth, chromaWidth, chromaHeight},
+      simdLevel);
+  vivictpp::video::absDifference(
+      left.v, right.v, {v.data(), chromaWidth, chromaWidth, chromaHeight},
+      simdLevel);
+  for (size_t i = 0; i < result.size(); i++) {
+    result[i] = std::max(result[i], v[i]);
+  }
+  return result;
+}
+
+void renderDifference(const vivictpp::video::YuvPlanes &left,
+                      const vivictpp::video::YuvPlanes &right, int gain,
+                      vivictpp::video::SimdLevel simdLevel,
+                      vivictpp::video::DifferenceImage &image) {
+  const int width = image.width;
+  const int height = image.height;
+  const int chromaWidth = (width + 1) / 2;
+  std::vector<uint8_t> luma(static_cast<size_t>(width) * height);
+  vivictpp::video::absDifference(left.y, right.y,
+                                 {luma.data(), width, width, height},
+                                 simdLevel);
+  std::vector<uint8_t> chroma = chromaDifference(
+      left, right, chromaWidth, (height + 1) / 2, simdLevel);
+  std::array<uint8_t, 256> amplify;
+  for (int d = 0; d < 256; d++) {
+    amplify[d] = static_cast<uint8_t>(std::min(255, d * gain));
+  }
+  const std::array<Rgb, 256> &colors = palette();
+  for (int y = 0; y < height; y++) {
+    const uint8_t *lumaRow = luma.data() + static_cast<size_t>(y) * width;
+    const uint8_t *chromaRow =
+        chroma.data() + static_cast<size_t>(y / 2) * chromaWidth;
+    uint8_t *out = image.rgba.data() + static_cast<size_t>(y) * width * 4;
+    for (int x = 0; x < width; x++) {
+      uint8_t d = std::max(lumaRow[x], chromaRow[x / 2]);
+      const Rgb &color = colors[amplify[d]];
+      out[4 * x] = color[0];
+      out[4 * x + 1] = color[1];
+      out[4 * x + 2] = color[2];
+      out[4 * x + 3] = 255;
+    }
+  }
+}
+
+void renderHeatmap(const vivictpp::video::YuvPlanes &left,
+                   const vivictpp::video::YuvPlanes &right,
+                   vivictpp::video::SimdLevel simdLevel,
+                   vivictpp::video::DifferenceImage &image) {
+  using vivictpp::video::HEATMAP_BLOCK_SIZE;
+  using vivictpp::video::Plane;
+  const int width = image.width;
+  const int height = image.height;
+  const std::array<Rgb, 256> &colors = palette();
+  for (int by = 0; by < height; by += HEATMAP_BLOCK_SIZE) {
+    int blockHeight = std::min(HEATMAP_BLOCK_SIZE, height - by);
+    for (int bx = 0; bx < width; bx += HEATMAP_BLOCK_SIZE) {
+      int blockWidth = std::min(HEATMAP_BLOCK_SIZE, width - bx);
+      Plane<const uint8_t> a{row(left.y, by) + bx, left.y.stride, blockWidth,
+                             blockHeight};
+      Plane<const uint8_t> b{row(right.y, by) + bx, right.y.stride,
+                             blockWidth, blockHeight};
+      double blockPsnr = vivictpp::video::psnr(
+          vivictpp::video::sumSquaredDifference(a, b, simdLevel),
+          static_cast<uint64_t>(blockWidth) * blockHeight);
+      double t = (HEATMAP_MAX_PSNR - blockPsnr) /
+                 (HEATMAP_MAX_PSNR - HEATMAP_MIN_PSNR);
+      int level = static_cast<int>(std::lround(std::clamp(t, 0.0, 1.0) * 255));
+      const Rgb &color = colors[level];
+      // Blocks are drawn over the left frame at 40% brightness, more opaque
+      // the worse they are
+      int alpha = level == 0 ? 0 : 128 + level / 2;
+      for (int y = by; y < by + blockHeight; y++) {
+        const uint8_t *lumaRow = row(left.y, y);
+        uint8_t *out = image.rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = bx; x < bx + blockWidth; x++) {
+          int gray = lumaRow[x] * 2 / 5;
+          for (int c = 0; c < 3; c++) {
+            out[4 * x + c] = static_cast<uint8_t>(
+                (gray * (255 - alpha) + color[c] * alpha) / 255);
+          }
+          out[4 * x + 3] = 255;
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+void vivictpp::video::absDifference(const Plane<const uint8_t> &a,
+                                    const Plane<const uint8_t> &b,
+                                    const Plane<uint8_t> &dst,
+                                    SimdLevel simdLevel) {
+  for (int y = 0; y < dst.height; y++) {
+    const uint8_t *rowA = row(a, y);
+    const uint8_t *rowB = row(b, y);
+    uint8_t *out = dst.data + static_cast<ptrdiff_t>(y) * dst.stride;
+    switch (simdLevel) {
+#if defined(VIVICTPP_HAVE_AVX2)
+    case SimdLevel::AVX2:
+      absDifferenceAvx2(rowA, rowB, out, dst.width);
+      break;
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+    case SimdLevel::NEON:
+      absDifferenceNeon(rowA, rowB, out, dst.width);
+      break;
+#endif
+    default:
+      absDifferenceScalar(rowA, rowB, out, 0, dst.width);
+    }
+  }
+}
+
+uint64_t vivictpp::video::sumSquaredDifference(const Plane<const uint8_t> &a,
+                                               const Plane<const uint8_t> &b,
+                                               SimdLevel simdLevel) {
+  uint64_t sum = 0;
+  for (int y = 0; y < a.height; y++) {
+    const uint8_t *rowA = row(a, y);
+    const uint8_t *rowB = row(b, y);
+    switch (simdLevel) {
+#if defined(VIVICTPP_HAVE_AVX2)
+    case SimdLevel::AVX2:
+      sum += squaredDifferenceAvx2(rowA, rowB, a.width);
+      break;
+#endif
+#if defined(VIVICTPP_HAVE_NEON)
+    case SimdLevel::NEON:
+      sum += squaredDifferenceNeon(rowA, rowB, a.width);
+      break;
+#endif
+    default:
+      sum += squaredDifferenceScalar(rowA, rowB, 0, a.width);
+    }
+  }
+  return sum;
+}
+
+double vivictpp::video::psnr(uint64_t sse, uint64_t samples) {
+  if (sse == 0 || samples == 0) {
+    return MAX_PSNR;
+  }
+  double mse = static_cast<double>(sse) / samples;
+  return std::min(MAX_PSNR, 10.0 * std::log10(255.0 * 255.0 / mse));
+}
+
+vivictpp::video::DifferenceImage
+vivictpp::video::differenceImage(const YuvPlanes &left, const YuvPlanes &right,
+                                 DifferenceMode mode, int gain,
+                                 SimdLevel simdLevel) {
+  DifferenceImage image;
+  image.width = left.y.width;
+  image.height = left.y.height;
+  image.rgba.resize(static_cast<size_t>(image.width) * image.height * 4);
+  image.psnr = psnr(sumSquaredDifference(left.y, right.y, simdLevel),
+                    static_cast<uint64_t>(image.width) * image.height);
+  if (mode == DifferenceMode::HEATMAP) {
+    renderHeatmap(left, right, simdLevel, image);
+  } else {
+    renderDifference(left, right, gain, simdLevel, image);
+  }
+  return image;
+}
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/DifferenceWorker.hh"
+
+#include "video/CropResampler.hh"
+
+namespace {
+
+bool isSupported(const AVFrame *frame) {
+  return frame->format == AV_PIX_FMT_YUV420P ||
+         frame->format == AV_PIX_FMT_YUVJ420P ||
+         frame->format == AV_PIX_FMT_NV12;
+}
+
+vivictpp::video::Plane<const uint8_t> plane(const AVFrame *frame, int index,
+                                            int width, int height) {
+  return {frame->data[index], frame->linesize[index], width, height};
+}
+
+vivictpp::video::YuvPlanes yuvPlanes(const AVFrame *frame) {
+  int chromaWidth = (frame->width + 1) / 2;
+  int chromaHeight = (frame->height + 1) / 2;
+  if (frame->format == AV_PIX_FMT_NV12) {
+    return {plane(frame, 0, frame->width, frame->height),
+            plane(frame, 1, 2 * chromaWidth, chromaHeight),
+            plane(frame, 1, 2 * chromaWidth, chromaHeight), true};
+  }
+  return {plane(frame, 0, frame->width, frame->height),
+          plane(frame, 1, chromaWidth, chromaHeight),
+          plane(frame, 2, chromaWidth, chromaHeight), false};
+}
+
+} // namespace
+
+vivictpp::video::DifferenceWorker::DifferenceWorker()
+    : logger(vivictpp::logging::getOrCreateLogger(
+          "vivictpp::video::DifferenceWorker")),
+      thread(&DifferenceWorker::run, this) {}
+
+vivictpp::video::DifferenceWorker::~DifferenceWorker() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    stopped = true;
+  }
+  requested.notify_all();
+  thread.join();
+}
+
+vivictpp::video::DifferenceWorker::Image
+vivictpp::video::DifferenceWorker::get(const vivictpp::libav::Frame &left,
+                                       const vivictpp::libav::Frame &right,
+                                       DifferenceMode mode, bool playing) {
+  if (left.empty() || right.empty() || mode == DifferenceMode::OFF) {
+    return nullptr;
+  }
+  Key key{left.pts(), right.pts(), mode};
+  std::lock_guard<std::mutex> lock(m);
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->first == key) {
+      cache.splice(cache.begin(), cache, it);
+      return it->second;
+    }
+  }
+  if (latest && latest->first == key) {
+    return latest->second;
+  }
+  if (inProgress == key || (pending && pending->key == key)) {
+    return nullptr;
+  }
+  // Frames are shared, not copied, decoded frames are never modified
+  pending = Request{key, left.share(), right.share(), generation, playing};
+  requested.notify_one();
+  return nullptr;
+}
+
+void vivictpp::video::DifferenceWorker::clear() {
+  std::lock_guard<std::mutex> lock(m);
+  cache.clear();
+  cachedBytes = 0;
+  latest.reset();
+  pending.reset();
+  generation++;
+}
+
+void vivictpp::video::DifferenceWorker::run() {
+  std::unique_lock<std::mutex> lock(m);
+  while (true) {
+    requested.wait(lock, [this] { return stopped || pending; });
+    if (stopped) {
+      return;
+    }
+    Request request = std::move(*pending);
+    pending.reset();
+    inProgress = request.key;
+    lock.unlock();
+    Image image = compute(request);
+    if (image->width == 0) {
+      VPP_LOG_DEBUG(logger, "Pixel formats not supported by difference view");
+    }
+    lock.lock();
+    inProgress.reset();
+    if (request.generation != generation) {
+      continue;
+    }
+    if (request.playing) {
+      latest.emplace(request.key, image);
+    } else {
+      insert(request.key, image);
+    }
+  }
+}
+
+void vivictpp::video::DifferenceWorker::insert(const Key &key,
+                                               const Image &image) {
+  cache.emplace_front(key, image);
+  cachedBytes += image->rgba.size();
+  while (cachedBytes > MAX_CACHED_BYTES && cache.size() > 1) {
+    cachedBytes -= cache.back().second->rgba.size();
+    cache.pop_back();
+  }
+}
+
+vivictpp::video::DifferenceWorker::Image
+vivictpp::video::DifferenceWorker::compute(const Request &request) {
+  const AVFrame *left = request.left.avFrame();
+  vivictpp::libav::Frame right = request.right.share();
+  if (!isSupported(left) || !isSupported(right.avFrame())) {
+    return std::make_shared<const DifferenceImage>();
+  }
+  // Inputs of different resolution are compared at the size of the left one,
+  // differing chroma layouts are handled by differenceImage
+  if (right->width != left->width || right->height != left->height) {
+    if (!canResampleCrop(right)) {
+      return std::make_shared<const DifferenceImage>();
+    }
+    right = resampleCrop(right,
+                         {0, 0, static_cast<double>(right->width),
+                          static_cast<double>(right->height)},
+                         left->width, left->height);
+  }
+  auto image = std::make_shared<DifferenceImage>(
+      differenceImage(yuvPlanes(left), yuvPlanes(right.avFrame()),
+                      std::get<DifferenceMode>(request.key), GAIN));
+  return image;
+}
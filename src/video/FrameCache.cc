@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/FrameCache.hh"
+
+namespace {
+
+size_t frameBytes(const AVFrame *frame) {
+  size_t size = 0;
+  for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++) {
+    size += frame->buf[i]->size;
+  }
+  return size;
+}
+
+} // namespace
+
+vivictpp::video::FrameCache::FrameCache(size_t maxBytes)
+    : maxBytes(maxBytes) {}
+
+void vivictpp::video::FrameCache::put(const std::string &source,
+                                      vivictpp::time::Time pts,
+                                      vivictpp::time::Time nextPts,
+                                      const vivictpp::libav::Frame &frame) {
+  if (frame.empty() || frame->hw_frames_ctx ||
+      vivictpp::time::isNoPts(pts)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m);
+  std::map<vivictpp::time::Time, Entry> &frames = sources[source];
+  auto it = frames.find(pts);
+  if (it != frames.end()) {
+    if (!vivictpp::time::isNoPts(nextPts)) {
+      it->second.nextPts = nextPts;
+    }
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return;
+  }
+  lru.emplace_front(source, pts);
+  size_t size = frameBytes(frame.avFrame());
+  // Frames are shared, not copied, shown frames are never modified
+  frames.emplace(pts, Entry{frame.share(), nextPts, size, lru.begin()});
+  _bytes += size;
+  evict();
+}
+
+vivictpp::libav::Frame
+vivictpp::video::FrameCache::get(const std::string &source,
+                                 vivictpp::time::Time pts) {
+  std::lock_guard<std::mutex> lock(m);
+  auto sourceIt = sources.find(source);
+  if (sourceIt == sources.end()) {
+    return vivictpp::libav::Frame::emptyFrame();
+  }
+  std::map<vivictpp::time::Time, Entry> &frames = sourceIt->second;
+  auto it = frames.upper_bound(pts);
+  if (it == frames.begin()) {
+    return vivictpp::libav::Frame::emptyFrame();
+  }
+  --it;
+  Entry &entry = it->second;
+  bool shown = it->first == pts ||
+               (!vivictpp::time::isNoPts(entry.nextPts) && pts < entry.nextPts);
+  if (!shown) {
+    return vivictpp::libav::Frame::emptyFrame();
+  }
+  lru.splice(lru.begin(), lru, entry.lruPos);
+  return entry.frame.share();
+}
+
+void vivictpp::video::FrameCache::evict() {
+  // The most recently used frame is always kept, it is about to be shown
+  while (_bytes > maxBytes && lru.size() > 1) {
+    auto sourceIt = sources.find(lru.back().first);
+    auto it = sourceIt->second.find(lru.back().second);
+    _bytes -= it->second.size;
+    sourceIt->second.erase(it);
+    if (sourceIt->second.empty()) {
+      sources.erase(sourceIt);
+    }
+    lru.pop_back();
+  }
+}
+
+void vivictpp::video::FrameCache::clear() {
+  std::lock_guard<std::mutex> lock(m);
+  sources.clear();
+  lru.clear();
+  _bytes = 0;
+}
+
+size_t vivictpp::video::FrameCache::size() {
+  std::lock_guard<std::mutex> lock(m);
+  return lru.size();
+}
+
+size_t vivictpp::video::FrameCache::bytes() {
+  std::lock_guard<std::mutex> lock(m);
+  return _bytes;
+}
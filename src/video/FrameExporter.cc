@@ -0,0 +1,332 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/FrameExporter.hh"
+
+#include "libav/AVErrorUtils.hh"
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+void freeCodecContext(AVCodecContext *codecContext) {
+  avcodec_free_context(&codecContext);
+}
+
+void freePacket(AVPacket *packet) { av_packet_free(&packet); }
+
+AVCodecID codecId(vivictpp::video::ExportFormat format) {
+  switch (format) {
+  case vivictpp::video::ExportFormat::TIFF:
+    return AV_CODEC_ID_TIFF;
+  case vivictpp::video::ExportFormat::PGM:
+    return AV_CODEC_ID_PGM;
+  default:
+    return AV_CODEC_ID_PNG;
+  }
+}
+
+AVPixelFormat imagePixelFormat(vivictpp::video::ExportFormat format,
+                               bool deep) {
+  switch (format) {
+  case vivictpp::video::ExportFormat::PGM:
+    return deep ? AV_PIX_FMT_GRAY16BE : AV_PIX_FMT_GRAY8;
+  case vivictpp::video::ExportFormat::TIFF:
+    return deep ? AV_PIX_FMT_RGB48LE : AV_PIX_FMT_RGB24;
+  default:
+    return deep ? AV_PIX_FMT_RGB48BE : AV_PIX_FMT_RGB24;
+  }
+}
+
+// New reference to the crop area of frame, the frame itself is not changed
+vivictpp::libav::Frame crop(const vivictpp::libav::Frame &frame,
+                            const vivictpp::video::CropRect &rect) {
+  vivictpp::libav::Frame cropped(frame);
+  if (rect.w <= 0 || rect.h <= 0) {
+    return cropped;
+  }
+  // Even position so that subsampled chroma stays aligned with luma
+  int x = std::clamp(rect.x, 0, frame->width - 1) & ~1;
+  int y = std::clamp(rect.y, 0, frame->height - 1) & ~1;
+  int w = std::clamp(rect.w, 1, frame->width - x);
+  int h = std::clamp(rect.h, 1, frame->height - y);
+  cropped->crop_left = x;
+  cropped->crop_top = y;
+  cropped->crop_right = frame->width - x - w;
+  cropped->crop_bottom = frame->height - y - h;
+  vivictpp::libav::AVResult ret =
+      av_frame_apply_cropping(cropped.avFrame(), AV_FRAME_CROP_UNALIGNED);
+  ret.throwOnError("Failed to crop frame");
+  return cropped;
+}
+
+vivictpp::libav::Frame convert(const vivictpp::libav::Frame &frame,
+                               AVPixelFormat dstFormat) {
+  AVPixelFormat srcFormat = (AVPixelFormat)frame->format;
+  SwsContext *swsContext = sws_getContext(
+      frame->width, frame->height, srcFormat, frame->width, frame->height,
+      dstFormat, SWS_POINT | SWS_ACCURATE_RND | SWS_FULL_CHR_H_INT, nullptr,
+      nullptr, nullptr);
+  if (!swsContext) {
+    throw std::runtime_error(std::string("Can not convert from ") +
+                             av_get_pix_fmt_name(srcFormat));
+  }
+  std::unique_ptr<SwsContext, void (*)(SwsContext *)> swsGuard(
+      swsContext, sws_freeContext);
+  int colorspace = frame->colorspace == AVCOL_SPC_UNSPECIFIED
+                       ? SWS_CS_DEFAULT
+                       : frame->colorspace;
+  const int *coefficients = sws_getCoefficients(colorspace);
+  int srcRange = frame->color_range == AVCOL_RANGE_JPEG ||
+                 srcFormat == AV_PIX_FMT_YUVJ420P;
+  // Luma is written as is to pgm, rgb is always full range
+  bool gray = dstFormat == AV_PIX_FMT_GRAY8 || dstFormat == AV_PIX_FMT_GRAY16BE;
+  int dstRange = gray ? srcRange : 1;
+  sws_setColorspaceDetails(swsContext, coefficients, srcRange, coefficients,
+                           dstRange, 0, 1 << 16, 1 << 16);
+
+  vivictpp::libav::Frame converted;
+  converted->format = dstFormat;
+  converted->width = frame->width;
+  converted->height = frame->height;
+  vivictpp::libav::AVResult ret = av_frame_get_buffer(converted.avFrame(), 0);
+  ret.throwOnError("Failed to allocate image");
+  sws_scale(swsContext, frame->data, frame->linesize, 0, frame->height,
+            converted->data, converted->linesize);
+  return converted;
+}
+
+std::vector<uint8_t> encode(const vivictpp::libav::Frame &frame,
+                            AVCodecID id) {
+  const AVCodec *codec = avcodec_find_encoder(id);
+  if (!codec) {
+    throw std::runtime_error(std::string("No encoder for ") +
+                             avcodec_get_name(id));
+  }
+  std::unique_ptr<AVCodecContext, void (*)(AVCodecContext *)> codecContext(
+      avcodec_alloc_context3(codec), freeCodecContext);
+  codecContext->width = frame->width;
+  codecContext->height = frame->height;
+  codecContext->pix_fmt = (AVPixelFormat)frame->format;
+  codecContext->time_base = {1, 1};
+  vivictpp::libav::AVResult ret =
+      avcodec_open2(codecContext.get(), codec, nullptr);
+  ret.throwOnError("Failed to open image encoder");
+  ret = avcodec_send_frame(codecContext.get(), frame.avFrame());
+  ret.throwOnError("Failed to encode image");
+  ret = avcodec_send_frame(codecContext.get(), nullptr);
+  ret.throwOnError("Failed to encode image");
+  std::unique_ptr<AVPacket, void (*)(AVPacket *)> packet(av_packet_alloc(),
+                                                         freePacket);
+  ret = avcodec_receive_packet(codecContext.get(), packet.get());
+  ret.throwOnError("Failed to encode image");
+  return std::vector<uint8_t>(packet->data, packet->data + packet->size);
+}
+
+} // namespace
+
+vivictpp::video::ExportFormat
+vivictpp::video::parseExportFormat(const std::string &name) {
+  if (name == "tiff") {
+    return ExportFormat::TIFF;
+  }
+  if (name == "pgm") {
+    return ExportFormat::PGM;
+  }
+  return ExportFormat::PNG;
+}
+
+const char *vivictpp::video::exportFormatExtension(ExportFormat format) {
+  switch (format) {
+  case ExportFormat::TIFF:
+    return "tiff";
+  case ExportFormat::PGM:
+    return "pgm";
+  default:
+    return "png";
+  }
+}
+
+std::vector<uint8_t>
+vivictpp::video::encodeImage(const vivictpp::libav::Frame &frame,
+                             ExportFormat format, const CropRect &rect) {
+  vivictpp::libav::Frame source = frame.share();
+  if (source->hw_frames_ctx) {
+    // Transferred to the first format the hardware supports
+    source = source.transferHwData(AV_PIX_FMT_NONE);
+  }
+  const AVPixFmtDescriptor *desc =
+      av_pix_fmt_desc_get((AVPixelFormat)source->format);
+  if (!desc) {
+    throw std::runtime_error("Frame has no pixel format");
+  }
+  bool deep = desc->comp[0].depth > 8;
+  vivictpp::libav::Frame image =
+      convert(crop(source, rect), imagePixelFormat(format, deep));
+  return encode(image, codecId(format));
+}
+
+vivictpp::video::FrameExporter::FrameExporter(int nThreads)
+    : logger(vivictpp::logging::getOrCreateLogger(
+          "vivictpp::video::FrameExporter")) {
+  for (int i = 0; i < std::max(1, nThreads); i++) {
+    threads.emplace_back(&FrameExporter::run, this);
+  }
+}
+
+vivictpp::video::FrameExporter::~FrameExporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+    queue = {};
+  }
+  queueChanged.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+int vivictpp::video::FrameExporter::defaultThreadCount() {
+  return std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 8);
+}
+
+void vivictpp::video::FrameExporter::submit(
+    const vivictpp::libav::Frame &frame, std::filesystem::path path,
+    ExportFormat format, const CropRect &crop) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push({frame.share(), std::move(path), format, crop});
+  }
+  queueChanged.notify_all();
+}
+
+size_t vivictpp::video::FrameExporter::pending() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.size() + busy;
+}
+
+size_t vivictpp::video::FrameExporter::written() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return _written;
+}
+
+size_t vivictpp::video::FrameExporter::failed() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return _failed;
+}
+
+void vivictpp::video::FrameExporter::finish() {
+  std::unique_lock<std::mutex> lock(mutex);
+  queueChanged.wait(lock,
+                    [this] { return stopped || (queue.empty() && busy == 0); });
+}
+
+void vivictpp::video::FrameExporter::run() {
+  vivictpp::tracing::setThreadName("vivictpp::video::FrameExporter");
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      queueChanged.wait(lock, [this] { return stopped || !queue.empty(); });
+      if (stopped) {
+        return;
+      }
+      job = std::move(queue.front());
+      queue.pop();
+      busy++;
+    }
+    bool ok = false;
+    try {
+      VPP_TRACE_SPAN("image_export");
+      std::vector<uint8_t> image = encodeImage(job.frame, job.format, job.crop);
+      std::error_code ec;
+      std::filesystem::create_directories(job.path.parent_path(), ec);
+      std::ofstream out(job.path, std::ios::binary);
+      out.write(reinterpret_cast<const char *>(image.data()), image.size());
+      out.close();
+      ok = static_cast<bool>(out);
+      if (!ok) {
+        logger->warn("Failed to write {}", job.path.string());
+      }
+    } catch (const std::exception &e) {
+      logger->warn("Failed to export {}: {}", job.path.string(), e.what());
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busy--;
+      (ok ? _written : _failed)++;
+    }
+    queueChanged.notify_all();
+  }
+}
+
+vivictpp::video::ExportSelection vivictpp::video::selectExportFrames(
+    const std::vector<std::vector<vivictpp::time::Time>> &buffered,
+    vivictpp::time::Time from, vivictpp::time::Time to, size_t maxFrames,
+    std::vector<vivictpp::time::Time> &exportedPts) {
+  using vivictpp::time::isNoPts;
+  ExportSelection selection;
+  selection.frames.resize(buffered.size());
+  // NO_TIME is the smallest pts, so inputs without frames come first
+  std::vector<size_t> order(buffered.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return exportedPts[a] < exportedPts[b];
+  });
+  size_t remaining = maxFrames;
+  bool done = true;
+  bool canStep = true;
+  for (size_t n = 0; n < order.size(); n++) {
+    size_t i = order[n];
+    const std::vector<vivictpp::time::Time> &pts = buffered[i];
+    size_t budget = (remaining + order.size() - n - 1) / (order.size() - n);
+    size_t start = 0;
+    while (isNoPts(exportedPts[i]) && start + 1 < pts.size() &&
+           pts[start + 1] <= from) {
+      start++;
+    }
+    bool inputDone = false;
+    for (size_t j = start; j < pts.size(); j++) {
+      // Frames after to are only used to know when an input is done
+      if (pts[j] > to) {
+        inputDone = true;
+        break;
+      }
+      if (budget == 0) {
+        break;
+      }
+      budget--;
+      remaining--;
+      exportedPts[i] = pts[j];
+      selection.frames[i].push_back(j);
+    }
+    inputDone = inputDone || (!isNoPts(exportedPts[i]) && exportedPts[i] >= to);
+    done = done && inputDone;
+    if (inputDone) {
+      continue;
+    }
+    if (isNoPts(exportedPts[i])) {
+      canStep = false;
+    } else if (isNoPts(selection.stepPts) ||
+               exportedPts[i] < selection.stepPts) {
+      selection.stepPts = exportedPts[i];
+    }
+  }
+  selection.done = done;
+  if (!canStep) {
+    selection.stepPts = vivictpp::time::NO_TIME;
+  }
+  return selection;
+}
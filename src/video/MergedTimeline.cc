@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/MergedTimeline.hh"
+
+#include <algorithm>
+#include <utility>
+
+vivictpp::video::MergedTimeline::MergedTimeline(
+    const std::vector<std::vector<vivictpp::time::Time>> &ptsValues,
+    const std::vector<vivictpp::time::Time> &offsets,
+    vivictpp::time::Time tolerance) {
+  size_t nInputs = ptsValues.size();
+  // (timeline pts, input) of all frames
+  std::vector<std::pair<vivictpp::time::Time, size_t>> frames;
+  for (size_t i = 0; i < nInputs; i++) {
+    std::vector<vivictpp::time::Time> sorted = ptsValues[i];
+    sorted.erase(
+        std::remove(sorted.begin(), sorted.end(), vivictpp::time::NO_TIME),
+        sorted.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (vivictpp::time::Time pts : sorted) {
+      frames.push_back({pts - offsets[i], i});
+    }
+    framePtsValues.push_back(std::move(sorted));
+  }
+  std::sort(frames.begin(), frames.end());
+  frameIndexes.resize(nInputs);
+
+  std::vector<int32_t> shown(nInputs, -1);
+  std::vector<bool> inStep(nInputs, false);
+  size_t i = 0;
+  while (i < frames.size()) {
+    // A step takes at most one frame per input within tolerance of its first
+    // frame, and is shown at the pts of its last frame
+    vivictpp::time::Time first = frames[i].first;
+    vivictpp::time::Time last = first;
+    std::fill(inStep.begin(), inStep.end(), false);
+    while (i < frames.size() && frames[i].first - first <= tolerance &&
+           !inStep[frames[i].second]) {
+      inStep[frames[i].second] = true;
+      shown[frames[i].second]++;
+      last = frames[i].first;
+      i++;
+    }
+    steps.push_back(last);
+    for (size_t input = 0; input < nInputs; input++) {
+      frameIndexes[input].push_back(shown[input]);
+    }
+  }
+}
+
+size_t vivictpp::video::MergedTimeline::stepAt(vivictpp::time::Time pts,
+                                               size_t hint) const {
+  if (steps.empty()) {
+    return 0;
+  }
+  if (hint < steps.size() && steps[hint] <= pts &&
+      (hint + 1 == steps.size() || steps[hint + 1] > pts)) {
+    return hint;
+  }
+  auto it = std::upper_bound(steps.begin(), steps.end(), pts);
+  return it == steps.begin() ? 0 : (it - steps.begin()) - 1;
+}
+
+vivictpp::time::Time
+vivictpp::video::MergedTimeline::nextPts(vivictpp::time::Time pts) const {
+  if (steps.empty()) {
+    return vivictpp::time::NO_TIME;
+  }
+  if (pts < steps.front()) {
+    return steps.front();
+  }
+  lastStep = stepAt(pts, lastStep);
+  if (lastStep + 1 >= steps.size()) {
+    return vivictpp::time::NO_TIME;
+  }
+  lastStep++;
+  return steps[lastStep];
+}
+
+vivictpp::time::Time
+vivictpp::video::MergedTimeline::previousPts(vivictpp::time::Time pts) const {
+  if (steps.empty() || pts <= steps.front()) {
+    return vivictpp::time::NO_TIME;
+  }
+  lastStep = stepAt(pts, lastStep);
+  if (steps[lastStep] == pts) {
+    lastStep--;
+  }
+  return steps[lastStep];
+}
+
+vivictpp::time::Time
+vivictpp::video::MergedTimeline::framePts(size_t step, size_t input) const {
+  int index = frameIndexes[input][step];
+  return index < 0 ? vivictpp::time::NO_TIME : framePtsValues[input][index];
+}
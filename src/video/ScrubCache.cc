@@ -0,0 +1,307 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/ScrubCache.hh"
+
+#include "libav/Decoder.hh"
+#include "libav/Filter.hh"
+#include "libav/FormatHandler.hh"
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+// Give up on a target if no key frame shows up within this many packets
+constexpr int MAX_PACKETS_PER_TARGET = 1000;
+
+vivictpp::libav::Frame resize(const vivictpp::libav::Frame &frame, int width,
+                              int height) {
+  AVPixelFormat format = (AVPixelFormat)frame->format;
+  SwsContext *swsContext =
+      sws_getContext(frame->width, frame->height, format, width, height,
+                     format, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+  if (!swsContext) {
+    throw std::runtime_error(std::string("Can not scale ") +
+                             av_get_pix_fmt_name(format));
+  }
+  std::unique_ptr<SwsContext, void (*)(SwsContext *)> swsGuard(
+      swsContext, sws_freeContext);
+  vivictpp::libav::Frame resized;
+  resized->format = format;
+  resized->width = width;
+  resized->height = height;
+  vivictpp::libav::AVResult ret = av_frame_get_buffer(resized.avFrame(), 0);
+  ret.throwOnError("Failed to allocate frame");
+  av_frame_copy_props(resized.avFrame(), frame.avFrame());
+  sws_scale(swsContext, frame->data, frame->linesize, 0, frame->height,
+            resized->data, resized->linesize);
+  return resized;
+}
+
+size_t frameSize(const vivictpp::libav::Frame &frame) {
+  return std::max(0, av_image_get_buffer_size((AVPixelFormat)frame->format,
+                                              frame->width, frame->height,
+                                              1));
+}
+
+} // namespace
+
+std::vector<vivictpp::time::Time> vivictpp::video::scrubTargets(
+    const std::vector<vivictpp::time::Time> &keyFrames,
+    vivictpp::time::Time center, vivictpp::time::Time interval, int count) {
+  std::vector<vivictpp::time::Time> targets;
+  if (keyFrames.empty() || interval <= 0) {
+    return targets;
+  }
+  std::set<vivictpp::time::Time> seen;
+  // Grid steps needed to reach the first and last key frame from center
+  int64_t maxSteps = std::max(std::abs(center - keyFrames.front()),
+                              std::abs(keyFrames.back() - center)) /
+                         interval +
+                     1;
+  // Offsets 0, -1, 1, -2, 2, ... so that positions closest to center come
+  // first
+  for (int64_t i = 0; i <= 2 * maxSteps && (int)targets.size() < count; i++) {
+    int64_t step = (i % 2 == 0) ? i / 2 : -(i + 1) / 2;
+    vivictpp::time::Time position = center + step * interval;
+    auto it = std::upper_bound(keyFrames.begin(), keyFrames.end(), position);
+    if (it == keyFrames.begin()) {
+      continue;
+    }
+    vivictpp::time::Time keyFrame = *(it - 1);
+    if (seen.insert(keyFrame).second) {
+      targets.push_back(keyFrame);
+    }
+  }
+  return targets;
+}
+
+vivictpp::video::ScrubCache::ScrubCache(const std::string &source,
+                                        const std::string &formatOptions,
+                                        const std::string &customFilter,
+                                        std::shared_ptr<VideoIndex> videoIndex,
+                                        size_t maxBytes)
+    : source(source), formatOptions(formatOptions), customFilter(customFilter),
+      videoIndex(videoIndex), maxBytes(maxBytes),
+      logger(vivictpp::logging::getOrCreateLogger(
+          "vivictpp::video::ScrubCache")),
+      thread(&ScrubCache::run, this) {}
+
+vivictpp::video::ScrubCache::~ScrubCache() {
+  stopped = true;
+  centerChanged.notify_all();
+  thread.join();
+}
+
+void vivictpp::video::ScrubCache::setCenter(vivictpp::time::Time pts) {
+  if (vivictpp::time::isNoPts(pts)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    center = pts;
+    if (std::abs(pts - notifiedCenter) < interval / 2) {
+      return;
+    }
+    notifiedCenter = pts;
+  }
+  centerChanged.notify_all();
+}
+
+void vivictpp::video::ScrubCache::setActive(bool active) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (this->active == active) {
+      return;
+    }
+    this->active = active;
+    if (!active) {
+      // Only needed while scrubbing, and large
+      shownTarget = vivictpp::time::NO_TIME;
+      shownFrame = vivictpp::libav::Frame::emptyFrame();
+    }
+  }
+  centerChanged.notify_all();
+}
+
+vivictpp::libav::Frame
+vivictpp::video::ScrubCache::nearest(vivictpp::time::Time pts) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (frames.empty()) {
+    return vivictpp::libav::Frame::emptyFrame();
+  }
+  auto it = frames.lower_bound(pts);
+  if (it == frames.end() ||
+      (it != frames.begin() &&
+       pts - std::prev(it)->first <= it->first - pts)) {
+    it = std::prev(it);
+  }
+  if (it->first == shownTarget) {
+    return shownFrame.share();
+  }
+  vivictpp::time::Time target = it->first;
+  CachedFrame cached{it->second.frame.share(), it->second.width,
+                     it->second.height, it->second.bytes};
+  lock.unlock();
+  vivictpp::libav::Frame frame = std::move(cached.frame);
+  if (frame->width != cached.width || frame->height != cached.height) {
+    try {
+      frame = resize(frame, cached.width, cached.height);
+    } catch (const std::exception &e) {
+      logger->warn("Failed to scale scrub frame: {}", e.what());
+      return vivictpp::libav::Frame::emptyFrame();
+    }
+  }
+  lock.lock();
+  shownTarget = target;
+  shownFrame = frame.share();
+  return frame;
+}
+
+void vivictpp::video::ScrubCache::erase(
+    std::map<vivictpp::time::Time, CachedFrame>::iterator it) {
+  bytes -= it->second.bytes;
+  frames.erase(it);
+}
+
+// Returns the first target around the current center that is not cached yet,
+// and evicts cached frames that are no longer targets. When idle only the
+// targets nearest the center are returned.
+vivictpp::time::Time vivictpp::video::ScrubCache::nextTarget() {
+  std::vector<vivictpp::time::Time> keyFrames = videoIndex->copyKeyFrames();
+  std::lock_guard<std::mutex> lock(mutex);
+  // The nearest targets that fit in the byte budget
+  int count = CAPACITY;
+  if (frameBytes > 0) {
+    count = (int)std::clamp<size_t>(maxBytes / frameBytes, 1, CAPACITY);
+  }
+  std::vector<vivictpp::time::Time> targets =
+      scrubTargets(keyFrames, center, interval, count);
+  for (auto it = frames.begin(); it != frames.end();) {
+    auto next = std::next(it);
+    if (std::find(targets.begin(), targets.end(), it->first) ==
+        targets.end()) {
+      erase(it);
+    }
+    it = next;
+  }
+  for (auto it = failed.begin(); it != failed.end();) {
+    if (std::find(targets.begin(), targets.end(), *it) == targets.end()) {
+      it = failed.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  size_t wanted = active ? targets.size()
+                         : std::min<size_t>(targets.size(), IDLE_TARGETS);
+  for (size_t i = 0; i < wanted; i++) {
+    if (frames.find(targets[i]) == frames.end() &&
+        failed.find(targets[i]) == failed.end()) {
+      return targets[i];
+    }
+  }
+  return vivictpp::time::NO_TIME;
+}
+
+void vivictpp::video::ScrubCache::run() {
+  vivictpp::tracing::setThreadName("vivictpp::video::ScrubCache");
+  // Opened with the input, so that the first drag does not wait for it
+  try {
+    vivictpp::libav::FormatHandler formatHandler(source, formatOptions);
+    if (formatHandler.getVideoStreams().empty()) {
+      return;
+    }
+    AVStream *stream = formatHandler.getVideoStreams()[0];
+    formatHandler.setActiveStreams({stream->index});
+    vivictpp::libav::Decoder decoder(stream->codecpar,
+                                     vivictpp::libav::DecoderOptions());
+    vivictpp::libav::VideoFilter filter(stream, decoder.getCodecContext(),
+                                        customFilter.empty() ? "null"
+                                                             : customFilter);
+    vivictpp::time::Time duration = formatHandler.formatContext->duration;
+    if (!vivictpp::time::isNoPts(duration) && duration > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      interval = std::max(duration / (4 * CAPACITY),
+                          vivictpp::time::seconds(1));
+    }
+
+    while (!stopped) {
+      vivictpp::time::Time target = nextTarget();
+      if (vivictpp::time::isNoPts(target)) {
+        // Nothing to do until the center moves, but the index may still be
+        // growing so check again after a while
+        std::unique_lock<std::mutex> lock(mutex);
+        centerChanged.wait_for(lock, std::chrono::milliseconds(200));
+        continue;
+      }
+      VPP_TRACE_SPAN("scrub_decode");
+      formatHandler.seek(target);
+      vivictpp::libav::Frame frame = vivictpp::libav::Frame::emptyFrame();
+      for (int i = 0; i < MAX_PACKETS_PER_TARGET && !formatHandler.eof() &&
+                      frame.empty() && !stopped;
+           i++) {
+        AVPacket *packet = formatHandler.nextPacket();
+        if (packet == nullptr) {
+          continue;
+        }
+        if (packet->pts == AV_NOPTS_VALUE) {
+          av_packet_unref(packet);
+          continue;
+        }
+        vivictpp::time::Time pts = av_rescale_q(
+            packet->pts, stream->time_base, vivictpp::time::TIME_BASE_Q);
+        if ((packet->flags & AV_PKT_FLAG_KEY) && pts >= target) {
+          std::vector<vivictpp::libav::Frame> decoded =
+              decoder.handlePacket(packet);
+          for (auto &f : decoder.handlePacket(nullptr)) {
+            decoded.push_back(std::move(f));
+          }
+          decoder.flush();
+          for (auto &f : decoded) {
+            vivictpp::libav::Frame filtered = filter.filterFrame(f);
+            if (!filtered.empty()) {
+              frame = std::move(filtered);
+              break;
+            }
+          }
+        }
+        av_packet_unref(packet);
+      }
+      CachedFrame cached{vivictpp::libav::Frame::emptyFrame(), 0, 0, 0};
+      if (!frame.empty()) {
+        cached.width = frame->width;
+        cached.height = frame->height;
+        if (frame->height > MAX_HEIGHT) {
+          int width = std::max(
+              2, (int)((int64_t)frame->width * MAX_HEIGHT / frame->height) &
+                     ~1);
+          cached.frame = resize(frame, width, MAX_HEIGHT);
+        } else {
+          cached.frame = std::move(frame);
+        }
+        cached.bytes = frameSize(cached.frame);
+      }
+      // Failed targets are not retried until they fall out of the window
+      std::lock_guard<std::mutex> lock(mutex);
+      if (cached.frame.empty()) {
+        failed.insert(target);
+      } else {
+        frameBytes = cached.bytes;
+        bytes += cached.bytes;
+        frames.emplace(target, std::move(cached));
+      }
+    }
+  } catch (const std::exception &e) {
+    logger->warn("Scrub cache disabled: {}", e.what());
+  }
+}
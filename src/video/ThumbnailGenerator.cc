@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/ThumbnailGenerator.hh"
+
+#include "libav/Decoder.hh"
+#include "libav/Filter.hh"
+#include "tracing/Tracing.hh"
+
+#include <algorithm>
+
+namespace {
+
+std::string thumbnailFilterStr(int maxThumbnailSize) {
+  std::string filterStr = fmt::format(
+      "scale=w={}:h={}:force_original_aspect_ratio=decrease:flags=neighbor,"
+      "format=yuv420p",
+      maxThumbnailSize, maxThumbnailSize);
+  return filterStr;
+}
+
+class ThumbnailDecoder {
+private:
+  vivictpp::libav::Decoder decoder;
+  vivictpp::libav::VideoFilter filter;
+
+public:
+  ThumbnailDecoder(AVStream *stream, int maxThumbnailSize)
+      : decoder(stream->codecpar, vivictpp::libav::DecoderOptions()),
+        filter(stream, decoder.getCodecContext(),
+               thumbnailFilterStr(maxThumbnailSize)) {}
+
+  // Decodes a single key frame, flushing the decoder afterwards so that the
+  // next packet can come from anywhere in the stream
+  vivictpp::libav::Frame decode(vivictpp::libav::Packet packet) {
+    std::vector<vivictpp::libav::Frame> frames = decoder.handlePacket(packet);
+    for (auto &frame : decoder.handlePacket(nullptr)) {
+      frames.push_back(std::move(frame));
+    }
+    decoder.flush();
+    for (auto &frame : frames) {
+      vivictpp::libav::Frame filtered = filter.filterFrame(frame);
+      if (!filtered.empty()) {
+        return filtered;
+      }
+    }
+    return vivictpp::libav::Frame::emptyFrame();
+  }
+};
+
+} // namespace
+
+vivictpp::video::ThumbnailGenerator::ThumbnailGenerator(AVStream *stream,
+                                                        int maxThumbnailSize,
+                                                        int nThreads,
+                                                        Callback onThumbnail)
+    : stream(stream), maxThumbnailSize(maxThumbnailSize),
+      onThumbnail(onThumbnail), maxQueueSize(2 * std::max(1, nThreads)),
+      logger(vivictpp::logging::getOrCreateLogger(
+          "vivictpp::video::ThumbnailGenerator")) {
+  for (int i = 0; i < std::max(1, nThreads); i++) {
+    threads.emplace_back(&ThumbnailGenerator::run, this);
+  }
+}
+
+vivictpp::video::ThumbnailGenerator::~ThumbnailGenerator() { stop(); }
+
+int vivictpp::video::ThumbnailGenerator::defaultThreadCount() {
+  return std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+void vivictpp::video::ThumbnailGenerator::submit(vivictpp::time::Time pts,
+                                                 AVPacket *packet) {
+  std::unique_lock<std::mutex> lock(mutex);
+  queueChanged.wait(lock,
+                    [this] { return stopped || queue.size() < maxQueueSize; });
+  if (stopped) {
+    return;
+  }
+  queue.emplace(pts, vivictpp::libav::Packet(packet));
+  queueChanged.notify_all();
+}
+
+void vivictpp::video::ThumbnailGenerator::finish() {
+  std::unique_lock<std::mutex> lock(mutex);
+  queueChanged.wait(lock,
+                    [this] { return stopped || (queue.empty() && busy == 0); });
+}
+
+void vivictpp::video::ThumbnailGenerator::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+    queue = {};
+  }
+  queueChanged.notify_all();
+  for (auto &thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+void vivictpp::video::ThumbnailGenerator::run() {
+  vivictpp::tracing::setThreadName("vivictpp::video::ThumbnailGenerator");
+  std::unique_ptr<ThumbnailDecoder> decoder;
+  try {
+    decoder = std::make_unique<ThumbnailDecoder>(stream, maxThumbnailSize);
+  } catch (const std::exception &e) {
+    logger->warn("Failed to create thumbnail decoder: {}", e.what());
+  }
+  while (true) {
+    std::pair<vivictpp::time::Time, vivictpp::libav::Packet> item;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      queueChanged.wait(lock, [this] { return stopped || !queue.empty(); });
+      if (stopped) {
+        return;
+      }
+      item = queue.front();
+      queue.pop();
+      busy++;
+    }
+    queueChanged.notify_all();
+    if (decoder) {
+      VPP_TRACE_SPAN("thumbnail_decode");
+      try {
+        vivictpp::libav::Frame frame = decoder->decode(item.second);
+        if (!frame.empty()) {
+          onThumbnail(item.first, frame);
+        }
+      } catch (const std::exception &e) {
+        logger->warn("Failed to decode thumbnail: {}", e.what());
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busy--;
+    }
+    queueChanged.notify_all();
+  }
+}
@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "video/ThumbnailStore.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char MAGIC[8] = {'V', 'P', 'P', 'T', 'H', 'M', 'B', '1'};
+const int MAX_DIMENSION = 16384;
+
+bool ptsLess(vivictpp::time::Time pts,
+             const vivictpp::video::Thumbnail &thumbnail) {
+  return pts < thumbnail.pts;
+}
+
+template <typename T> void write(std::ostream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T read(std::istream &in) {
+  T value;
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::runtime_error("Truncated thumbnail data");
+  }
+  return value;
+}
+
+} // namespace
+
+uint8_t *
+vivictpp::video::ThumbnailStore::allocate(size_t size,
+                                          std::shared_ptr<uint8_t[]> &chunk) {
+  if (chunks.empty() || chunkUsed + size > chunkSizes.back()) {
+    size_t chunkSize = std::max(CHUNK_SIZE, size);
+    chunks.emplace_back(new uint8_t[chunkSize]);
+    chunkSizes.push_back(chunkSize);
+    chunkUsed = 0;
+  }
+  chunk = chunks.back();
+  uint8_t *p = chunk.get() + chunkUsed;
+  chunkUsed += size;
+  return p;
+}
+
+bool vivictpp::video::ThumbnailStore::add(vivictpp::time::Time pts, int width,
+                                          int height,
+                                          const uint8_t *const planes[3],
+                                          const int linesizes[3]) {
+  auto it =
+      std::upper_bound(thumbnails.begin(), thumbnails.end(), pts, ptsLess);
+  if (it != thumbnails.begin() && (it - 1)->pts == pts) {
+    return false;
+  }
+  std::shared_ptr<uint8_t[]> chunk;
+  uint8_t *data = allocate(Thumbnail::dataSize(width, height), chunk);
+  Thumbnail thumbnail(pts, width, height,
+                      std::shared_ptr<const uint8_t>(chunk, data));
+  uint8_t *dst = data;
+  for (int i = 0; i < 3; i++) {
+    int rowBytes = thumbnail.linesize(i);
+    int rows = i == 0 ? height : thumbnail.chromaHeight();
+    for (int y = 0; y < rows; y++) {
+      std::memcpy(dst, planes[i] + y * linesizes[i], rowBytes);
+      dst += rowBytes;
+    }
+  }
+  thumbnails.insert(it, thumbnail);
+  addOrder.push_back(pts);
+  return true;
+}
+
+vivictpp::video::Thumbnail
+vivictpp::video::ThumbnailStore::get(vivictpp::time::Time pts) const {
+  if (thumbnails.empty()) {
+    return Thumbnail();
+  }
+  auto it =
+      std::upper_bound(thumbnails.begin(), thumbnails.end(), pts, ptsLess);
+  return it == thumbnails.begin() ? *it : *(it - 1);
+}
+
+std::vector<vivictpp::video::Thumbnail>
+vivictpp::video::ThumbnailStore::addedSince(size_t from) const {
+  std::vector<Thumbnail> result;
+  for (size_t i = from; i < addOrder.size(); i++) {
+    auto it = std::upper_bound(thumbnails.begin(), thumbnails.end(),
+                               addOrder[i], ptsLess);
+    result.push_back(*(it - 1));
+  }
+  return result;
+}
+
+bool vivictpp::video::ThumbnailStore::contains(vivictpp::time::Time pts) const {
+  auto it =
+      std::upper_bound(thumbnails.begin(), thumbnails.end(), pts, ptsLess);
+  return it != thumbnails.begin() && (it - 1)->pts == pts;
+}
+
+size_t vivictpp::video::ThumbnailStore::bytesAllocated() const {
+  size_t total = 0;
+  for (size_t size : chunkSizes) {
+    total += size;
+  }
+  return total;
+}
+
+void vivictpp::video::ThumbnailStore::clear() {
+  thumbnails.clear();
+  addOrder.clear();
+  chunks.clear();
+  chunkSizes.clear();
+  chunkUsed = 0;
+}
+
+void vivictpp::video::ThumbnailStore::serialize(std::ostream &out) const {
+  out.write(MAGIC, sizeof(MAGIC));
+  write<uint32_t>(out, thumbnails.size());
+  for (const auto &thumbnail : thumbnails) {
+    write<int64_t>(out, thumbnail.pts);
+    write<int32_t>(out, thumbnail.width);
+    write<int32_t>(out, thumbnail.height);
+    out.write(reinterpret_cast<const char *>(thumbnail.data.get()),
+              Thumbnail::dataSize(thumbnail.width, thumbnail.height));
+  }
+}
+
+void vivictpp::video::ThumbnailStore::deserialize(std::istream &in) {
+  char magic[sizeof(MAGIC)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw std::runtime_error("Not a thumbnail store");
+  }
+  ThumbnailStore store;
+  uint32_t count = read<uint32_t>(in);
+  for (uint32_t i = 0; i < count; i++) {
+    int64_t pts = read<int64_t>(in);
+    int32_t width = read<int32_t>(in);
+    int32_t height = read<int32_t>(in);
+    if (width <= 0 || height <= 0 || width > MAX_DIMENSION ||
+        height > MAX_DIMENSION) {
+      throw std::runtime_error("Invalid thumbnail size");
+    }
+    size_t size = Thumbnail::dataSize(width, height);
+    std::shared_ptr<uint8_t[]> chunk;
+    uint8_t *data = store.allocate(size, chunk);
+    if (!in.read(reinterpret_cast<char *>(data), size)) {
+      throw std::runtime_error("Truncated thumbnail data");
+    }
+    Thumbnail thumbnail(pts, width, height,
+                        std::shared_ptr<const uint8_t>(chunk, data));
+    auto it = std::upper_bound(store.thumbnails.begin(),
+                               store.thumbnails.end(), pts, ptsLess);
+    store.thumbnails.insert(it, thumbnail);
+    store.addOrder.push_back(pts);
+  }
+  *this = std::move(store);
+}
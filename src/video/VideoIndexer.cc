@@ -3,43 +3,13 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "video/VideoIndexer.hh"
-#include "libav/Decoder.hh"
-#include "libav/Filter.hh"
 #include "libav/FormatHandler.hh"
 #include "time/Time.hh"
 #include "time/TimeUtils.hh"
+#include "tracing/Tracing.hh"
+#include "video/ThumbnailGenerator.hh"
 
-std::string thumbnailFilterStr(int maxThumbnailSize) {
-  std::string filterStr = fmt::format(
-      "scale=w={}:h={}:force_original_aspect_ratio=decrease:flags=neighbor,"
-      "format=yuv420p",
-      maxThumbnailSize, maxThumbnailSize);
-  return filterStr;
-}
-
-class ThumbnailDecoder {
-private:
-  vivictpp::libav::Decoder decoder;
-  vivictpp::libav::VideoFilter filter;
-
-public:
-  ThumbnailDecoder(AVStream *stream, int maxThumbnailSize)
-      : decoder(stream->codecpar, vivictpp::libav::DecoderOptions()),
-        filter(stream, decoder.getCodecContext(),
-               thumbnailFilterStr(maxThumbnailSize)) {}
-
-  std::vector<vivictpp::libav::Frame> decode(AVPacket *packet) {
-    std::vector<vivictpp::libav::Frame> frames;
-    for (auto frame : decoder.handlePacket(packet)) {
-      frames.push_back(filter.filterFrame(frame));
-    }
-    for (auto frame : decoder.handlePacket(nullptr)) {
-      frames.push_back(filter.filterFrame(frame));
-    }
-    decoder.flush();
-    return frames;
-  }
-};
+#include <algorithm>
 
 void pairsort(std::vector<float> &a, std::vector<float> &b, int n) {
   std::vector<std::pair<float, float>> pairt(n);
@@ -88,9 +58,25 @@ void vivictpp::video::VideoIndex::addGop(const vivictpp::time::Time gopEndPts) {
 }
 
 void vivictpp::video::VideoIndex::addThumbnail(
-    const vivictpp::video::Thumbnail &thumbnail) {
+    vivictpp::time::Time pts, const vivictpp::libav::Frame &frame) {
+  const uint8_t *const planes[3] = {frame->data[0], frame->data[1],
+                                    frame->data[2]};
+  std::lock_guard<std::mutex> lg(m);
+  if (thumbnails.add(pts, frame->width, frame->height, planes,
+                     frame->linesize)) {
+    thumbnailsVersion++;
+  }
+}
+
+vivictpp::video::Thumbnail
+vivictpp::video::VideoIndex::getThumbnail(vivictpp::time::Time pts) const {
+  std::lock_guard<std::mutex> lg(m);
+  return thumbnails.get(pts);
+}
+
+bool vivictpp::video::VideoIndex::hasThumbnail(vivictpp::time::Time pts) const {
   std::lock_guard<std::mutex> lg(m);
-  thumbnails.push_back(thumbnail);
+  return thumbnails.contains(pts);
 }
 
 void vivictpp::video::VideoIndex::finalizeIndex() {
@@ -114,6 +100,8 @@ void vivictpp::video::VideoIndex::clear() {
   plotDatas.clear();
   frameSizes.clear();
   keyFrameFlag.clear();
+  thumbnailsVersion++;
+  generation++;
   indexingDone = false;
 }
 
@@ -127,9 +115,29 @@ void vivictpp::video::VideoIndexer::prepareIndex(
       generatThumbnails);
 }
 
+void vivictpp::video::VideoIndexer::setSeekBarWidth(int width) {
+  int count =
+      std::clamp(width / pixelsPerThumbnail, minThumbnails, maxThumbnails);
+  {
+    std::lock_guard<std::mutex> lg(thumbnailCountMutex);
+    if (thumbnailCount.exchange(count) == count) {
+      return;
+    }
+  }
+  thumbnailCountChanged.notify_all();
+}
+
+vivictpp::time::Time
+vivictpp::video::VideoIndexer::thumbnailInterval(vivictpp::time::Time duration,
+                                                 int count) const {
+  return std::max(duration / count,
+                  vivictpp::time::seconds(minThumbnailInterval));
+}
+
 void vivictpp::video::VideoIndexer::prepareIndexInternal(
     const std::string &inputFile, const std::string &formatOptions,
     const bool generateThumbnails) {
+  vivictpp::tracing::setThreadName("vivictpp::video::VideoIndexer");
   int64_t t0 = vivictpp::time::relativeTimeMicros();
   vivictpp::libav::FormatHandler formatHandler(inputFile, formatOptions);
   if (formatHandler.getVideoStreams().empty()) {
@@ -137,22 +145,26 @@ void vivictpp::video::VideoIndexer::prepareIndexInternal(
     logger->warn("Indexing failed, No video streams found in input file");
   }
   index->clear();
-  std::set<int> activeStreams({formatHandler.getVideoStreams()[0]->index});
+  AVStream *stream = formatHandler.getVideoStreams()[0];
+  std::set<int> activeStreams({stream->index});
   formatHandler.setActiveStreams(activeStreams);
 
-  std::unique_ptr<ThumbnailDecoder> thumbnailDecoder;
+  std::unique_ptr<ThumbnailGenerator> thumbnailGenerator;
   if (generateThumbnails) {
-    thumbnailDecoder = std::make_unique<ThumbnailDecoder>(
-        formatHandler.getVideoStreams()[0], maxThumbnailSize);
+    thumbnailGenerator = std::make_unique<ThumbnailGenerator>(
+        stream, maxThumbnailSize, ThumbnailGenerator::defaultThreadCount(),
+        [this](vivictpp::time::Time pts, const vivictpp::libav::Frame &frame) {
+          index->addThumbnail(pts, frame);
+        });
   }
 
   vivictpp::time::Time lastPts = vivictpp::time::NO_TIME;
   vivictpp::time::Time duration = formatHandler.formatContext->duration;
-  AVRational streamTimeBase = formatHandler.getVideoStreams()[0]->time_base;
-  // Try to get around 100 thumbnails, with at least 5s interval
-  vivictpp::time::Time thumbnailInterval = std::max(
-      duration / maxThumbnails, vivictpp::time::seconds(minThumbnailInterval));
+  AVRational streamTimeBase = stream->time_base;
 
+  // Key frame packets are only copied and handed over to the thumbnail
+  // generator, so reading the index is not slowed down by decoding
+  int usedThumbnailCount = thumbnailCount;
   while (!formatHandler.eof() && !stopIndexing) {
     AVPacket *packet = formatHandler.nextPacket();
     if (packet != nullptr) {
@@ -160,15 +172,12 @@ void vivictpp::video::VideoIndexer::prepareIndexInternal(
                                               vivictpp::time::TIME_BASE_Q);
       bool keyFrame = packet->flags & AV_PKT_FLAG_KEY;
       index->addFrameData({pts, packet->size, keyFrame});
-      if (keyFrame && generateThumbnails &&
-          (lastPts == vivictpp::time::NO_TIME ||
-           pts - lastPts >= thumbnailInterval)) {
-        lastPts = pts;
-        for (auto frame : thumbnailDecoder->decode(packet)) {
-          if (!frame.empty()) {
-            index->addThumbnail(Thumbnail(pts, frame));
-            break;
-          }
+      if (keyFrame && generateThumbnails) {
+        usedThumbnailCount = thumbnailCount;
+        if (lastPts == vivictpp::time::NO_TIME ||
+            pts - lastPts >= thumbnailInterval(duration, usedThumbnailCount)) {
+          lastPts = pts;
+          thumbnailGenerator->submit(pts, packet);
         }
       }
       av_packet_unref(packet);
@@ -176,7 +185,62 @@ void vivictpp::video::VideoIndexer::prepareIndexInternal(
   }
   index->finalizeIndex();
   int64_t t1 = vivictpp::time::relativeTimeMicros();
-  logger->debug("Found {} keyframes, generated {} thumbnails",
-                index->getKeyFrames().size(), index->getThumbnails().size());
-  logger->debug("Indexing took {} ms", (t1 - t0) / 1000);
+  VPP_LOG_DEBUG(logger, "Found {} keyframes", index->getKeyFrames().size());
+  VPP_LOG_DEBUG(logger, "Indexing took {} ms", (t1 - t0) / 1000);
+  if (!generateThumbnails) {
+    return;
+  }
+  thumbnailGenerator->finish();
+  int64_t t2 = vivictpp::time::relativeTimeMicros();
+  VPP_LOG_DEBUG(logger, "Generated {} thumbnails ({} kB) in {} ms",
+                index->thumbnailCount(), index->thumbnailBytes() / 1024,
+                (t2 - t0) / 1000);
+
+  // Generate more thumbnails if the seek bar grows, seeking to each missing
+  // key frame
+  while (!stopIndexing) {
+    {
+      std::unique_lock<std::mutex> lock(thumbnailCountMutex);
+      thumbnailCountChanged.wait(lock, [&] {
+        return stopIndexing || thumbnailCount > usedThumbnailCount;
+      });
+    }
+    if (stopIndexing) {
+      break;
+    }
+    usedThumbnailCount = thumbnailCount;
+    vivictpp::time::Time interval =
+        thumbnailInterval(duration, usedThumbnailCount);
+    lastPts = vivictpp::time::NO_TIME;
+    for (vivictpp::time::Time keyFrame : index->copyKeyFrames()) {
+      if (stopIndexing) {
+        break;
+      }
+      if (lastPts != vivictpp::time::NO_TIME && keyFrame - lastPts < interval) {
+        continue;
+      }
+      lastPts = keyFrame;
+      if (index->hasThumbnail(keyFrame)) {
+        continue;
+      }
+      formatHandler.seek(keyFrame);
+      while (!formatHandler.eof() && !stopIndexing) {
+        AVPacket *packet = formatHandler.nextPacket();
+        if (packet == nullptr) {
+          continue;
+        }
+        vivictpp::time::Time pts = av_rescale_q(packet->pts, streamTimeBase,
+                                                vivictpp::time::TIME_BASE_Q);
+        bool found = (packet->flags & AV_PKT_FLAG_KEY) && pts >= keyFrame;
+        if (found) {
+          thumbnailGenerator->submit(pts, packet);
+        }
+        av_packet_unref(packet);
+        if (found) {
+          break;
+        }
+      }
+    }
+    thumbnailGenerator->finish();
+  }
 }
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "workers/DecodeScheduler.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+vivictpp::workers::DecodeScheduler::DecodeScheduler(int totalThreads)
+    : totalThreads(std::max(1, totalThreads)) {}
+
+void vivictpp::workers::DecodeScheduler::reset() {
+  lastLoads.clear();
+  starvedSamples = 0;
+}
+
+std::vector<int> vivictpp::workers::DecodeScheduler::update(
+    int64_t now, const std::vector<DecoderLoad> &loads) {
+  if (loads.size() < 2 || (int)loads.size() > totalThreads) {
+    return {};
+  }
+  if (lastLoads.size() != loads.size()) {
+    lastLoads = loads;
+    lastSampleTime = now;
+    starvedSamples = 0;
+    return {};
+  }
+  if (now - lastSampleTime < SAMPLE_INTERVAL) {
+    return {};
+  }
+
+  bool starved = false;
+  bool full = false;
+  std::vector<double> needs;
+  for (size_t i = 0; i < loads.size(); i++) {
+    uint64_t frames = loads[i].framesDecoded - lastLoads[i].framesDecoded;
+    uint64_t micros = loads[i].decodeMicros - lastLoads[i].decodeMicros;
+    if (frames > 0 && micros > 0 && loads[i].frameDuration > 0) {
+      // Thread time per decoded frame, times frames per second of playback
+      double cost = (double)micros * loads[i].threads / frames;
+      needs.push_back(cost / loads[i].frameDuration);
+    }
+    starved = starved || loads[i].bufferedFrames <= LOW_WATERMARK;
+    full = full || loads[i].bufferedFrames >= HIGH_WATERMARK;
+  }
+  lastLoads = loads;
+  lastSampleTime = now;
+  if (needs.size() != loads.size()) {
+    starvedSamples = 0;
+    return {};
+  }
+
+  starvedSamples = starved && full ? starvedSamples + 1 : 0;
+  if (starvedSamples < STARVED_SAMPLES ||
+      (rebalanced && now - lastRebalanceTime < REBALANCE_COOLDOWN)) {
+    return {};
+  }
+
+  std::vector<int> threads = allocate(needs);
+  bool changed = false;
+  for (size_t i = 0; i < loads.size(); i++) {
+    // Ignore small changes, reopening a decoder is not free
+    changed = changed || std::abs(threads[i] - loads[i].threads) >= 2;
+  }
+  if (!changed) {
+    return {};
+  }
+  starvedSamples = 0;
+  rebalanced = true;
+  lastRebalanceTime = now;
+  return threads;
+}
+
+std::vector<int> vivictpp::workers::DecodeScheduler::allocate(
+    const std::vector<double> &needs) const {
+  double totalNeed = 0;
+  for (double need : needs) {
+    totalNeed += need;
+  }
+  std::vector<int> threads;
+  int assigned = 0;
+  for (double need : needs) {
+    int n = std::max(1, (int)std::lround(totalThreads * need / totalNeed));
+    threads.push_back(n);
+    assigned += n;
+  }
+  // Rounding may assign one thread too many or too few per input, take it
+  // from or give it to the inputs needing the most
+  while (assigned != totalThreads) {
+    size_t i = std::max_element(threads.begin(), threads.end()) -
+               threads.begin();
+    if (assigned > totalThreads) {
+      if (threads[i] == 1) {
+        break;
+      }
+      threads[i]--;
+      assigned--;
+    } else {
+      threads[i]++;
+      assigned++;
+    }
+  }
+  return threads;
+}
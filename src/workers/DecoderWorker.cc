@@ -4,6 +4,8 @@
 
 #include "workers/DecoderWorker.hh"
 
+#include "time/TimeUtils.hh"
+
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
@@ -36,9 +38,13 @@ vivictpp::workers::DecoderWorker::DecoderWorker(
     int packetQueueSize)
     : InputWorker(packetQueueSize, "vivictpp::workers::DecoderWorker"),
       streamIndex(stream->index), stream(stream), frameBuffer(frameBufferSize),
+      decoderOptions(decoderOptions),
       decoder(new vivictpp::libav::Decoder(stream->codecpar, decoderOptions)),
       filter(createFilter(stream, decoder->getCodecContext(), customFilter)),
-      lastSeenPts(AV_NOPTS_VALUE) {}
+      lastSeenPts(AV_NOPTS_VALUE) {
+  pipelineStats.decoderThreads.store(decoder->getCodecContext()->thread_count,
+                                     std::memory_order_relaxed);
+}
 
 vivictpp::workers::DecoderWorker::~DecoderWorker() { quit(); }
 
@@ -51,6 +57,7 @@ void vivictpp::workers::DecoderWorker::seek(vivictpp::time::Time pos,
         dw->messageQueue.clearDataOlderThan(serialNo);
         dw->state = InputWorkerState::SEEKING;
         dw->decoder->flush();
+        dw->applyPendingThreads();
         // For some reason it seems necessary to reconfigure filter on seek when
         // using videotoolbox Haven't investigated it much but this seems to
         // work.
@@ -69,32 +76,74 @@ void vivictpp::workers::DecoderWorker::seek(vivictpp::time::Time pos,
       "seek"));
 }
 
+void vivictpp::workers::DecoderWorker::standBy() {
+  DecoderWorker *dw(this);
+  sendCommand(new vivictpp::workers::Command(
+      [=](uint64_t serialNo) {
+        dw->messageQueue.clearDataOlderThan(serialNo);
+        dw->state = InputWorkerState::INACTIVE;
+        dw->decoder->flush();
+        dw->frameBuffer.clear();
+        while (!dw->frameQueue.empty()) {
+          dw->frameQueue.pop();
+        }
+        dw->skipNonRef.store(false);
+        return true;
+      },
+      "standBy"));
+}
+
+void vivictpp::workers::DecoderWorker::setThreads(int threads) {
+  pendingThreads.store(threads);
+}
+
+// Replaces the decoder with one using the pending thread count. Only called
+// right after a flush, so no decoder state is lost.
+void vivictpp::workers::DecoderWorker::applyPendingThreads() {
+  int threads = pendingThreads.exchange(0);
+  if (threads <= 0 || threads == decoder->getCodecContext()->thread_count ||
+      decoder->getHwDeviceType() != AV_HWDEVICE_TYPE_NONE) {
+    return;
+  }
+  logger->info("Changing number of decoding threads from {} to {}",
+               decoder->getCodecContext()->thread_count, threads);
+  decoderOptions.threads = threads;
+  decoder.reset(new vivictpp::libav::Decoder(stream->codecpar, decoderOptions));
+  pipelineStats.decoderThreads.store(decoder->getCodecContext()->thread_count,
+                                     std::memory_order_relaxed);
+}
+
 void logPacket(vivictpp::libav::Packet pkt,
                const std::shared_ptr<spdlog::logger> &logger) {
   AVPacket *packet = pkt.avPacket();
   if (packet) {
-    logger->debug("Packet: size={} pts={} dts={}", packet->size, packet->pts,
-                  packet->dts);
+    VPP_LOG_DEBUG(logger, "Packet: size={} pts={} dts={}", packet->size,
+                  packet->pts, packet->dts);
   } else if (pkt.eof()) {
-    logger->debug("Packet: eof");
+    VPP_LOG_DEBUG(logger, "Packet: eof");
   } else {
-    logger->debug("Packet: nullptr");
+    VPP_LOG_DEBUG(logger, "Packet: nullptr");
   }
 }
 
 void vivictpp::workers::DecoderWorker::doWork() {
-  logger->trace("vivictpp::workers::DecoderWorker::doWork frameQueue.size={}, "
+  VPP_LOG_TRACE(logger,
+                "vivictpp::workers::DecoderWorker::doWork frameQueue.size={}, "
                 "frameBuffer.size={},"
                 " frameBuffer.minPts={}, frameBuffer.maxPts={}",
                 frameQueue.size(), frameBuffer.size(), frameBuffer.minPts(),
                 frameBuffer.maxPts());
+  pipelineStats.packetQueueDepth.store(messageQueue.dataSize(),
+                                       std::memory_order_relaxed);
+  pipelineStats.frameBufferFill.store(frameBuffer.size(),
+                                      std::memory_order_relaxed);
   while (!frameQueue.empty()) {
     dropFrameIfSeekingAndBufferFull();
     if (!frameBuffer.waitForNotFull(std::chrono::milliseconds(2))) {
       break;
     }
 
-    addFrameToBuffer(frameQueue.front());
+    addFrameToBuffer(std::move(frameQueue.front()));
     frameQueue.pop();
   }
 }
@@ -105,7 +154,8 @@ bool vivictpp::workers::DecoderWorker::onData(
     return false;
   }
   if (!seeking() && !frameBuffer.waitForNotFull(std::chrono::milliseconds(2))) {
-    logger->trace("vivictpp::workers::DecoderWorker::onData frameBuffer full");
+    VPP_LOG_TRACE(logger,
+                  "vivictpp::workers::DecoderWorker::onData frameBuffer full");
     return false;
   }
   // TODO: check filter.eof
@@ -117,22 +167,35 @@ bool vivictpp::workers::DecoderWorker::onData(
 }
 
 void vivictpp::workers::DecoderWorker::readFrames(AVPacket *avPacket) {
+  decoder->getCodecContext()->skip_frame =
+      skipNonRef.load() ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+  int64_t tDecode = vivictpp::time::relativeTimeMicros();
   std::vector<vivictpp::libav::Frame> frames = decoder->handlePacket(avPacket);
+  pipelineStats.decodeMicros.fetch_add(
+      vivictpp::time::relativeTimeMicros() - tDecode,
+      std::memory_order_relaxed);
+  pipelineStats.framesDecoded.fetch_add(frames.size(),
+                                        std::memory_order_relaxed);
   bool addFramesToQueue = false;
-  for (auto frame : frames) {
-    logger->debug("Got frame with pts={}, pkt_dts={}, keyframe={}", frame->pts,
-                  frame->pkt_dts, vivictpp::libav::isKeyFrame(frame.avFrame()));
+  for (auto &frame : frames) {
+    VPP_LOG_DEBUG(logger, "Got frame with pts={}, pkt_dts={}, keyframe={}",
+                  frame->pts, frame->pkt_dts,
+                  vivictpp::libav::isKeyFrame(frame.avFrame()));
     dropFrameIfSeekingAndBufferFull();
+    int64_t t0 = vivictpp::time::relativeTimeMicros();
     vivictpp::libav::Frame filtered =
-        filter ? filter->filterFrame(frame) : frame;
+        filter ? filter->filterFrame(frame) : std::move(frame);
+    pipelineStats.filterMicros.fetch_add(
+        vivictpp::time::relativeTimeMicros() - t0, std::memory_order_relaxed);
+    pipelineStats.framesFiltered.fetch_add(1, std::memory_order_relaxed);
     if (!filtered.empty()) {
       // If we start adding frames to queue, we ensure that all following frames
       // are also put in queue so they are not added to buffer out of order
       addFramesToQueue = addFramesToQueue || frameBuffer.isFull();
       if (addFramesToQueue) {
-        frameQueue.push(filtered);
+        frameQueue.push(std::move(filtered));
       } else {
-        addFrameToBuffer(filtered);
+        addFrameToBuffer(std::move(filtered));
       }
     }
   }
@@ -154,8 +217,9 @@ void inline vivictpp::workers::DecoderWorker::
 }
 
 void vivictpp::workers::DecoderWorker::addFrameToBuffer(
-    const vivictpp::libav::Frame &frame) {
-  logger->trace("pts={} AV_NOPTS_VALUE={}", frame.pts(), AV_NOPTS_VALUE);
+    vivictpp::libav::Frame frame) {
+  VPP_LOG_TRACE(logger, "pts={} AV_NOPTS_VALUE={}", frame.pts(),
+                AV_NOPTS_VALUE);
   vivictpp::time::Time pts = frame.pts();
   if (pts == AV_NOPTS_VALUE) {
     if (lastSeenPts == AV_NOPTS_VALUE) {
@@ -172,10 +236,11 @@ void vivictpp::workers::DecoderWorker::addFrameToBuffer(
     pts = av_rescale_q(pts, stream->time_base, vivictpp::time::TIME_BASE_Q);
   }
   lastSeenPts = pts;
-  logger->debug(
+  VPP_LOG_DEBUG(
+      logger,
       "DecoderWorker::addFrameToBuffer Buffering frame with pts={}s ({})", pts,
       frame.pts());
-  frameBuffer.write(frame, pts);
+  frameBuffer.write(std::move(frame), pts);
   if (seeking()) {
     seeklog->debug("vivictpp::workers::DecoderWorker::addFrameToBuffer written "
                    "pts={} seekPos={}",
@@ -9,6 +9,7 @@
 #include <sstream>
 
 #include "logging/Logging.hh"
+#include "tracing/Tracing.hh"
 
 std::string
 ptsBufferToString(const std::vector<vivictpp::time::Time> &ptsBuffer) {
@@ -51,8 +52,8 @@ bool vivictpp::workers::FrameBuffer::waitForNotFull(
     result = conditionVariable.wait_for(lock, relTime,
                                         [&] { return _size < _maxSize; });
   }
-  logger->trace("waitForNotNull _size={} _maxSize={} returning {}", _size,
-                _maxSize, result);
+  VPP_LOG_TRACE(logger, "waitForNotNull _size={} _maxSize={} returning {}",
+                _size, _maxSize, result);
   return result;
 }
 
@@ -63,6 +64,7 @@ int vivictpp::workers::FrameBuffer::size() {
 
 void vivictpp::workers::FrameBuffer::write(vivictpp::libav::Frame frame,
                                            vivictpp::time::Time pts) {
+  VPP_TRACE_SPAN("buffer_write");
   bool wasEmpty = false;
   {
     const std::lock_guard<std::mutex> lock(mutex);
@@ -70,7 +72,7 @@ void vivictpp::workers::FrameBuffer::write(vivictpp::libav::Frame frame,
       throw std::runtime_error("Buffer is full");
     }
     wasEmpty = _size == 0;
-    queue[_writePos] = frame;
+    queue[_writePos] = std::move(frame);
     ptsBuffer[_writePos.getValue()] = pts;
     _writePos = _writePos + 1;
     _size++;
@@ -78,8 +80,9 @@ void vivictpp::workers::FrameBuffer::write(vivictpp::libav::Frame frame,
   if (wasEmpty) {
     conditionVariable.notify_all();
   }
-  logger->debug("Wrote frame with pts {}, size is now {}", pts, _size);
-  logger->trace("_size={}, ptsBuffer: {}", _size, ptsBufferToString(ptsBuffer));
+  VPP_LOG_DEBUG(logger, "Wrote frame with pts {}, size is now {}", pts, _size);
+  VPP_LOG_TRACE(logger, "_size={}, ptsBuffer: {}", _size,
+                ptsBufferToString(ptsBuffer));
 }
 
 bool vivictpp::workers::FrameBuffer::isEmpty() {
@@ -88,11 +91,11 @@ bool vivictpp::workers::FrameBuffer::isEmpty() {
 }
 
 vivictpp::libav::Frame vivictpp::workers::FrameBuffer::first() {
-  logger->trace("vivictpp::workers::FrameBuffer::first enter");
+  VPP_LOG_TRACE(logger, "vivictpp::workers::FrameBuffer::first enter");
   std::unique_lock<std::mutex> lock(mutex);
   conditionVariable.wait(lock, [&] { return _size > 0; });
-  logger->trace("vivictpp::workers::FrameBuffer::first exit");
-  return queue[_cursor.getValue()];
+  VPP_LOG_TRACE(logger, "vivictpp::workers::FrameBuffer::first exit");
+  return queue[_cursor.getValue()].share();
 }
 
 vivictpp::time::Time vivictpp::workers::FrameBuffer::currentPts() {
@@ -104,7 +107,8 @@ vivictpp::time::Time vivictpp::workers::FrameBuffer::currentPts() {
 }
 
 bool vivictpp::workers::FrameBuffer::ptsInRange(vivictpp::time::Time pts) {
-  logger->trace(
+  VPP_LOG_TRACE(
+      logger,
       "vivictpp::workers::FrameBuffer::ptsInRange pts={} minPts={} maxPts={}",
       pts, minPts(), maxPts());
   bool result;
@@ -117,7 +121,8 @@ bool vivictpp::workers::FrameBuffer::ptsInRange(vivictpp::time::Time pts) {
     result = this->minPts() <= pts && pts <= this->maxPts();
   }
   //  if (!result) {
-  logger->trace("_size={}, ptsBuffer: {}", _size, ptsBufferToString(ptsBuffer));
+  VPP_LOG_TRACE(logger, "_size={}, ptsBuffer: {}", _size,
+                ptsBufferToString(ptsBuffer));
   //  }
   return result;
 }
@@ -128,7 +133,7 @@ vivictpp::time::Time vivictpp::workers::FrameBuffer::minPts() {
 
 vivictpp::time::Time vivictpp::workers::FrameBuffer::maxPts() {
   QueuePointer index = _writePos - 1;
-  logger->debug("maxPts() maxPts={}", ptsBuffer[index.getValue()]);
+  VPP_LOG_DEBUG(logger, "maxPts() maxPts={}", ptsBuffer[index.getValue()]);
   return ptsBuffer[index.getValue()];
 }
 
@@ -181,11 +186,13 @@ int vivictpp::workers::FrameBuffer::stepForward(vivictpp::time::Time pts) {
 }
 
 void vivictpp::workers::FrameBuffer::stepBackward(vivictpp::time::Time pts) {
-  logger->debug(
+  VPP_LOG_DEBUG(
+      logger,
       "vivictpp::workers::Framebuffer::stepBackward entry _cursor={}, pts={}",
       _cursor.getValue(), pts);
   while (ptsBuffer[(_cursor - 1).getValue()] >= pts && previous()) {
-    logger->trace(
+    VPP_LOG_TRACE(
+        logger,
         "vivictpp::workers::Framebuffer::stepBackward _cursor={}, pts={}",
         _cursor.getValue(), pts);
   }
@@ -199,11 +206,13 @@ vivictpp::time::Time vivictpp::workers::FrameBuffer::nextPts() {
   } else {
     nextPts = ptsBuffer[(_cursor + 1).getValue()];
   }
-  logger->debug(
+  VPP_LOG_DEBUG(
+      logger,
       "vivictpp::workers::FrameBuffer::nextPts _size={} _cursor={} nextPts={}",
       _size, _cursor.getValue(), nextPts);
   if (nextPts < 0.01) {
-    logger->debug("vivictpp::workers::FrameBuffer::nextPts ptsBuffer={}",
+    VPP_LOG_DEBUG(logger,
+                  "vivictpp::workers::FrameBuffer::nextPts ptsBuffer={}",
                   ptsBufferToString(ptsBuffer));
   }
   return nextPts;
@@ -217,11 +226,13 @@ vivictpp::time::Time vivictpp::workers::FrameBuffer::previousPts() {
   } else {
     previousPts = ptsBuffer[(_cursor - 1).getValue()];
   }
-  logger->debug("vivictpp::workers::FrameBuffer::previousPts _size={} "
+  VPP_LOG_DEBUG(logger,
+                "vivictpp::workers::FrameBuffer::previousPts _size={} "
                 "_cursor={} previousPts={}",
                 _size, _cursor.getValue(), previousPts);
   if (previousPts < 0.01) {
-    logger->debug("vivictpp::workers::FrameBuffer::previousPts ptsBuffer={}",
+    VPP_LOG_DEBUG(logger,
+                  "vivictpp::workers::FrameBuffer::previousPts ptsBuffer={}",
                   ptsBufferToString(ptsBuffer));
   }
   return previousPts;
@@ -236,7 +247,7 @@ void vivictpp::workers::FrameBuffer::drop(int n) {
 }
 
 void vivictpp::workers::FrameBuffer::_drop(int n) {
-  logger->trace("vivictpp::workers::FrameBuffer::_drop n={}", n);
+  VPP_LOG_TRACE(logger, "vivictpp::workers::FrameBuffer::_drop n={}", n);
   for (int i = 0; i < n && _size > 0; i++) {
     if (_cursor == this->tail()) {
       _cursor = _cursor + 1;
@@ -267,3 +278,18 @@ void vivictpp::workers::FrameBuffer::clear() {
   }
   conditionVariable.notify_all();
 }
+
+std::vector<std::pair<vivictpp::time::Time, vivictpp::libav::Frame>>
+vivictpp::workers::FrameBuffer::framesInRange(vivictpp::time::Time from,
+                                              vivictpp::time::Time to) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  std::vector<std::pair<vivictpp::time::Time, vivictpp::libav::Frame>> result;
+  QueuePointer pos = tail();
+  for (int i = 0; i < _size; i++, pos = pos + 1) {
+    vivictpp::time::Time pts = ptsBuffer[pos.getValue()];
+    if (pts >= from && pts <= to) {
+      result.emplace_back(pts, queue[pos.getValue()].share());
+    }
+  }
+  return result;
+}
@@ -60,7 +60,7 @@ void vivictpp::workers::PacketWorker::doWork() {
     std::this_thread::sleep_for(std::chrono::milliseconds(5));
     return;
   }
-  logger->trace("vivictpp::workers::PacketWorker::doWork  enter");
+  VPP_LOG_TRACE(logger, "vivictpp::workers::PacketWorker::doWork  enter");
   if (currentPacket == nullptr && formatHandler.eof()) {
     std::this_thread::sleep_for(std::chrono::milliseconds(5));
     return;
@@ -68,10 +68,10 @@ void vivictpp::workers::PacketWorker::doWork() {
   if (currentPacket == nullptr) {
     currentPacket = formatHandler.nextPacket();
     if (currentPacket != nullptr) {
-      logger->debug("Read packet with pts={}", currentPacket->pts);
+      VPP_LOG_DEBUG(logger, "Read packet with pts={}", currentPacket->pts);
     }
     if (formatHandler.eof()) {
-      logger->debug("End of file reached");
+      VPP_LOG_DEBUG(logger, "End of file reached");
       for (auto dw : decoderWorkers) {
         dw->onEndOfFile();
       }
@@ -87,10 +87,16 @@ void vivictpp::workers::PacketWorker::doWork() {
       if (!dw->offerData(data, std::chrono::milliseconds(2))) {
         return;
       }
+      if (dw->streamIndex == currentPacket->stream_index) {
+        PipelineStats &stats = dw->stats();
+        stats.packetsDemuxed.fetch_add(1, std::memory_order_relaxed);
+        stats.packetQueueDepth.store(dw->packetQueueSize(),
+                                     std::memory_order_relaxed);
+      }
     }
     unrefCurrentPacket();
   }
-  logger->trace("vivictpp::workers::PacketWorker::doWork  exit");
+  VPP_LOG_TRACE(logger, "vivictpp::workers::PacketWorker::doWork  exit");
 }
 
 void vivictpp::workers::PacketWorker::setActiveStreams() {
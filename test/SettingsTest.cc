@@ -42,10 +42,17 @@ TEST_CASE("Complete settings file"
   expectedSettings.baseFontSize = 18;
   expectedSettings.hwAccels = {"vaapi"};
   expectedSettings.preferredDecoders = {"libopenjpeg"};
+  expectedSettings.fastProbe = true;
+  expectedSettings.probeSizeKb = 256;
+  expectedSettings.analyzeDurationMs = 200;
+  expectedSettings.standbyDecoders = 2;
   expectedSettings.logBufferSize = 256;
   expectedSettings.logToFile = true;
   expectedSettings.logFile = "/tmp/vivictpp.log";
   expectedSettings.logLevels = {{"SeekState", "warn"}, {"RandomLog", "error"}};
+  expectedSettings.overloadPolicy = "drop";
+  expectedSettings.exportFormat = "tiff";
+  expectedSettings.exportDirectory = "/tmp/vivictpp-frames";
   vivictpp::Settings settings =
       vivictpp::loadSettings("../testdata/settings/complete_settings.toml");
   requireSettingsEquals(settings, expectedSettings);
@@ -57,8 +64,15 @@ void requireSettingsEquals(const vivictpp::Settings &lhs,
   REQUIRE(lhs.disableFontAutoScaling == rhs.disableFontAutoScaling);
   REQUIRE(lhs.hwAccels == rhs.hwAccels);
   REQUIRE(lhs.preferredDecoders == rhs.preferredDecoders);
+  REQUIRE(lhs.fastProbe == rhs.fastProbe);
+  REQUIRE(lhs.probeSizeKb == rhs.probeSizeKb);
+  REQUIRE(lhs.analyzeDurationMs == rhs.analyzeDurationMs);
+  REQUIRE(lhs.standbyDecoders == rhs.standbyDecoders);
   REQUIRE(lhs.logBufferSize == rhs.logBufferSize);
   REQUIRE(lhs.logToFile == rhs.logToFile);
   REQUIRE(lhs.logFile == rhs.logFile);
   REQUIRE(lhs.logLevels == rhs.logLevels);
+  REQUIRE(lhs.overloadPolicy == rhs.overloadPolicy);
+  REQUIRE(lhs.exportFormat == rhs.exportFormat);
+  REQUIRE(lhs.exportDirectory == rhs.exportDirectory);
 }
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "audio/AudioRingBuffer.hh"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using vivictpp::audio::AudioRingBuffer;
+
+TEST_CASE("Capacity is rounded up to a power of two") {
+  AudioRingBuffer ring(1000);
+  REQUIRE(ring.capacity() == 1024);
+}
+
+TEST_CASE("Writes are limited to free space and wrap around") {
+  AudioRingBuffer ring(16);
+  std::vector<uint8_t> data(12);
+  std::iota(data.begin(), data.end(), 0);
+  std::vector<uint8_t> out(16);
+
+  REQUIRE(ring.write(data.data(), 12) == 12);
+  REQUIRE(ring.read(out.data(), 8) == 8);
+  REQUIRE(out[7] == 7);
+  // 4 bytes left, 12 free
+  REQUIRE(ring.write(data.data(), 12) == 12);
+  REQUIRE(ring.write(data.data(), 12) == 0);
+  REQUIRE(ring.readableBytes() == 16);
+
+  REQUIRE(ring.read(out.data(), 16) == 16);
+  REQUIRE(out[0] == 8);
+  REQUIRE(out[3] == 11);
+  REQUIRE(out[4] == 0);
+  REQUIRE(out[15] == 11);
+  REQUIRE(ring.readPosition() == 24);
+  REQUIRE(ring.read(out.data(), 16) == 0);
+}
+
+TEST_CASE("Flush discards written data but keeps later writes") {
+  AudioRingBuffer ring(16);
+  std::vector<uint8_t> a(10, 1);
+  std::vector<uint8_t> b(4, 2);
+  std::vector<uint8_t> out(16);
+
+  ring.write(a.data(), a.size());
+  ring.flush();
+  REQUIRE(ring.readableBytes() == 0);
+  REQUIRE(ring.write(b.data(), b.size()) == 4);
+  REQUIRE(ring.read(out.data(), 16) == 4);
+  REQUIRE(out[0] == 2);
+  REQUIRE(out[3] == 2);
+  REQUIRE(ring.readPosition() == 14);
+}
+
+TEST_CASE("Bytes arrive in order across threads") {
+  AudioRingBuffer ring(64);
+  const size_t total = 1 << 16;
+  std::thread producer([&ring] {
+    size_t written = 0;
+    while (written < total) {
+      uint8_t chunk[7];
+      size_t n = std::min(sizeof(chunk), total - written);
+      for (size_t i = 0; i < n; i++) {
+        chunk[i] = (uint8_t)(written + i);
+      }
+      size_t offset = 0;
+      while (offset < n) {
+        offset += ring.write(chunk + offset, n - offset);
+      }
+      written += n;
+    }
+  });
+  size_t read = 0;
+  bool ordered = true;
+  while (read < total) {
+    uint8_t chunk[5];
+    size_t n = ring.read(chunk, sizeof(chunk));
+    for (size_t i = 0; i < n; i++) {
+      ordered = ordered && chunk[i] == (uint8_t)(read + i);
+    }
+    read += n;
+  }
+  producer.join();
+  REQUIRE(ordered);
+}
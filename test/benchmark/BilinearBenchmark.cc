@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Times the bilinear resampler on a 1080p plane, zooming in on the center
+// quarter of the source. Run with `meson test --benchmark` or directly.
+
+#include "video/Bilinear.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using vivictpp::video::Plane;
+using vivictpp::video::SimdLevel;
+using vivictpp::video::SourceRect;
+
+template <typename T>
+double timeResample(const std::vector<T> &src, std::vector<T> &dst,
+                    SimdLevel simdLevel, int iterations) {
+  const SourceRect srcRect = {380.5, 270.2, 960.0, 539.2};
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    vivictpp::video::bilinearResample(
+        Plane<const T>{src.data(), 1920, 1920, 1080}, srcRect,
+        Plane<T>{dst.data(), 1920, 1920, 1080}, simdLevel);
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - t0;
+  return elapsed.count() / iterations;
+}
+
+template <typename T>
+void benchmark(const std::string &name, int maxValue, int iterations) {
+  std::vector<T> src(1920 * 1080);
+  std::vector<T> dst(1920 * 1080);
+  for (auto &v : src) {
+    v = static_cast<T>(rand() % (maxValue + 1));
+  }
+  SimdLevel simdLevel = vivictpp::video::detectSimdLevel();
+  double scalarMs = timeResample(src, dst, SimdLevel::SCALAR, iterations);
+  double simdMs = timeResample(src, dst, simdLevel, iterations);
+  std::cout << name << " scalar: " << scalarMs << " ms, "
+            << vivictpp::video::simdLevelName(simdLevel) << ": " << simdMs
+            << " ms, speedup " << scalarMs / simdMs << "x\n";
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+  benchmark<uint8_t>("8 bit 1080p plane", 255, iterations);
+  benchmark<uint16_t>("10 bit 1080p plane", 1023, iterations);
+  return 0;
+}
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Times conversion of a 4K yuv420p10le frame to yuv420p, with libswscale as
+// used by the format filter and with the bit depth converter. Run with
+// `meson test --benchmark` or directly.
+
+#include "video/BitDepth.hh"
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using vivictpp::video::Plane;
+using vivictpp::video::SimdLevel;
+
+const int WIDTH = 3840;
+const int HEIGHT = 2160;
+
+struct Frame10 {
+  std::vector<uint16_t> planes[3];
+};
+
+struct Frame8 {
+  std::vector<uint8_t> planes[3];
+};
+
+int planeWidth(int plane) { return plane == 0 ? WIDTH : WIDTH / 2; }
+int planeHeight(int plane) { return plane == 0 ? HEIGHT : HEIGHT / 2; }
+
+double timeMs(const std::function<void()> &convert, int iterations) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    convert();
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - t0;
+  return elapsed.count() / iterations;
+}
+
+double timeReduce(const Frame10 &src, Frame8 &dst, SimdLevel simdLevel,
+                  int iterations) {
+  return timeMs(
+      [&]() {
+        for (int p = 0; p < 3; p++) {
+          vivictpp::video::reduceBitDepth(
+              Plane<const uint16_t>{src.planes[p].data(), planeWidth(p),
+                                    planeWidth(p), planeHeight(p)},
+              10,
+              Plane<uint8_t>{dst.planes[p].data(), planeWidth(p),
+                             planeWidth(p), planeHeight(p)},
+              false, simdLevel);
+        }
+      },
+      iterations);
+}
+
+double timeSwscale(const Frame10 &src, Frame8 &dst, int iterations) {
+  SwsContext *sws =
+      sws_getContext(WIDTH, HEIGHT, AV_PIX_FMT_YUV420P10LE, WIDTH, HEIGHT,
+                     AV_PIX_FMT_YUV420P, SWS_BICUBIC, nullptr, nullptr,
+                     nullptr);
+  const uint8_t *srcData[3];
+  int srcStride[3];
+  uint8_t *dstData[3];
+  int dstStride[3];
+  for (int p = 0; p < 3; p++) {
+    srcData[p] = reinterpret_cast<const uint8_t *>(src.planes[p].data());
+    srcStride[p] = planeWidth(p) * 2;
+    dstData[p] = dst.planes[p].data();
+    dstStride[p] = planeWidth(p);
+  }
+  double ms = timeMs(
+      [&]() {
+        sws_scale(sws, srcData, srcStride, 0, HEIGHT, dstData, dstStride);
+      },
+      iterations);
+  sws_freeContext(sws);
+  return ms;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+  Frame10 src;
+  Frame8 dst;
+  for (int p = 0; p < 3; p++) {
+    src.planes[p].resize(planeWidth(p) * planeHeight(p));
+    dst.planes[p].resize(planeWidth(p) * planeHeight(p));
+    for (auto &v : src.planes[p]) {
+      v = static_cast<uint16_t>(rand() % 1024);
+    }
+  }
+  SimdLevel simdLevel = vivictpp::video::detectSimdLevel();
+  double swscaleMs = timeSwscale(src, dst, iterations);
+  double scalarMs = timeReduce(src, dst, SimdLevel::SCALAR, iterations);
+  double simdMs = timeReduce(src, dst, simdLevel, iterations);
+  std::cout << "4K yuv420p10le to yuv420p swscale: " << swscaleMs
+            << " ms, scalar: " << scalarMs << " ms, "
+            << vivictpp::video::simdLevelName(simdLevel) << ": " << simdMs
+            << " ms, speedup over swscale " << swscaleMs / simdMs << "x\n";
+  return 0;
+}
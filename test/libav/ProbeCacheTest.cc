@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "libav/ProbeCache.hh"
+#include "catch2/catch.hpp"
+
+#include <memory>
+
+using vivictpp::libav::ProbeCache;
+
+struct FormatContext {
+  AVFormatContext *formatContext;
+  FormatContext() : formatContext(avformat_alloc_context()) {}
+  ~FormatContext() { avformat_free_context(formatContext); }
+  AVStream *addStream(AVMediaType type, AVCodecID codecId) {
+    AVStream *stream = avformat_new_stream(formatContext, nullptr);
+    stream->codecpar->codec_type = type;
+    stream->codecpar->codec_id = codecId;
+    stream->time_base = {1, 90000};
+    return stream;
+  }
+};
+
+// As after avformat_find_stream_info
+void setProbed(FormatContext &probed) {
+  AVStream *video = probed.formatContext->streams[0];
+  video->codecpar->width = 1920;
+  video->codecpar->height = 1080;
+  video->codecpar->format = AV_PIX_FMT_YUV420P10LE;
+  video->r_frame_rate = {25, 1};
+  video->start_time = 3600;
+  probed.formatContext->duration = 10 * AV_TIME_BASE;
+}
+
+TEST_CASE("Applies stream info of an earlier probe", "[ProbeCache]") {
+  ProbeCache cache;
+  FormatContext probed;
+  probed.addStream(AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_HEVC);
+  probed.addStream(AVMEDIA_TYPE_AUDIO, AV_CODEC_ID_AAC);
+  REQUIRE_FALSE(cache.lookup("input", probed.formatContext));
+  setProbed(probed);
+  cache.store("input", probed.formatContext);
+
+  FormatContext opened;
+  opened.addStream(AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_HEVC);
+  opened.addStream(AVMEDIA_TYPE_AUDIO, AV_CODEC_ID_AAC);
+  REQUIRE(cache.lookup("input", opened.formatContext));
+  AVStream *video = opened.formatContext->streams[0];
+  REQUIRE(video->codecpar->width == 1920);
+  REQUIRE(video->codecpar->format == AV_PIX_FMT_YUV420P10LE);
+  REQUIRE(video->r_frame_rate.num == 25);
+  REQUIRE(video->start_time == 3600);
+  REQUIRE(opened.formatContext->duration == 10 * AV_TIME_BASE);
+}
+
+TEST_CASE("Probes again when the streams differ", "[ProbeCache]") {
+  ProbeCache cache;
+  FormatContext probed;
+  probed.addStream(AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_HEVC);
+  REQUIRE_FALSE(cache.lookup("input", probed.formatContext));
+  setProbed(probed);
+  cache.store("input", probed.formatContext);
+
+  FormatContext fewerStreams;
+  REQUIRE_FALSE(cache.lookup("input", fewerStreams.formatContext));
+  cache.abandon("input");
+
+  FormatContext otherCodec;
+  otherCodec.addStream(AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_H264);
+  REQUIRE_FALSE(cache.lookup("input", otherCodec.formatContext));
+  cache.abandon("input");
+  REQUIRE(otherCodec.formatContext->streams[0]->codecpar->width == 0);
+}
+
+TEST_CASE("Forgets an abandoned probe", "[ProbeCache]") {
+  ProbeCache cache;
+  FormatContext failed;
+  failed.addStream(AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_HEVC);
+  REQUIRE_FALSE(cache.lookup("input", failed.formatContext));
+  cache.abandon("input");
+  // Does not wait for the abandoned probe
+  REQUIRE_FALSE(cache.lookup("input", failed.formatContext));
+  cache.abandon("input");
+  REQUIRE(cache.size() == 0);
+}
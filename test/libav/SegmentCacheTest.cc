@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "libav/CachedIO.hh"
+#include "libav/FormatHandler.hh"
+#include "libav/SegmentCache.hh"
+#include "catch2/catch.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using vivictpp::libav::SegmentCache;
+
+const std::string HOST = "http://localhost:8080/";
+
+// Stands in for a web server serving the testdata directory, and counts the
+// requests for each url
+class TestServer {
+public:
+  SegmentCache::Fetcher fetcher() {
+    return [this](const SegmentCache::Request &request) {
+      return fetch(request.url);
+    };
+  }
+  int requests(const std::string &url) {
+    std::lock_guard<std::mutex> lock(m);
+    return counts[url];
+  }
+
+private:
+  SegmentCache::Data fetch(const std::string &url) {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      counts[url]++;
+    }
+    if (url.compare(0, HOST.size(), HOST) != 0) {
+      throw std::runtime_error("Unknown host: " + url);
+    }
+    std::ifstream in("../testdata/" + url.substr(HOST.size()),
+                     std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("Not found: " + url);
+    }
+    return std::make_shared<std::vector<uint8_t>>(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  std::mutex m;
+  std::map<std::string, int> counts;
+};
+
+bool waitFor(SegmentCache &cache, const std::string &url) {
+  for (int i = 0; i < 200 && !cache.contains(url); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return cache.contains(url);
+}
+
+TEST_CASE("Resolves segment uris", "[SegmentCache]") {
+  REQUIRE(SegmentCache::resolve("http://h/a/b.m3u8?token=1", "0000.ts") ==
+          "http://h/a/0000.ts");
+  REQUIRE(SegmentCache::resolve("http://h/a/b.m3u8", "/c/0000.ts") ==
+          "http://h/c/0000.ts");
+  REQUIRE(SegmentCache::resolve("http://h/a/b.m3u8", "https://x/0000.ts") ==
+          "https://x/0000.ts");
+}
+
+TEST_CASE("Downloads each segment once", "[SegmentCache]") {
+  TestServer server;
+  SegmentCache cache(server.fetcher(), {});
+  cache.get(HOST + "hls2/master.m3u8");
+  cache.get(HOST + "hls2/hls2_0.m3u8");
+  SegmentCache::Data first = cache.get(HOST + "hls2/hls2_0_0000.ts");
+  // Opened again, as by the indexer
+  cache.get(HOST + "hls2/master.m3u8");
+  cache.get(HOST + "hls2/hls2_0.m3u8");
+  SegmentCache::Data again = cache.get(HOST + "hls2/hls2_0_0000.ts");
+  REQUIRE(first->size() > 0);
+  REQUIRE(*first == *again);
+  REQUIRE(server.requests(HOST + "hls2/master.m3u8") == 1);
+  REQUIRE(server.requests(HOST + "hls2/hls2_0.m3u8") == 1);
+  REQUIRE(server.requests(HOST + "hls2/hls2_0_0000.ts") == 1);
+}
+
+TEST_CASE("Prefetches the following segments", "[SegmentCache]") {
+  TestServer server;
+  SegmentCache::Options options;
+  options.lookahead = 2;
+  SegmentCache cache(server.fetcher(), options);
+  cache.get(HOST + "hls1/hls1.m3u8");
+  cache.get(HOST + "hls1/0004.ts");
+  REQUIRE(waitFor(cache, HOST + "hls1/0005.ts"));
+  REQUIRE(waitFor(cache, HOST + "hls1/0006.ts"));
+  cache.get(HOST + "hls1/0005.ts");
+  REQUIRE(server.requests(HOST + "hls1/0005.ts") == 1);
+  REQUIRE(waitFor(cache, HOST + "hls1/0007.ts"));
+  REQUIRE_FALSE(cache.contains(HOST + "hls1/0003.ts"));
+}
+
+TEST_CASE("Moves segments to disk and deletes them when full",
+          "[SegmentCache]") {
+  TestServer server;
+  SegmentCache::Options options;
+  options.lookahead = 0;
+  // Segments of hls1 are about 25 kB
+  options.memoryBytes = 60 * 1024;
+  options.diskBytes = 60 * 1024;
+  SegmentCache cache(server.fetcher(), options);
+  cache.get(HOST + "hls1/hls1.m3u8");
+  SegmentCache::Data first = cache.get(HOST + "hls1/0000.ts");
+  for (int i = 1; i < 4; i++) {
+    cache.get(HOST + "hls1/000" + std::to_string(i) + ".ts");
+  }
+  REQUIRE(cache.memoryBytes() <= options.memoryBytes);
+  REQUIRE(cache.diskBytes() > 0);
+  REQUIRE(cache.contains(HOST + "hls1/0000.ts"));
+  // Read back from disk
+  REQUIRE(*cache.get(HOST + "hls1/0000.ts") == *first);
+  REQUIRE(server.requests(HOST + "hls1/0000.ts") == 1);
+
+  for (int i = 4; i < 10; i++) {
+    cache.get(HOST + "hls1/000" + std::to_string(i) + ".ts");
+  }
+  REQUIRE(cache.diskBytes() <= options.diskBytes);
+  REQUIRE_FALSE(cache.contains(HOST + "hls1/0000.ts"));
+  cache.get(HOST + "hls1/0000.ts");
+  REQUIRE(server.requests(HOST + "hls1/0000.ts") == 2);
+}
+
+TEST_CASE("Does not cache a failed download", "[SegmentCache]") {
+  TestServer server;
+  SegmentCache cache(server.fetcher(), {});
+  REQUIRE_THROWS(cache.get(HOST + "hls1/missing.ts"));
+  REQUIRE_THROWS(cache.get(HOST + "hls1/missing.ts"));
+  REQUIRE(server.requests(HOST + "hls1/missing.ts") == 2);
+}
+
+TEST_CASE("Forgets the segments of the oldest playlists", "[SegmentCache]") {
+  TestServer server;
+  SegmentCache::Options options;
+  options.lookahead = 1;
+  // Room for the segment urls of one playlist
+  options.indexBytes = 600;
+  SegmentCache cache(server.fetcher(), options);
+  cache.get(HOST + "hls1/hls1.m3u8");
+  cache.get(HOST + "hls2/hls2_0.m3u8");
+  cache.get(HOST + "hls1/0004.ts");
+  cache.get(HOST + "hls2/hls2_0_0000.ts");
+  REQUIRE(waitFor(cache, HOST + "hls2/hls2_0_0001.ts"));
+  REQUIRE(server.requests(HOST + "hls1/0005.ts") == 0);
+}
+
+TEST_CASE("Reads inputs opened by the player through the cache",
+          "[SegmentCache]") {
+  // The shared cache outlives the test case and may still be prefetching
+  static TestServer server;
+  SegmentCache &cache = vivictpp::libav::sharedSegmentCache();
+  cache.setFetcher(server.fetcher());
+  std::string playlist = HOST + "hls1/hls1.m3u8";
+  {
+    vivictpp::libav::FormatHandler formatHandler(playlist);
+    REQUIRE_FALSE(formatHandler.getVideoStreams().empty());
+  }
+  REQUIRE(server.requests(playlist) == 1);
+  REQUIRE(cache.contains(HOST + "hls1/0000.ts"));
+  REQUIRE(waitFor(cache, HOST + "hls1/0001.ts"));
+
+  // Opened again, as by the indexer
+  vivictpp::libav::FormatHandler again(playlist);
+  REQUIRE(server.requests(playlist) == 1);
+  REQUIRE(server.requests(HOST + "hls1/0000.ts") == 1);
+}
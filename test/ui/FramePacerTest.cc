@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "ui/FramePacer.hh"
+#include "catch2/catch.hpp"
+
+const int64_t VSYNC = 1000000 / 60;
+const vivictpp::time::Time FRAME_DURATION = 41667; // 24p
+
+// Presents frames on every vsync, picking the last frame due at the vsync
+// the same way VideoPlayback::checkAdvanceFrame does
+void simulatePlayback(vivictpp::ui::FramePacer &pacer, int64_t start,
+                      int vsyncs, int skipVsync = -1) {
+  int64_t clockOrigin = pacer.alignClockOrigin(start);
+  for (int i = 1; i <= vsyncs; i++) {
+    if (i == skipVsync) {
+      continue;
+    }
+    int64_t vsync = start + i * VSYNC;
+    vivictpp::time::Time clockPts = vsync - clockOrigin;
+    vivictpp::time::Time pts = (clockPts / FRAME_DURATION) * FRAME_DURATION;
+    pacer.recordPresent(vsync, {pts, clockPts, FRAME_DURATION, 1.0, true});
+  }
+}
+
+TEST_CASE("Predicts next vsync from last present", "[FramePacer]") {
+  vivictpp::ui::FramePacer pacer;
+  pacer.setDisplayRefreshRate(60);
+  pacer.recordPresent(1000000, {});
+  REQUIRE(pacer.predictNextVsync(1000100) == 1000000 + VSYNC);
+  REQUIRE(pacer.predictNextVsync(1000000 + VSYNC + 10) ==
+          1000000 + 2 * VSYNC);
+}
+
+TEST_CASE("24p on 60 Hz gives 3:2 cadence without duplicates",
+          "[FramePacer]") {
+  vivictpp::ui::FramePacer pacer;
+  pacer.setDisplayRefreshRate(60);
+  pacer.recordPresent(1000000, {});
+  simulatePlayback(pacer, 1000000, 600);
+  auto stats = pacer.getStats();
+  REQUIRE(stats.missedVsyncs == 0);
+  REQUIRE(stats.duplicatedFrames == 0);
+  REQUIRE(stats.lateFrames == 0);
+
+  int hold = 0;
+  for (const auto &record : pacer.getHistory()) {
+    if (record.newFrame && hold > 0) {
+      REQUIRE((hold == 2 || hold == 3));
+      hold = 0;
+    }
+    hold++;
+  }
+}
+
+TEST_CASE("Missed vsync is counted", "[FramePacer]") {
+  vivictpp::ui::FramePacer pacer;
+  pacer.setDisplayRefreshRate(60);
+  pacer.recordPresent(1000000, {});
+  simulatePlayback(pacer, 1000000, 100, 50);
+  auto stats = pacer.getStats();
+  REQUIRE(stats.missedVsyncs == 1);
+  REQUIRE(stats.presents == 100);
+}
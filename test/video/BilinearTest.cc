@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "video/Bilinear.hh"
+#include "catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+using vivictpp::video::Plane;
+using vivictpp::video::SimdLevel;
+using vivictpp::video::SourceRect;
+
+template <typename T>
+std::vector<T> randomPlane(int width, int height, int maxValue) {
+  std::mt19937 rng(4711);
+  std::uniform_int_distribution<int> dist(0, maxValue);
+  std::vector<T> data(width * height);
+  for (auto &v : data) {
+    v = static_cast<T>(dist(rng));
+  }
+  return data;
+}
+
+template <typename T>
+std::vector<T> resample(const std::vector<T> &src, int srcW, int srcH,
+                        SourceRect rect, int dstW, int dstH,
+                        SimdLevel simdLevel) {
+  std::vector<T> dst(dstW * dstH);
+  vivictpp::video::bilinearResample(
+      Plane<const T>{src.data(), srcW, srcW, srcH}, rect,
+      Plane<T>{dst.data(), dstW, dstW, dstH}, simdLevel);
+  return dst;
+}
+
+TEST_CASE("Identity resample returns source", "[Bilinear]") {
+  auto src = randomPlane<uint8_t>(67, 31, 255);
+  auto dst = resample(src, 67, 31, {0, 0, 67, 31}, 67, 31, SimdLevel::SCALAR);
+  REQUIRE(dst == src);
+  auto dstSimd = resample(src, 67, 31, {0, 0, 67, 31}, 67, 31,
+                          vivictpp::video::detectSimdLevel());
+  REQUIRE(dstSimd == src);
+}
+
+TEST_CASE("Upscale interpolates between samples", "[Bilinear]") {
+  std::vector<uint8_t> src = {0, 100, 200, 0, 100, 200};
+  // Zoom in on the center of the two middle pixels
+  auto dst = resample(src, 3, 2, {0.5, 0, 2, 2}, 2, 2, SimdLevel::SCALAR);
+  REQUIRE(dst == std::vector<uint8_t>{50, 150, 50, 150});
+}
+
+TEST_CASE("Constant plane stays constant", "[Bilinear]") {
+  std::vector<uint16_t> src(40 * 30, 1023);
+  auto dst = resample(src, 40, 30, {3.3, 2.7, 17.1, 9.9}, 123, 77,
+                      vivictpp::video::detectSimdLevel());
+  for (auto v : dst) {
+    REQUIRE(v == 1023);
+  }
+}
+
+TEST_CASE("Simd resample matches scalar reference", "[Bilinear]") {
+  SimdLevel simdLevel = vivictpp::video::detectSimdLevel();
+  INFO("simd level: " << vivictpp::video::simdLevelName(simdLevel));
+  const std::vector<SourceRect> rects = {{380.5, 270.2, 960.0, 539.2},
+                                         {0, 0, 1280, 720},
+                                         {1200.25, 700.75, 80, 20},
+                                         {-3, -3, 1290, 730}};
+  auto src8 = randomPlane<uint8_t>(1280, 720, 255);
+  auto src10 = randomPlane<uint16_t>(1280, 720, 1023);
+  for (const auto &rect : rects) {
+    REQUIRE(resample(src8, 1280, 720, rect, 1917, 1081, simdLevel) ==
+            resample(src8, 1280, 720, rect, 1917, 1081, SimdLevel::SCALAR));
+    REQUIRE(resample(src10, 1280, 720, rect, 333, 211, simdLevel) ==
+            resample(src10, 1280, 720, rect, 333, 211, SimdLevel::SCALAR));
+  }
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "video/BitDepth.hh"
+#include "catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+using vivictpp::video::Plane;
+using vivictpp::video::SimdLevel;
+
+std::vector<uint16_t> randomPlane(int width, int height, int maxValue) {
+  std::mt19937 rng(4711);
+  std::uniform_int_distribution<int> dist(0, maxValue);
+  std::vector<uint16_t> data(width * height);
+  for (auto &v : data) {
+    v = static_cast<uint16_t>(dist(rng));
+  }
+  return data;
+}
+
+std::vector<uint8_t> reduce(const std::vector<uint16_t> &src, int width,
+                            int height, int bitDepth, bool dither,
+                            SimdLevel simdLevel) {
+  std::vector<uint8_t> dst(width * height);
+  vivictpp::video::reduceBitDepth(
+      Plane<const uint16_t>{src.data(), width, width, height}, bitDepth,
+      Plane<uint8_t>{dst.data(), width, width, height}, dither, simdLevel);
+  return dst;
+}
+
+TEST_CASE("10 bit samples are rounded to 8 bits", "[BitDepth]") {
+  std::vector<uint16_t> src = {0, 1, 2, 3, 4, 5, 6, 1020, 1021, 1022, 1023};
+  auto dst = reduce(src, 11, 1, 10, false, SimdLevel::SCALAR);
+  REQUIRE(dst ==
+          std::vector<uint8_t>{0, 0, 1, 1, 1, 1, 2, 255, 255, 255, 255});
+}
+
+TEST_CASE("Samples in the high bits are converted with 16 bits",
+          "[BitDepth]") {
+  std::vector<uint16_t> src = {0, 64 << 6, 512 << 6, 1023 << 6, 0xffff};
+  auto dst = reduce(src, 5, 1, 16, false, SimdLevel::SCALAR);
+  REQUIRE(dst == std::vector<uint8_t>{0, 16, 128, 255, 255});
+}
+
+TEST_CASE("Simd matches scalar", "[BitDepth]") {
+  SimdLevel simdLevel = vivictpp::video::detectSimdLevel();
+  for (int bitDepth : {10, 12, 16}) {
+    // Odd width so that the scalar tail is used
+    auto src = randomPlane(101, 13, (1 << bitDepth) - 1);
+    for (bool dither : {false, true}) {
+      REQUIRE(reduce(src, 101, 13, bitDepth, dither, simdLevel) ==
+              reduce(src, 101, 13, bitDepth, dither, SimdLevel::SCALAR));
+    }
+  }
+}
+
+TEST_CASE("Dither keeps the average level", "[BitDepth]") {
+  // 10 bit value 513 is 128.25 in 8 bits, rounding gives 128 everywhere
+  std::vector<uint16_t> src(64 * 64, 513);
+  auto rounded = reduce(src, 64, 64, 10, false, SimdLevel::SCALAR);
+  auto dithered = reduce(src, 64, 64, 10, true, SimdLevel::SCALAR);
+  double sum = 0;
+  for (size_t i = 0; i < src.size(); i++) {
+    REQUIRE(rounded[i] == 128);
+    REQUIRE((dithered[i] == 128 || dithered[i] == 129));
+    sum += dithered[i];
+  }
+  REQUIRE(sum / src.size() == Approx(128.25));
+}
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "video/Difference.hh"
+#include "catch2/catch.hpp"
+
+#include <random>
+#include <vector>
+
+using vivictpp::video::DifferenceMode;
+using vivictpp::video::Plane;
+using vivictpp::video::SimdLevel;
+
+std::vector<uint8_t> randomPlane(int width, int height, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<uint8_t> data(width * height);
+  for (auto &v : data) {
+    v = static_cast<uint8_t>(dist(rng));
+  }
+  return data;
+}
+
+Plane<const uint8_t> plane(const std::vector<uint8_t> &data, int width,
+                           int height) {
+  return {data.data(), width, width, height};
+}
+
+TEST_CASE("Simd matches scalar", "[Difference]") {
+  SimdLevel simdLevel = vivictpp::video::detectSimdLevel();
+  // Odd width so that the scalar tail is used
+  auto a = randomPlane(101, 13, 1);
+  auto b = randomPlane(101, 13, 2);
+  std::vector<uint8_t> simd(a.size());
+  std::vector<uint8_t> scalar(a.size());
+  vivictpp::video::absDifference(plane(a, 101, 13), plane(b, 101, 13),
+                                 {simd.data(), 101, 101, 13}, simdLevel);
+  vivictpp::video::absDifference(plane(a, 101, 13), plane(b, 101, 13),
+                                 {scalar.data(), 101, 101, 13},
+                                 SimdLevel::SCALAR);
+  REQUIRE(simd == scalar);
+  REQUIRE(scalar[0] == std::abs(a[0] - b[0]));
+  REQUIRE(vivictpp::video::sumSquaredDifference(
+              plane(a, 101, 13), plane(b, 101, 13), simdLevel) ==
+          vivictpp::video::sumSquaredDifference(
+              plane(a, 101, 13), plane(b, 101, 13), SimdLevel::SCALAR));
+}
+
+TEST_CASE("Psnr", "[Difference]") {
+  REQUIRE(vivictpp::video::psnr(0, 100) == vivictpp::video::MAX_PSNR);
+  // Mean squared error 1
+  REQUIRE(vivictpp::video::psnr(100, 100) == Approx(48.1308).epsilon(1e-4));
+}
+
+TEST_CASE("Identical frames give a black difference image", "[Difference]") {
+  auto y = randomPlane(48, 32, 3);
+  auto u = randomPlane(24, 16, 4);
+  auto v = randomPlane(24, 16, 5);
+  vivictpp::video::YuvPlanes frame{plane(y, 48, 32), plane(u, 24, 16),
+                                   plane(v, 24, 16)};
+  auto image = vivictpp::video::differenceImage(
+      frame, frame, DifferenceMode::DIFFERENCE, 8);
+  REQUIRE(image.width == 48);
+  REQUIRE(image.height == 32);
+  REQUIRE(image.psnr == vivictpp::video::MAX_PSNR);
+  for (size_t i = 0; i < image.rgba.size(); i += 4) {
+    REQUIRE(image.rgba[i] == 0);
+    REQUIRE(image.rgba[i + 1] == 0);
+    REQUIRE(image.rgba[i + 2] == 0);
+    REQUIRE(image.rgba[i + 3] == 255);
+  }
+}
+
+TEST_CASE("Heatmap colours only the differing block", "[Difference]") {
+  std::vector<uint8_t> left(32 * 16, 100);
+  std::vector<uint8_t> right = left;
+  std::vector<uint8_t> chroma(16 * 8, 128);
+  // Noise in the right block only
+  auto noise = randomPlane(16, 16, 6);
+  for (int y = 0; y < 16; y++) {
+    for (int x = 16; x < 32; x++) {
+      right[y * 32 + x] = noise[y * 16 + x - 16];
+    }
+  }
+  vivictpp::video::YuvPlanes leftFrame{
+      plane(left, 32, 16), plane(chroma, 16, 8), plane(chroma, 16, 8)};
+  vivictpp::video::YuvPlanes rightFrame{
+      plane(right, 32, 16), plane(chroma, 16, 8), plane(chroma, 16, 8)};
+  auto image = vivictpp::video::differenceImage(
+      leftFrame, rightFrame, DifferenceMode::HEATMAP, 1);
+  REQUIRE(image.psnr < 20);
+  // Dimmed left frame
+  REQUIRE(image.rgba[0] == 40);
+  REQUIRE(image.rgba[1] == 40);
+  REQUIRE(image.rgba[2] == 40);
+  // Red
+  const uint8_t *colored = &image.rgba[20 * 4];
+  REQUIRE(colored[0] > colored[1]);
+  REQUIRE(colored[0] > colored[2]);
+}
+
+TEST_CASE("Compares nv12 to planar chroma", "[Difference]") {
+  auto y = randomPlane(48, 32, 7);
+  auto u = randomPlane(24, 16, 8);
+  auto v = randomPlane(24, 16, 9);
+  std::vector<uint8_t> uv(48 * 16);
+  for (size_t i = 0; i < u.size(); i++) {
+    uv[2 * i] = u[i];
+    uv[2 * i + 1] = v[i];
+  }
+  vivictpp::video::YuvPlanes planar{plane(y, 48, 32), plane(u, 24, 16),
+                                    plane(v, 24, 16)};
+  vivictpp::video::YuvPlanes nv12{plane(y, 48, 32), plane(uv, 48, 16),
+                                  plane(uv, 48, 16), true};
+  auto image = vivictpp::video::differenceImage(
+      nv12, planar, DifferenceMode::DIFFERENCE, 8);
+  for (size_t i = 0; i < image.rgba.size(); i += 4) {
+    REQUIRE(image.rgba[i] == 0);
+    REQUIRE(image.rgba[i + 1] == 0);
+    REQUIRE(image.rgba[i + 2] == 0);
+  }
+  // A changed v sample shows up in the planar frame's layout
+  v[0] ^= 0x40;
+  image = vivictpp::video::differenceImage(planar, nv12,
+                                           DifferenceMode::DIFFERENCE, 8);
+  REQUIRE(image.rgba[0] != 0);
+  REQUIRE(image.rgba[8] == 0);
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "video/FrameCache.hh"
+
+using vivictpp::libav::Frame;
+using vivictpp::time::NO_TIME;
+using vivictpp::video::FrameCache;
+
+// yuv420p frame of 64x64 pixels, 6 kB
+Frame makeFrame(int64_t pts) {
+  Frame frame;
+  frame->width = 64;
+  frame->height = 64;
+  frame->format = AV_PIX_FMT_YUV420P;
+  frame->pts = pts;
+  frame->best_effort_timestamp = pts;
+  REQUIRE(av_frame_get_buffer(frame.avFrame(), 0) >= 0);
+  return frame;
+}
+
+TEST_CASE("Cached frames are returned until the next frame") {
+  FrameCache cache;
+  cache.put("a", 1000, 2000, makeFrame(1));
+  REQUIRE(cache.get("a", 1000).pts() == 1);
+  REQUIRE(cache.get("a", 1999).pts() == 1);
+  REQUIRE(cache.get("a", 2000).empty());
+  REQUIRE(cache.get("a", 999).empty());
+  REQUIRE(cache.get("b", 1000).empty());
+}
+
+TEST_CASE("Frames without a known next frame are only returned at their pts") {
+  FrameCache cache;
+  cache.put("a", 1000, NO_TIME, makeFrame(1));
+  REQUIRE(cache.get("a", 1000).pts() == 1);
+  REQUIRE(cache.get("a", 1001).empty());
+  // The next frame becomes known when the frame is shown again
+  cache.put("a", 1000, 2000, makeFrame(1));
+  REQUIRE(cache.get("a", 1001).pts() == 1);
+  REQUIRE(cache.size() == 1);
+}
+
+TEST_CASE("Least recently used frames are dropped over budget") {
+  size_t frameSize;
+  {
+    FrameCache cache;
+    cache.put("a", 0, 1, makeFrame(0));
+    frameSize = cache.bytes();
+  }
+  REQUIRE(frameSize > 0);
+  FrameCache cache(3 * frameSize);
+  cache.put("a", 0, 1, makeFrame(0));
+  cache.put("a", 1, 2, makeFrame(1));
+  cache.put("b", 0, 1, makeFrame(2));
+  // Used, so that frame 1 is the least recently used
+  REQUIRE(!cache.get("a", 0).empty());
+  cache.put("b", 1, 2, makeFrame(3));
+  REQUIRE(cache.size() == 3);
+  REQUIRE(cache.bytes() == 3 * frameSize);
+  REQUIRE(!cache.get("a", 0).empty());
+  REQUIRE(cache.get("a", 1).empty());
+  REQUIRE(!cache.get("b", 0).empty());
+  REQUIRE(!cache.get("b", 1).empty());
+}
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "video/FrameExporter.hh"
+
+#include <cstring>
+#include <string>
+
+using vivictpp::libav::Frame;
+using vivictpp::video::ExportFormat;
+
+// Grey yuv420p frame
+Frame makeFrame(int width, int height) {
+  Frame frame;
+  frame->width = width;
+  frame->height = height;
+  frame->format = AV_PIX_FMT_YUV420P;
+  REQUIRE(av_frame_get_buffer(frame.avFrame(), 0) >= 0);
+  for (int plane = 0; plane < 3; plane++) {
+    int h = plane == 0 ? height : height / 2;
+    std::memset(frame->data[plane], 128, frame->linesize[plane] * h);
+  }
+  return frame;
+}
+
+bool startsWith(const std::vector<uint8_t> &data, const std::string &prefix) {
+  return data.size() >= prefix.size() &&
+         std::memcmp(data.data(), prefix.data(), prefix.size()) == 0;
+}
+
+TEST_CASE("Frames are encoded in the requested format") {
+  Frame frame = makeFrame(64, 32);
+  REQUIRE(startsWith(vivictpp::video::encodeImage(frame, ExportFormat::PNG),
+                     "\x89PNG"));
+  std::vector<uint8_t> tiff =
+      vivictpp::video::encodeImage(frame, ExportFormat::TIFF);
+  REQUIRE((startsWith(tiff, "II*") || startsWith(tiff, "MM")));
+  REQUIRE(startsWith(vivictpp::video::encodeImage(frame, ExportFormat::PGM),
+                     "P5\n64 32\n255\n"));
+}
+
+TEST_CASE("Only the crop area is encoded") {
+  Frame frame = makeFrame(64, 32);
+  std::vector<uint8_t> pgm =
+      vivictpp::video::encodeImage(frame, ExportFormat::PGM, {10, 4, 20, 8});
+  REQUIRE(startsWith(pgm, "P5\n20 8\n255\n"));
+  // The frame itself is not cropped
+  REQUIRE(frame->width == 64);
+  REQUIRE(frame->crop_left == 0);
+}
+
+TEST_CASE("Exported frames are written to disk") {
+  std::filesystem::path dir =
+      std::filesystem::temp_directory_path() / "vivictpp-export-test";
+  std::filesystem::remove_all(dir);
+  {
+    vivictpp::video::FrameExporter exporter(2);
+    for (int i = 0; i < 4; i++) {
+      exporter.submit(makeFrame(32, 16),
+                      dir / ("frame" + std::to_string(i) + ".png"),
+                      ExportFormat::PNG);
+    }
+    exporter.finish();
+    REQUIRE(exporter.pending() == 0);
+    REQUIRE(exporter.written() == 4);
+    REQUIRE(exporter.failed() == 0);
+  }
+  REQUIRE(std::filesystem::file_size(dir / "frame3.png") > 0);
+  std::filesystem::remove_all(dir);
+}
+
+// Frames 0 to 9 of an input that playback has stepped to position, the
+// frame shown at position and those after it are buffered
+std::vector<vivictpp::time::Time> bufferedAfter(vivictpp::time::Time position,
+                                                vivictpp::time::Time exported) {
+  std::vector<vivictpp::time::Time> pts;
+  for (vivictpp::time::Time t = 0; t < 10; t++) {
+    if (t >= position && (vivictpp::time::isNoPts(exported) || t > exported)) {
+      pts.push_back(t);
+    }
+  }
+  return pts;
+}
+
+TEST_CASE("Every input exports all frames of the range") {
+  std::vector<vivictpp::time::Time> exportedPts(2, vivictpp::time::NO_TIME);
+  std::vector<std::vector<vivictpp::time::Time>> exported(2);
+  vivictpp::time::Time position = 2;
+  bool done = false;
+  for (int call = 0; call < 20 && !done; call++) {
+    std::vector<std::vector<vivictpp::time::Time>> buffered;
+    for (size_t i = 0; i < 2; i++) {
+      buffered.push_back(bufferedAfter(position, exportedPts[i]));
+    }
+    vivictpp::video::ExportSelection selection =
+        vivictpp::video::selectExportFrames(buffered, 2, 6, 1, exportedPts);
+    if (call == 0) {
+      // The other input has not exported its first frame
+      REQUIRE(vivictpp::time::isNoPts(selection.stepPts));
+    }
+    for (size_t i = 0; i < 2; i++) {
+      for (size_t j : selection.frames[i]) {
+        exported[i].push_back(buffered[i][j]);
+      }
+    }
+    if (!vivictpp::time::isNoPts(selection.stepPts)) {
+      position = std::max(position, selection.stepPts);
+    }
+    done = selection.done;
+  }
+  REQUIRE(done);
+  std::vector<vivictpp::time::Time> expected{2, 3, 4, 5, 6};
+  REQUIRE(exported[0] == expected);
+  REQUIRE(exported[1] == expected);
+}
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "video/MergedTimeline.hh"
+#include "catch2/catch.hpp"
+
+using vivictpp::time::Time;
+using vivictpp::video::MergedTimeline;
+
+std::vector<Time> framePts(int n, Time frameDuration, Time start = 0) {
+  std::vector<Time> result;
+  for (int i = 0; i < n; i++) {
+    result.push_back(start + i * frameDuration);
+  }
+  return result;
+}
+
+TEST_CASE("25 and 50 fps step on every 50 fps frame", "[MergedTimeline]") {
+  MergedTimeline timeline({framePts(25, 40000), framePts(50, 20000)}, {0, 0},
+                          5000);
+  REQUIRE(timeline.size() == 50);
+  REQUIRE(timeline.stepPts(1) == 20000);
+  REQUIRE(timeline.frameIndex(1, 0) == 0);
+  REQUIRE(timeline.frameIndex(1, 1) == 1);
+  REQUIRE(timeline.frameIndex(2, 0) == 1);
+  REQUIRE(timeline.frameIndex(2, 1) == 2);
+  REQUIRE(timeline.framePts(3, 0) == 40000);
+}
+
+TEST_CASE("Nearly equal pts form one step", "[MergedTimeline]") {
+  // 24 and 23.976 fps
+  MergedTimeline timeline({framePts(100, 41667), framePts(100, 41708)},
+                          {0, 0}, 10000);
+  REQUIRE(timeline.size() == 100);
+  for (size_t step = 0; step < timeline.size(); step++) {
+    REQUIRE(timeline.frameIndex(step, 0) == (int)step);
+    REQUIRE(timeline.frameIndex(step, 1) == (int)step);
+  }
+  REQUIRE(timeline.stepPts(10) == 417080);
+}
+
+TEST_CASE("Steps forward and backward", "[MergedTimeline]") {
+  std::vector<Time> unordered = {80000, 0, 40000, 120000};
+  MergedTimeline timeline({unordered, framePts(4, 40000)}, {0, 0}, 1000);
+  REQUIRE(timeline.size() == 4);
+  REQUIRE(timeline.nextPts(-5) == 0);
+  REQUIRE(timeline.nextPts(0) == 40000);
+  REQUIRE(timeline.nextPts(50000) == 80000);
+  REQUIRE(timeline.nextPts(120000) == vivictpp::time::NO_TIME);
+  REQUIRE(timeline.previousPts(80000) == 40000);
+  REQUIRE(timeline.previousPts(50000) == 40000);
+  REQUIRE(timeline.previousPts(0) == vivictpp::time::NO_TIME);
+}
+
+TEST_CASE("Applies input offsets", "[MergedTimeline]") {
+  MergedTimeline timeline({framePts(4, 40000, 40000), framePts(4, 40000)},
+                          {40000, 0}, 1000);
+  REQUIRE(timeline.size() == 4);
+  REQUIRE(timeline.stepPts(0) == 0);
+  REQUIRE(timeline.framePts(0, 0) == 40000);
+  REQUIRE(timeline.framePts(0, 1) == 0);
+}
+
+TEST_CASE("Input without frames yet has no frame index", "[MergedTimeline]") {
+  MergedTimeline timeline({framePts(4, 40000), framePts(2, 40000, 80000)},
+                          {0, 0}, 1000);
+  REQUIRE(timeline.frameIndex(0, 1) == -1);
+  REQUIRE(timeline.framePts(0, 1) == vivictpp::time::NO_TIME);
+  REQUIRE(timeline.frameIndex(2, 1) == 0);
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "video/ScrubCache.hh"
+
+using vivictpp::time::millis;
+using vivictpp::time::seconds;
+using vivictpp::time::Time;
+using vivictpp::video::scrubTargets;
+
+TEST_CASE("Scrub targets are ordered by distance from center") {
+  // Key frames every second
+  std::vector<Time> keyFrames;
+  for (int i = 0; i <= 20; i++) {
+    keyFrames.push_back(seconds(i));
+  }
+  std::vector<Time> targets =
+      scrubTargets(keyFrames, seconds(10), seconds(2), 5);
+  REQUIRE(targets == std::vector<Time>{seconds(10), seconds(8), seconds(12),
+                                       seconds(6), seconds(14)});
+}
+
+TEST_CASE("Scrub targets snap to the key frame before the grid position") {
+  std::vector<Time> keyFrames{0, seconds(5), seconds(10)};
+  std::vector<Time> targets =
+      scrubTargets(keyFrames, millis(6500), seconds(1), 10);
+  // Grid positions snapping to the same key frame are only included once
+  REQUIRE(targets == std::vector<Time>{seconds(5), 0, seconds(10)});
+}
+
+TEST_CASE("Scrub targets are empty without key frames") {
+  REQUIRE(scrubTargets({}, 0, seconds(1), 10).empty());
+}
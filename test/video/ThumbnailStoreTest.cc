@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "catch2/catch.hpp"
+
+#include "video/ThumbnailStore.hh"
+
+#include <sstream>
+#include <vector>
+
+using vivictpp::time::seconds;
+using vivictpp::video::Thumbnail;
+using vivictpp::video::ThumbnailStore;
+
+namespace {
+
+// Adds a width x height thumbnail with padded line sizes, every pixel of
+// plane i having the value fill + i
+void addThumbnail(ThumbnailStore &store, vivictpp::time::Time pts, int width,
+                  int height, uint8_t fill) {
+  int chromaWidth = (width + 1) / 2;
+  int chromaHeight = (height + 1) / 2;
+  const int linesizes[3] = {width + 32, chromaWidth + 16, chromaWidth + 16};
+  std::vector<uint8_t> y(linesizes[0] * height, fill);
+  std::vector<uint8_t> u(linesizes[1] * chromaHeight, fill + 1);
+  std::vector<uint8_t> v(linesizes[2] * chromaHeight, fill + 2);
+  const uint8_t *const planes[3] = {y.data(), u.data(), v.data()};
+  store.add(pts, width, height, planes, linesizes);
+}
+
+bool hasFill(const Thumbnail &thumbnail, uint8_t fill) {
+  for (int i = 0; i < 3; i++) {
+    int rows = i == 0 ? thumbnail.height : thumbnail.chromaHeight();
+    for (int n = 0; n < thumbnail.linesize(i) * rows; n++) {
+      if (thumbnail.plane(i)[n] != fill + i) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Thumbnails are packed and sorted by pts") {
+  ThumbnailStore store;
+  addThumbnail(store, seconds(10), 64, 36, 10);
+  addThumbnail(store, seconds(0), 64, 36, 20);
+  addThumbnail(store, seconds(5), 64, 36, 30);
+
+  REQUIRE(store.size() == 3);
+  REQUIRE(store.get(seconds(0)).pts == seconds(0));
+  REQUIRE(store.get(seconds(7)).pts == seconds(5));
+  REQUIRE(store.get(seconds(20)).pts == seconds(10));
+  REQUIRE(store.get(-seconds(1)).pts == seconds(0));
+  REQUIRE(hasFill(store.get(seconds(5)), 30));
+  REQUIRE(store.get(seconds(0)).linesize(0) == 64);
+  REQUIRE(store.bytesAllocated() == ThumbnailStore::CHUNK_SIZE);
+}
+
+TEST_CASE("Duplicate pts is ignored") {
+  ThumbnailStore store;
+  addThumbnail(store, seconds(1), 16, 16, 1);
+  addThumbnail(store, seconds(1), 16, 16, 2);
+  REQUIRE(store.size() == 1);
+  REQUIRE(hasFill(store.get(seconds(1)), 1));
+}
+
+TEST_CASE("Thumbnails added since a count are in the order added") {
+  ThumbnailStore store;
+  addThumbnail(store, seconds(10), 16, 16, 1);
+  addThumbnail(store, seconds(0), 16, 16, 2);
+  addThumbnail(store, seconds(5), 16, 16, 3);
+  std::vector<Thumbnail> added = store.addedSince(1);
+  REQUIRE(added.size() == 2);
+  REQUIRE(added[0].pts == seconds(0));
+  REQUIRE(added[1].pts == seconds(5));
+  REQUIRE(store.addedSince(3).empty());
+  store.clear();
+  REQUIRE(store.addedSince(0).empty());
+}
+
+TEST_CASE("Thumbnails outlive clear") {
+  ThumbnailStore store;
+  addThumbnail(store, seconds(1), 15, 9, 40);
+  Thumbnail thumbnail = store.get(seconds(1));
+  store.clear();
+  REQUIRE(store.size() == 0);
+  REQUIRE(store.get(seconds(1)).empty());
+  REQUIRE(hasFill(thumbnail, 40));
+}
+
+TEST_CASE("Serialized store can be read back") {
+  ThumbnailStore store;
+  addThumbnail(store, seconds(2), 32, 18, 50);
+  addThumbnail(store, seconds(4), 31, 17, 60);
+  std::stringstream buffer;
+  store.serialize(buffer);
+
+  ThumbnailStore copy;
+  copy.deserialize(buffer);
+  REQUIRE(copy.size() == 2);
+  REQUIRE(copy.get(seconds(4)).width == 31);
+  REQUIRE(copy.get(seconds(4)).height == 17);
+  REQUIRE(hasFill(copy.get(seconds(2)), 50));
+  REQUIRE(hasFill(copy.get(seconds(4)), 60));
+
+  std::stringstream truncated(buffer.str().substr(0, 40));
+  REQUIRE_THROWS(copy.deserialize(truncated));
+  REQUIRE(copy.size() == 2);
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 Gustav Grusell
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#define CATCH_CONFIG_MAIN
+#include "workers/DecodeScheduler.hh"
+#include "catch2/catch.hpp"
+
+using vivictpp::workers::DecodeScheduler;
+using vivictpp::workers::DecoderLoad;
+
+const vivictpp::time::Time FRAME_DURATION = 40000; // 25 fps
+
+// Two inputs with 8 threads each, advancing one second per sample. The slow
+// input needs microsPerFrame of decoding per frame and keeps an empty buffer.
+std::vector<int> runSamples(DecodeScheduler &scheduler, int samples,
+                            uint64_t slowMicrosPerFrame, int slowBuffered,
+                            int64_t start = 0) {
+  std::vector<int> result;
+  for (int i = 0; i <= samples; i++) {
+    uint64_t frames = 25 * i;
+    std::vector<DecoderLoad> loads = {
+        {frames, frames * 2000, 20, 8, FRAME_DURATION},
+        {frames, frames * slowMicrosPerFrame, slowBuffered, 8,
+         FRAME_DURATION}};
+    result = scheduler.update(start + i * DecodeScheduler::SAMPLE_INTERVAL,
+                              loads);
+    if (!result.empty()) {
+      break;
+    }
+  }
+  return result;
+}
+
+TEST_CASE("Gives more threads to a starved input", "[DecodeScheduler]") {
+  DecodeScheduler scheduler(16);
+  std::vector<int> threads = runSamples(scheduler, 5, 6000, 0);
+  REQUIRE(threads.size() == 2);
+  REQUIRE(threads[0] + threads[1] == 16);
+  REQUIRE(threads[0] == 4);
+  REQUIRE(threads[1] == 12);
+}
+
+TEST_CASE("Does not rebalance when no input is starved",
+          "[DecodeScheduler]") {
+  DecodeScheduler scheduler(16);
+  REQUIRE(runSamples(scheduler, 10, 6000, 8).empty());
+}
+
+TEST_CASE("Waits for cooldown before rebalancing again", "[DecodeScheduler]") {
+  DecodeScheduler scheduler(16);
+  REQUIRE_FALSE(runSamples(scheduler, 5, 6000, 0).empty());
+  scheduler.reset();
+  // Loads still report the old thread counts, so a new allocation differs
+  REQUIRE(runSamples(scheduler, 5, 6000, 0,
+                     6 * DecodeScheduler::SAMPLE_INTERVAL)
+              .empty());
+  scheduler.reset();
+  REQUIRE_FALSE(runSamples(scheduler, 5, 6000, 0,
+                           DecodeScheduler::REBALANCE_COOLDOWN +
+                               10 * DecodeScheduler::SAMPLE_INTERVAL)
+                    .empty());
+}
+
+TEST_CASE("Ignores a single input", "[DecodeScheduler]") {
+  DecodeScheduler scheduler(16);
+  for (int i = 0; i < 5; i++) {
+    REQUIRE(scheduler
+                .update(i * DecodeScheduler::SAMPLE_INTERVAL,
+                        {{(uint64_t)25 * i, (uint64_t)25 * i * 6000, 0, 16,
+                          FRAME_DURATION}})
+                .empty());
+  }
+}